@@ -46,6 +46,8 @@ class SparseBitvectorImpl {
 
     SparseBitvectorImpl(const SparseBitvectorImpl &) = default;
     SparseBitvectorImpl(SparseBitvectorImpl &&) = default;
+    SparseBitvectorImpl &operator=(const SparseBitvectorImpl &) = default;
+    SparseBitvectorImpl &operator=(SparseBitvectorImpl &&) = default;
 
     void reset() { _bits.clear(); }
     bool empty() const { return _bits.empty(); }
@@ -0,0 +1,930 @@
+#ifndef DG_ADT_COMPRESSED_BITMAP_H_
+#define DG_ADT_COMPRESSED_BITMAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace dg {
+namespace ADT {
+
+// the kernels that work on arrays of 64-bit words
+namespace bitmap_kernels {
+
+inline unsigned popcount(uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(w);
+#else
+    unsigned num = 0;
+    while (w) {
+        w &= w - 1;
+        ++num;
+    }
+    return num;
+#endif
+}
+
+// the index of the lowest set bit, 'w' must not be 0
+inline unsigned ctz(uint64_t w) {
+    assert(w != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#else
+    unsigned num = 0;
+    while (!(w & 1)) {
+        w >>= 1;
+        ++num;
+    }
+    return num;
+#endif
+}
+
+inline size_t popcount(const uint64_t *words, size_t n) {
+    size_t num = 0;
+    for (size_t i = 0; i < n; ++i)
+        num += popcount(words[i]);
+    return num;
+}
+
+// dest |= src, return true if some bit was added to 'dest'
+inline bool orWords(uint64_t *dest, const uint64_t *src, size_t n) {
+    size_t i = 0;
+    uint64_t added = 0;
+#ifdef __SSE2__
+    __m128i addedv = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2) {
+        auto *d = reinterpret_cast<__m128i *>(dest + i);
+        __m128i dv = _mm_loadu_si128(d);
+        __m128i sv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        addedv = _mm_or_si128(addedv, _mm_andnot_si128(dv, sv));
+        _mm_storeu_si128(d, _mm_or_si128(dv, sv));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(addedv, _mm_setzero_si128())) !=
+        0xFFFF)
+        added = 1;
+#endif
+    for (; i < n; ++i) {
+        added |= src[i] & ~dest[i];
+        dest[i] |= src[i];
+    }
+    return added != 0;
+}
+
+// dest &= src, return the number of bits in 'dest'
+inline size_t andWords(uint64_t *dest, const uint64_t *src, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 2 <= n; i += 2) {
+        auto *d = reinterpret_cast<__m128i *>(dest + i);
+        __m128i sv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(d, _mm_and_si128(_mm_loadu_si128(d), sv));
+    }
+#endif
+    for (; i < n; ++i)
+        dest[i] &= src[i];
+    return popcount(dest, n);
+}
+
+// dest &= ~src, return the number of bits in 'dest'
+inline size_t andNotWords(uint64_t *dest, const uint64_t *src, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 2 <= n; i += 2) {
+        auto *d = reinterpret_cast<__m128i *>(dest + i);
+        __m128i sv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        // _mm_andnot_si128(a, b) computes ~a & b
+        _mm_storeu_si128(d, _mm_andnot_si128(sv, _mm_loadu_si128(d)));
+    }
+#endif
+    for (; i < n; ++i)
+        dest[i] &= ~src[i];
+    return popcount(dest, n);
+}
+
+} // namespace bitmap_kernels
+
+///
+// Compressed bitmap in the style of Roaring bitmaps.
+// The indices are split into chunks of 2^16 indices by their high bits
+// and every chunk is stored in the container that suits its contents:
+//  - array:  sorted low 16 bits of the indices (at most 4096 of them),
+//  - bitmap: 2^16 bits in 1024 words (for dense chunks),
+//  - run:    sorted intervals of consecutive indices (created by
+//            runOptimize(), when it is smaller than the other containers).
+// Union, intersection and difference of bitmap containers are done
+// word-parallel (with SSE2 if available), sizes are cached and counted
+// by popcount, and the iterators jump over the zero bits using ctz.
+// The interface follows SparseBitvector, so the bitmap can be used
+// in its place.
+class CompressedBitmap {
+  public:
+    using IndexT = uint64_t;
+
+  private:
+    static const unsigned chunkBits = 16;
+    static const size_t bitmapWords = (size_t{1} << chunkBits) / 64;
+    // array containers with more elements are turned into bitmaps
+    static const size_t maxArraySize = 4096;
+
+    enum class Kind : uint8_t { ARRAY, BITMAP, RUN };
+
+    // the interval [start, last]
+    struct Run {
+        uint16_t start;
+        uint16_t last;
+    };
+
+    struct Chunk {
+        // the high bits of the indices in this chunk
+        uint64_t key;
+        Kind kind{Kind::ARRAY};
+        uint32_t cardinality{0};
+        std::vector<uint16_t> array;
+        std::vector<uint64_t> bitmap;
+        std::vector<Run> runs;
+
+        explicit Chunk(uint64_t k) : key(k) {}
+
+        static void setRange(uint64_t *words, uint32_t start, uint32_t last) {
+            for (uint32_t w = start / 64; w <= last / 64; ++w) {
+                uint32_t from = w == start / 64 ? start % 64 : 0;
+                uint32_t to = w == last / 64 ? last % 64 : 63;
+                uint64_t mask = (to == 63 ? ~uint64_t{0}
+                                          : (uint64_t{1} << (to + 1)) - 1) &
+                                ~((uint64_t{1} << from) - 1);
+                words[w] |= mask;
+            }
+        }
+
+        static void clearRange(uint64_t *words, uint32_t start, uint32_t last) {
+            for (uint32_t w = start / 64; w <= last / 64; ++w) {
+                uint32_t from = w == start / 64 ? start % 64 : 0;
+                uint32_t to = w == last / 64 ? last % 64 : 63;
+                uint64_t mask = (to == 63 ? ~uint64_t{0}
+                                          : (uint64_t{1} << (to + 1)) - 1) &
+                                ~((uint64_t{1} << from) - 1);
+                words[w] &= ~mask;
+            }
+        }
+
+        std::vector<Run>::const_iterator findRun(uint16_t low) const {
+            // the last run that starts at or before 'low'
+            auto it = std::upper_bound(
+                    runs.begin(), runs.end(), low,
+                    [](uint16_t v, const Run &r) { return v < r.start; });
+            if (it == runs.begin())
+                return runs.end();
+            --it;
+            return it->last >= low ? it : runs.end();
+        }
+
+        bool get(uint16_t low) const {
+            switch (kind) {
+            case Kind::ARRAY:
+                return std::binary_search(array.begin(), array.end(), low);
+            case Kind::BITMAP:
+                return bitmap[low / 64] & (uint64_t{1} << (low % 64));
+            case Kind::RUN:
+                return findRun(low) != runs.end();
+            }
+            return false;
+        }
+
+        // the contents as 1024 words
+        void fillBitmap(std::vector<uint64_t> &words) const {
+            if (kind == Kind::BITMAP) {
+                words = bitmap;
+                return;
+            }
+
+            words.assign(bitmapWords, 0);
+            if (kind == Kind::ARRAY) {
+                for (uint16_t v : array)
+                    words[v / 64] |= uint64_t{1} << (v % 64);
+            } else {
+                for (const Run &r : runs)
+                    setRange(words.data(), r.start, r.last);
+            }
+        }
+
+        // the contents as a sorted array
+        void fillArray(std::vector<uint16_t> &values) const {
+            if (kind == Kind::ARRAY) {
+                values = array;
+                return;
+            }
+
+            values.clear();
+            values.reserve(cardinality);
+            if (kind == Kind::BITMAP) {
+                for (size_t w = 0; w < bitmapWords; ++w) {
+                    for (uint64_t bits = bitmap[w]; bits; bits &= bits - 1) {
+                        values.push_back(static_cast<uint16_t>(
+                                w * 64 + bitmap_kernels::ctz(bits)));
+                    }
+                }
+            } else {
+                for (const Run &r : runs) {
+                    for (uint32_t v = r.start; v <= r.last; ++v)
+                        values.push_back(static_cast<uint16_t>(v));
+                }
+            }
+        }
+
+        void toBitmap() {
+            if (kind == Kind::BITMAP)
+                return;
+            std::vector<uint64_t> words;
+            fillBitmap(words);
+            bitmap.swap(words);
+            array = std::vector<uint16_t>();
+            runs = std::vector<Run>();
+            kind = Kind::BITMAP;
+        }
+
+        void toArray() {
+            if (kind == Kind::ARRAY)
+                return;
+            std::vector<uint16_t> values;
+            fillArray(values);
+            array.swap(values);
+            bitmap = std::vector<uint64_t>();
+            runs = std::vector<Run>();
+            kind = Kind::ARRAY;
+        }
+
+        // turn a run container into an array or a bitmap
+        void materialize() {
+            if (kind != Kind::RUN)
+                return;
+            if (cardinality > maxArraySize)
+                toBitmap();
+            else
+                toArray();
+        }
+
+        // use the array for small chunks and the bitmap for big ones
+        void normalize() {
+            if (kind == Kind::ARRAY && cardinality > maxArraySize)
+                toBitmap();
+            else if (kind == Kind::BITMAP && cardinality <= maxArraySize)
+                toArray();
+        }
+
+        // the sizes of the containers in bytes
+        size_t runBytes(size_t runsNum) const { return runsNum * sizeof(Run); }
+        size_t otherBytes() const {
+            return std::min(cardinality * sizeof(uint16_t),
+                            bitmapWords * sizeof(uint64_t));
+        }
+
+        size_t countRuns() const {
+            if (kind == Kind::RUN)
+                return runs.size();
+            if (kind == Kind::ARRAY) {
+                size_t num = 0;
+                for (size_t i = 0; i < array.size(); ++i) {
+                    if (i == 0 || array[i] != array[i - 1] + 1)
+                        ++num;
+                }
+                return num;
+            }
+            // a run starts at every bit that is set and whose
+            // preceding bit is not set
+            size_t num = 0;
+            uint64_t carry = 0;
+            for (size_t w = 0; w < bitmapWords; ++w) {
+                uint64_t bits = bitmap[w];
+                num += bitmap_kernels::popcount(bits & ~((bits << 1) | carry));
+                carry = bits >> 63;
+            }
+            return num;
+        }
+
+        void toRuns() {
+            std::vector<uint16_t> values;
+            fillArray(values);
+            std::vector<Run> result;
+            for (uint16_t v : values) {
+                if (!result.empty() && result.back().last + 1 == v)
+                    result.back().last = v;
+                else
+                    result.push_back({v, v});
+            }
+            runs.swap(result);
+            array = std::vector<uint16_t>();
+            bitmap = std::vector<uint64_t>();
+            kind = Kind::RUN;
+        }
+
+        // use the run container if it is the smallest one
+        void runOptimize() {
+            size_t runsNum = countRuns();
+            if (runBytes(runsNum) < otherBytes()) {
+                if (kind != Kind::RUN)
+                    toRuns();
+            } else if (kind == Kind::RUN) {
+                materialize();
+            }
+        }
+
+        // returns the previous value
+        bool set(uint16_t low) {
+            switch (kind) {
+            case Kind::ARRAY: {
+                auto it = std::lower_bound(array.begin(), array.end(), low);
+                if (it != array.end() && *it == low)
+                    return true;
+                array.insert(it, low);
+                ++cardinality;
+                normalize();
+                return false;
+            }
+            case Kind::BITMAP: {
+                uint64_t bit = uint64_t{1} << (low % 64);
+                if (bitmap[low / 64] & bit)
+                    return true;
+                bitmap[low / 64] |= bit;
+                ++cardinality;
+                return false;
+            }
+            case Kind::RUN:
+                return setInRuns(low);
+            }
+            return false;
+        }
+
+        bool setInRuns(uint16_t low) {
+            auto next = std::upper_bound(
+                    runs.begin(), runs.end(), low,
+                    [](uint16_t v, const Run &r) { return v < r.start; });
+            if (next != runs.begin()) {
+                auto prev = next - 1;
+                if (prev->last >= low)
+                    return true;
+                if (prev->last + 1 == low) {
+                    prev->last = low;
+                    // join with the next run
+                    if (next != runs.end() && next->start == low + 1) {
+                        prev->last = next->last;
+                        runs.erase(next);
+                    }
+                    ++cardinality;
+                    return false;
+                }
+            }
+
+            if (next != runs.end() && next->start == low + 1)
+                next->start = low;
+            else
+                runs.insert(next, {low, low});
+            ++cardinality;
+
+            // the runs are not worth it anymore
+            if (runBytes(runs.size()) > otherBytes())
+                materialize();
+            return false;
+        }
+
+        // returns the previous value
+        bool unset(uint16_t low) {
+            switch (kind) {
+            case Kind::ARRAY: {
+                auto it = std::lower_bound(array.begin(), array.end(), low);
+                if (it == array.end() || *it != low)
+                    return false;
+                array.erase(it);
+                --cardinality;
+                return true;
+            }
+            case Kind::BITMAP: {
+                uint64_t bit = uint64_t{1} << (low % 64);
+                if (!(bitmap[low / 64] & bit))
+                    return false;
+                bitmap[low / 64] &= ~bit;
+                --cardinality;
+                normalize();
+                return true;
+            }
+            case Kind::RUN: {
+                auto cit = findRun(low);
+                if (cit == runs.end())
+                    return false;
+                auto it = runs.begin() + (cit - runs.begin());
+                if (it->start == it->last) {
+                    runs.erase(it);
+                } else if (it->start == low) {
+                    ++it->start;
+                } else if (it->last == low) {
+                    --it->last;
+                } else {
+                    Run second{static_cast<uint16_t>(low + 1), it->last};
+                    it->last = low - 1;
+                    runs.insert(it + 1, second);
+                }
+                --cardinality;
+                return true;
+            }
+            }
+            return false;
+        }
+
+        // returns true if this chunk changed
+        bool unionWith(const Chunk &rhs) {
+            auto oldCardinality = cardinality;
+            if (kind == Kind::RUN && rhs.kind == Kind::RUN) {
+                std::vector<Run> result;
+                result.reserve(runs.size() + rhs.runs.size());
+                auto it = runs.begin();
+                auto rit = rhs.runs.begin();
+                cardinality = 0;
+                while (it != runs.end() || rit != rhs.runs.end()) {
+                    const Run &r = (rit == rhs.runs.end() ||
+                                    (it != runs.end() && it->start < rit->start))
+                                           ? *it++
+                                           : *rit++;
+                    if (!result.empty() && result.back().last + 1 >= r.start) {
+                        if (r.last > result.back().last) {
+                            cardinality += r.last - result.back().last;
+                            result.back().last = r.last;
+                        }
+                    } else {
+                        result.push_back(r);
+                        cardinality += r.last - r.start + 1;
+                    }
+                }
+                runs.swap(result);
+                if (runBytes(runs.size()) > otherBytes())
+                    materialize();
+                return cardinality != oldCardinality;
+            }
+
+            if (kind == Kind::BITMAP || rhs.kind == Kind::BITMAP ||
+                cardinality + rhs.cardinality > maxArraySize) {
+                toBitmap();
+                if (rhs.kind == Kind::BITMAP) {
+                    if (!bitmap_kernels::orWords(bitmap.data(),
+                                                 rhs.bitmap.data(),
+                                                 bitmapWords))
+                        return false;
+                    cardinality = static_cast<uint32_t>(bitmap_kernels::popcount(
+                            bitmap.data(), bitmapWords));
+                } else if (rhs.kind == Kind::ARRAY) {
+                    for (uint16_t v : rhs.array) {
+                        uint64_t bit = uint64_t{1} << (v % 64);
+                        if (!(bitmap[v / 64] & bit)) {
+                            bitmap[v / 64] |= bit;
+                            ++cardinality;
+                        }
+                    }
+                } else {
+                    for (const Run &r : rhs.runs)
+                        setRange(bitmap.data(), r.start, r.last);
+                    cardinality = static_cast<uint32_t>(bitmap_kernels::popcount(
+                            bitmap.data(), bitmapWords));
+                }
+                normalize();
+                return cardinality != oldCardinality;
+            }
+
+            // the result fits into an array
+            toArray();
+            std::vector<uint16_t> tmp;
+            const std::vector<uint16_t> *values = &rhs.array;
+            if (rhs.kind != Kind::ARRAY) {
+                rhs.fillArray(tmp);
+                values = &tmp;
+            }
+            // the sets are often merged repeatedly without any change
+            if (std::includes(array.begin(), array.end(), values->begin(),
+                              values->end()))
+                return false;
+            mergeArray(*values);
+            return cardinality != oldCardinality;
+        }
+
+        // merge the sorted values into the array in place (from the back)
+        void mergeArray(const std::vector<uint16_t> &values) {
+            size_t i = array.size();
+            size_t j = values.size();
+            size_t k = array.size() + values.size();
+            array.resize(k);
+            while (j > 0) {
+                if (i > 0 && array[i - 1] >= values[j - 1]) {
+                    if (array[i - 1] == values[j - 1])
+                        --j;
+                    array[--k] = array[--i];
+                } else {
+                    array[--k] = values[--j];
+                }
+            }
+            // the duplicates left a gap between the rest of the original
+            // values and the merged values
+            if (k > i)
+                array.erase(array.begin() + i, array.begin() + k);
+            cardinality = static_cast<uint32_t>(array.size());
+        }
+
+        // returns true if this chunk changed
+        bool intersectWith(const Chunk &rhs) {
+            auto oldCardinality = cardinality;
+            if (kind == Kind::ARRAY) {
+                array.erase(std::remove_if(array.begin(), array.end(),
+                                           [&rhs](uint16_t v) {
+                                               return !rhs.get(v);
+                                           }),
+                            array.end());
+                cardinality = static_cast<uint32_t>(array.size());
+            } else if (rhs.kind == Kind::ARRAY) {
+                std::vector<uint16_t> result;
+                for (uint16_t v : rhs.array) {
+                    if (get(v))
+                        result.push_back(v);
+                }
+                array.swap(result);
+                bitmap = std::vector<uint64_t>();
+                runs = std::vector<Run>();
+                kind = Kind::ARRAY;
+                cardinality = static_cast<uint32_t>(array.size());
+            } else {
+                toBitmap();
+                if (rhs.kind == Kind::BITMAP) {
+                    cardinality = static_cast<uint32_t>(bitmap_kernels::andWords(
+                            bitmap.data(), rhs.bitmap.data(), bitmapWords));
+                } else {
+                    std::vector<uint64_t> words;
+                    rhs.fillBitmap(words);
+                    cardinality = static_cast<uint32_t>(bitmap_kernels::andWords(
+                            bitmap.data(), words.data(), bitmapWords));
+                }
+                normalize();
+            }
+            return cardinality != oldCardinality;
+        }
+
+        // returns true if this chunk changed
+        bool subtract(const Chunk &rhs) {
+            auto oldCardinality = cardinality;
+            if (kind == Kind::ARRAY) {
+                array.erase(std::remove_if(array.begin(), array.end(),
+                                           [&rhs](uint16_t v) {
+                                               return rhs.get(v);
+                                           }),
+                            array.end());
+                cardinality = static_cast<uint32_t>(array.size());
+                return cardinality != oldCardinality;
+            }
+
+            toBitmap();
+            if (rhs.kind == Kind::BITMAP) {
+                cardinality = static_cast<uint32_t>(bitmap_kernels::andNotWords(
+                        bitmap.data(), rhs.bitmap.data(), bitmapWords));
+            } else if (rhs.kind == Kind::ARRAY) {
+                for (uint16_t v : rhs.array) {
+                    uint64_t bit = uint64_t{1} << (v % 64);
+                    if (bitmap[v / 64] & bit) {
+                        bitmap[v / 64] &= ~bit;
+                        --cardinality;
+                    }
+                }
+            } else {
+                for (const Run &r : rhs.runs)
+                    clearRange(bitmap.data(), r.start, r.last);
+                cardinality = static_cast<uint32_t>(
+                        bitmap_kernels::popcount(bitmap.data(), bitmapWords));
+            }
+            normalize();
+            return cardinality != oldCardinality;
+        }
+    };
+
+    // sorted by keys, there are no empty chunks
+    std::vector<Chunk> _chunks;
+    // the number of elements
+    size_t _size{0};
+
+    static uint64_t _key(IndexT i) { return i >> chunkBits; }
+    static uint16_t _low(IndexT i) {
+        return static_cast<uint16_t>(i & ((IndexT{1} << chunkBits) - 1));
+    }
+
+    std::vector<Chunk>::iterator _findChunk(uint64_t key) {
+        return std::lower_bound(
+                _chunks.begin(), _chunks.end(), key,
+                [](const Chunk &c, uint64_t k) { return c.key < k; });
+    }
+
+    std::vector<Chunk>::const_iterator _findChunk(uint64_t key) const {
+        return std::lower_bound(
+                _chunks.begin(), _chunks.end(), key,
+                [](const Chunk &c, uint64_t k) { return c.key < k; });
+    }
+
+  public:
+    CompressedBitmap() = default;
+    CompressedBitmap(IndexT i) { set(i); } // singleton ctor
+
+    void reset() {
+        _chunks.clear();
+        _size = 0;
+    }
+
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+
+    void swap(CompressedBitmap &oth) {
+        _chunks.swap(oth._chunks);
+        std::swap(_size, oth._size);
+    }
+
+    // the number of elements is not known in advance (the interface
+    // of SparseBitvector), the chunks are allocated on demand
+    void reserve(size_t) {}
+
+    bool get(IndexT i) const {
+        auto it = _findChunk(_key(i));
+        return it != _chunks.end() && it->key == _key(i) && it->get(_low(i));
+    }
+
+    // returns the previous value of the i-th bit
+    bool set(IndexT i) {
+        auto it = _findChunk(_key(i));
+        if (it == _chunks.end() || it->key != _key(i))
+            it = _chunks.emplace(it, _key(i));
+        if (it->set(_low(i)))
+            return true;
+        ++_size;
+        return false;
+    }
+
+    // returns the previous value of the i-th bit
+    bool unset(IndexT i) {
+        auto it = _findChunk(_key(i));
+        if (it == _chunks.end() || it->key != _key(i) || !it->unset(_low(i)))
+            return false;
+        --_size;
+        if (it->cardinality == 0)
+            _chunks.erase(it);
+        return true;
+    }
+
+    // union, returns true if this bitmap changed
+    bool set(const CompressedBitmap &rhs) {
+        if (rhs.empty() || &rhs == this)
+            return false;
+
+        bool changed = false;
+        auto it = _chunks.begin();
+        auto rit = rhs._chunks.begin();
+        // first update the chunks that are in both bitmaps,
+        // then add the missing ones at once
+        size_t missing = 0;
+        while (rit != rhs._chunks.end()) {
+            while (it != _chunks.end() && it->key < rit->key)
+                ++it;
+            if (it != _chunks.end() && it->key == rit->key) {
+                auto old = it->cardinality;
+                if (it->unionWith(*rit)) {
+                    changed = true;
+                    _size += it->cardinality - old;
+                }
+            } else {
+                ++missing;
+            }
+            ++rit;
+        }
+
+        if (missing == 0)
+            return changed;
+
+        std::vector<Chunk> merged;
+        merged.reserve(_chunks.size() + missing);
+        it = _chunks.begin();
+        for (const Chunk &rc : rhs._chunks) {
+            while (it != _chunks.end() && it->key < rc.key)
+                merged.push_back(std::move(*it++));
+            if (it != _chunks.end() && it->key == rc.key) {
+                merged.push_back(std::move(*it++));
+            } else {
+                merged.push_back(rc);
+                _size += rc.cardinality;
+            }
+        }
+        while (it != _chunks.end())
+            merged.push_back(std::move(*it++));
+        _chunks.swap(merged);
+        return true;
+    }
+
+    // intersection, returns true if this bitmap changed
+    bool intersect(const CompressedBitmap &rhs) {
+        if (&rhs == this)
+            return false;
+
+        bool changed = false;
+        size_t size = 0;
+        auto rit = rhs._chunks.begin();
+        for (Chunk &c : _chunks) {
+            while (rit != rhs._chunks.end() && rit->key < c.key)
+                ++rit;
+            if (rit == rhs._chunks.end() || rit->key != c.key) {
+                c.cardinality = 0;
+                changed = true;
+                continue;
+            }
+            changed |= c.intersectWith(*rit);
+            size += c.cardinality;
+        }
+
+        _chunks.erase(std::remove_if(_chunks.begin(), _chunks.end(),
+                                     [](const Chunk &c) {
+                                         return c.cardinality == 0;
+                                     }),
+                      _chunks.end());
+        _size = size;
+        return changed;
+    }
+
+    // difference, returns true if this bitmap changed
+    bool subtract(const CompressedBitmap &rhs) {
+        if (&rhs == this) {
+            bool changed = !empty();
+            reset();
+            return changed;
+        }
+
+        bool changed = false;
+        auto rit = rhs._chunks.begin();
+        for (Chunk &c : _chunks) {
+            while (rit != rhs._chunks.end() && rit->key < c.key)
+                ++rit;
+            if (rit == rhs._chunks.end())
+                break;
+            if (rit->key != c.key)
+                continue;
+
+            auto old = c.cardinality;
+            if (c.subtract(*rit)) {
+                changed = true;
+                _size -= old - c.cardinality;
+            }
+        }
+
+        _chunks.erase(std::remove_if(_chunks.begin(), _chunks.end(),
+                                     [](const Chunk &c) {
+                                         return c.cardinality == 0;
+                                     }),
+                      _chunks.end());
+        return changed;
+    }
+
+    // store the chunks of consecutive indices as runs where it saves memory
+    void runOptimize() {
+        for (Chunk &c : _chunks)
+            c.runOptimize();
+    }
+
+    bool operator==(const CompressedBitmap &rhs) const {
+        return _size == rhs._size && std::equal(begin(), end(), rhs.begin());
+    }
+
+    bool operator!=(const CompressedBitmap &rhs) const {
+        return !operator==(rhs);
+    }
+
+    class const_iterator {
+        const std::vector<Chunk> *chunks{nullptr};
+        size_t chunk{0};
+        // the position in the container: the index in the array,
+        // the index of the word in the bitmap, or the index of the run
+        size_t pos{0};
+        // the bits of the current word that were not visited yet
+        uint64_t word{0};
+        // the low bits of the current element
+        uint32_t low{0};
+
+        const_iterator(const std::vector<Chunk> *c, bool end)
+                : chunks(c), chunk(end ? c->size() : 0) {
+            if (!end)
+                _settle(/* enter = */ true);
+        }
+
+        void _enterChunk() {
+            const Chunk &c = (*chunks)[chunk];
+            pos = 0;
+            if (c.kind == Kind::BITMAP)
+                word = c.bitmap[0];
+            else if (c.kind == Kind::RUN)
+                low = c.runs[0].start;
+        }
+
+        // find the current element in the chunk,
+        // return false if the chunk has no more elements
+        bool _find() {
+            const Chunk &c = (*chunks)[chunk];
+            switch (c.kind) {
+            case Kind::ARRAY:
+                if (pos >= c.array.size())
+                    return false;
+                low = c.array[pos];
+                return true;
+            case Kind::BITMAP:
+                while (word == 0) {
+                    if (++pos >= bitmapWords)
+                        return false;
+                    word = c.bitmap[pos];
+                }
+                low = static_cast<uint32_t>(pos * 64 +
+                                            bitmap_kernels::ctz(word));
+                return true;
+            case Kind::RUN:
+                return pos < c.runs.size();
+            }
+            return false;
+        }
+
+        void _settle(bool enter) {
+            while (chunk < chunks->size()) {
+                if (enter)
+                    _enterChunk();
+                if (_find())
+                    return;
+                ++chunk;
+                enter = true;
+            }
+        }
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IndexT;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const IndexT *;
+        using reference = IndexT;
+
+        const_iterator() = default;
+
+        const_iterator &operator++() {
+            assert(chunk < chunks->size() && "operator++ called on end");
+            const Chunk &c = (*chunks)[chunk];
+            switch (c.kind) {
+            case Kind::ARRAY:
+                ++pos;
+                break;
+            case Kind::BITMAP:
+                word &= word - 1;
+                break;
+            case Kind::RUN:
+                if (low == c.runs[pos].last) {
+                    if (++pos < c.runs.size())
+                        low = c.runs[pos].start;
+                } else {
+                    ++low;
+                }
+                break;
+            }
+            _settle(/* enter = */ false);
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        IndexT operator*() const {
+            return ((*chunks)[chunk].key << chunkBits) | low;
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            return chunk == rhs.chunk &&
+                   (chunk == chunks->size() || low == rhs.low);
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class CompressedBitmap;
+    };
+
+    const_iterator begin() const { return const_iterator(&_chunks, false); }
+    const_iterator end() const {
+        return const_iterator(&_chunks, true /* end */);
+    }
+
+    friend class const_iterator;
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_COMPRESSED_BITMAP_H_
@@ -0,0 +1,475 @@
+#ifndef DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+#define DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <set>
+#include <utility>
+#include <vector>
+
+#ifndef NDEBUG
+#include <iostream>
+#endif
+
+#include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/SmallSortedSet.h"
+#include "dg/Offset.h"
+
+namespace dg {
+namespace ADT {
+
+///
+// Mapping of disjunctive discrete intervals of values
+// to sets of ValueT. It has the same interface as DisjunctiveIntervalMap,
+// but the intervals are kept in a sorted vector and the sets of values
+// are small sorted sets that store few values inline. Adding an interval
+// rewrites only the entries that overlap it, in one pass.
+template <typename ValueT, typename IntervalValueT = Offset>
+class FlatDisjunctiveIntervalMap {
+  public:
+    using IntervalT = DiscreteInterval<IntervalValueT>;
+    using ValuesT = SmallSortedSet<ValueT>;
+    using MappingT = std::vector<std::pair<IntervalT, ValuesT>>;
+    // the intervals must stay sorted, so do not allow modifying them
+    using iterator = typename MappingT::const_iterator;
+    using const_iterator = typename MappingT::const_iterator;
+
+    ///
+    // Return true if the mapping is updated anyhow
+    // (intervals split, value added).
+    bool add(const IntervalValueT start, const IntervalValueT end,
+             const ValueT &val) {
+        return add(IntervalT(start, end), val);
+    }
+
+    bool add(const IntervalT &I, const ValueT &val) {
+        return _add(I, ValuesT{val}, false);
+    }
+
+    template <typename ContT>
+    bool add(const IntervalValueT start, const IntervalValueT end,
+             const ContT &vals) {
+        return add(IntervalT(start, end), vals);
+    }
+
+    template <typename ContT>
+    bool add(const IntervalT &I, const ContT &vals) {
+        ValuesT tmp(vals.begin(), vals.end());
+        if (tmp.empty())
+            return false;
+        return _add(I, tmp, false);
+    }
+
+    // add all the intervals and values from 'rhs'
+    bool add(const FlatDisjunctiveIntervalMap &rhs);
+
+    bool update(const IntervalValueT start, const IntervalValueT end,
+                const ValueT &val) {
+        return update(IntervalT(start, end), val);
+    }
+
+    bool update(const IntervalT &I, const ValueT &val) {
+        return _add(I, ValuesT{val}, true);
+    }
+
+    template <typename ContT>
+    bool update(const IntervalValueT start, const IntervalValueT end,
+                const ContT &vals) {
+        return update(IntervalT(start, end), vals);
+    }
+
+    // the values of I are replaced by all the values from 'vals'
+    template <typename ContT>
+    bool update(const IntervalT &I, const ContT &vals) {
+        ValuesT tmp(vals.begin(), vals.end());
+        if (tmp.empty())
+            return false;
+        return _add(I, tmp, true);
+    }
+
+    // add the value 'val' to all intervals
+    bool addAll(const ValueT &val) {
+        bool changed = false;
+        for (auto &it : _mapping) {
+            changed |= it.second.insert(val).second;
+        }
+        return changed;
+    }
+
+    // return true if some intervals from the map
+    // has a overlap with I
+    bool overlaps(const IntervalT &I) const {
+        auto it = _lower(I.start);
+        return it != _mapping.end() && it->first.start <= I.end;
+    }
+
+    bool overlaps(IntervalValueT start, IntervalValueT end) const {
+        return overlaps(IntervalT(start, end));
+    }
+
+    // return true if the map has an entry for
+    // each single byte from the interval I
+    bool overlapsFull(const IntervalT &I) const {
+        auto it = _lower(I.start);
+        if (it == _mapping.end() || it->first.start > I.start)
+            return false;
+
+        while (it->first.end < I.end) {
+            auto last_end = it->first.end;
+            ++it;
+            if (it == _mapping.end() || it->first.start != last_end + 1)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool overlapsFull(IntervalValueT start, IntervalValueT end) const {
+        return overlapsFull(IntervalT(start, end));
+    }
+
+    FlatDisjunctiveIntervalMap
+    intersection(const FlatDisjunctiveIntervalMap &rhs) const {
+        FlatDisjunctiveIntervalMap tmp;
+        auto it = _mapping.begin();
+        auto rhsit = rhs._mapping.begin();
+        while (it != _mapping.end() && rhsit != rhs._mapping.end()) {
+            if (it->first.end < rhsit->first.start) {
+                ++it;
+                continue;
+            }
+            if (rhsit->first.end < it->first.start) {
+                ++rhsit;
+                continue;
+            }
+
+            std::vector<ValueT> vals;
+            std::set_intersection(it->second.begin(), it->second.end(),
+                                  rhsit->second.begin(), rhsit->second.end(),
+                                  std::back_inserter(vals));
+            if (!vals.empty()) {
+                // the overlaps are sorted and disjunctive
+                tmp._mapping.emplace_back(
+                        IntervalT{std::max(it->first.start, rhsit->first.start),
+                                  std::min(it->first.end, rhsit->first.end)},
+                        ValuesT(vals.begin(), vals.end()));
+            }
+
+            if (it->first.end < rhsit->first.end)
+                ++it;
+            else
+                ++rhsit;
+        }
+
+        tmp._check();
+        return tmp;
+    }
+
+    ///
+    // Gather all values that are covered by the interval I
+    std::set<ValueT> gather(IntervalValueT start, IntervalValueT end) const {
+        return gather(IntervalT(start, end));
+    }
+
+    std::set<ValueT> gather(const IntervalT &I) const {
+        std::set<ValueT> ret;
+        gather(I, ret);
+        return ret;
+    }
+
+    // insert the values covered by the interval I into 'ret'
+    template <typename ContT>
+    void gather(const IntervalT &I, ContT &ret) const {
+        for (auto it = _lower(I.start);
+             it != _mapping.end() && it->first.start <= I.end; ++it) {
+            ret.insert(it->second.begin(), it->second.end());
+        }
+    }
+
+    std::vector<IntervalT> uncovered(IntervalValueT start,
+                                     IntervalValueT end) const {
+        return uncovered(IntervalT(start, end));
+    }
+
+    std::vector<IntervalT> uncovered(const IntervalT &I) const {
+        std::vector<IntervalT> ret;
+        uncovered(I, ret);
+        return ret;
+    }
+
+    // append the uncovered parts of the interval I to 'ret'
+    void uncovered(const IntervalT &I, std::vector<IntervalT> &ret) const {
+        auto cur = I.start;
+        for (auto it = _lower(I.start);
+             it != _mapping.end() && it->first.start <= I.end; ++it) {
+            if (cur < it->first.start)
+                ret.emplace_back(cur, it->first.start - 1);
+            if (it->first.end >= I.end)
+                return;
+            cur = it->first.end + 1;
+        }
+
+        ret.emplace_back(cur, I.end);
+    }
+
+    bool empty() const { return _mapping.empty(); }
+    size_t size() const { return _mapping.size(); }
+
+    const_iterator begin() const { return _mapping.begin(); }
+    const_iterator end() const { return _mapping.end(); }
+
+    bool operator==(const FlatDisjunctiveIntervalMap &rhs) const {
+        return _mapping == rhs._mapping;
+    }
+
+    // return the iterator to an element that is the first
+    // that overlaps the interval I or end() if there is
+    // no such interval
+    const_iterator le(const IntervalT &I) const {
+        auto it = _lower(I.start);
+        if (it != _mapping.end() && it->first.start > I.end)
+            return _mapping.end();
+        return it;
+    }
+
+    const_iterator le(const IntervalValueT start,
+                      const IntervalValueT end) const {
+        return le(IntervalT(start, end));
+    }
+
+#ifndef NDEBUG
+    friend std::ostream &operator<<(std::ostream &os,
+                                    const FlatDisjunctiveIntervalMap &map) {
+        os << "{";
+        for (const auto &pair : map) {
+            if (pair.second.empty())
+                continue;
+
+            os << "{ ";
+            os << pair.first.start << "-" << pair.first.end;
+            os << ": " << *pair.second.begin();
+            os << " }, ";
+        }
+        os << "}";
+        return os;
+    }
+
+    void dump() const { std::cout << *this << "\n"; }
+#endif
+
+  private:
+    // the first interval that ends at 'start' or later
+    // (the ends are sorted as the intervals are disjunctive)
+    typename MappingT::iterator _lower(const IntervalValueT &start) {
+        return std::lower_bound(_mapping.begin(), _mapping.end(), start,
+                                [](const typename MappingT::value_type &e,
+                                   const IntervalValueT &v) {
+                                    return e.first.end < v;
+                                });
+    }
+
+    typename MappingT::const_iterator
+    _lower(const IntervalValueT &start) const {
+        return std::lower_bound(_mapping.begin(), _mapping.end(), start,
+                                [](const typename MappingT::value_type &e,
+                                   const IntervalValueT &v) {
+                                    return e.first.end < v;
+                                });
+    }
+
+    // the first interval that starts after 'end'
+    typename MappingT::iterator _upper(typename MappingT::iterator from,
+                                       const IntervalValueT &end) {
+        return std::upper_bound(from, _mapping.end(), end,
+                                [](const IntervalValueT &v,
+                                   const typename MappingT::value_type &e) {
+                                    return v < e.first.start;
+                                });
+    }
+
+    static bool _addValues(ValuesT &to, const ValuesT &vals, bool update) {
+        if (update) {
+            if (to == vals)
+                return false;
+            to = vals;
+            return true;
+        }
+
+        return to.insert(vals);
+    }
+
+    // If the boolean 'update' is set to true, the values
+    // are not added, but rewritten
+    bool _add(const IntervalT &I, const ValuesT &vals, bool update) {
+        auto lo = _lower(I.start);
+        auto hi = _upper(lo, I.end);
+
+        // no overlapping interval, just insert the new one
+        if (lo == hi) {
+            _mapping.emplace(lo, I, vals);
+            _check();
+            return true;
+        }
+
+        // fast path: the interval is already in the map
+        if (hi - lo == 1 && lo->first == I)
+            return _addValues(lo->second, vals, update);
+
+        // Build the new contents of the overlapped part of the mapping:
+        // split the border intervals, fill the gaps and add the values
+        MappingT segment;
+        segment.reserve(2 * (hi - lo) + 1);
+        bool changed = false;
+        auto cur = I.start;
+        for (auto it = lo; it != hi; ++it) {
+            const auto &interval = it->first;
+            if (interval.start < I.start) {
+                segment.emplace_back(IntervalT(interval.start, I.start - 1),
+                                     it->second);
+                changed = true;
+            } else if (cur < interval.start) {
+                segment.emplace_back(IntervalT(cur, interval.start - 1), vals);
+                changed = true;
+            }
+
+            segment.emplace_back(IntervalT(std::max(interval.start, I.start),
+                                           std::min(interval.end, I.end)),
+                                 it->second);
+            changed |= _addValues(segment.back().second, vals, update);
+
+            if (interval.end >= I.end) {
+                if (interval.end > I.end) {
+                    segment.emplace_back(IntervalT(I.end + 1, interval.end),
+                                         it->second);
+                    changed = true;
+                }
+                break;
+            }
+            cur = interval.end + 1;
+        }
+
+        auto last_end = (hi - 1)->first.end;
+        if (last_end < I.end) {
+            segment.emplace_back(IntervalT(cur, I.end), vals);
+            changed = true;
+        }
+
+        if (!changed)
+            return false;
+
+        // splice the segment into the mapping
+        size_t overlapped = hi - lo;
+        size_t i = 0;
+        for (; i < overlapped && i < segment.size(); ++i)
+            lo[i] = std::move(segment[i]);
+        if (i < segment.size())
+            _mapping.insert(lo + i, std::make_move_iterator(segment.begin() + i),
+                            std::make_move_iterator(segment.end()));
+        else
+            _mapping.erase(lo + i, hi);
+
+        _check();
+        return true;
+    }
+
+    void _check() const {
+#ifndef NDEBUG
+        // check that the keys are sorted and disjunctive
+        for (size_t i = 1; i < _mapping.size(); ++i) {
+            assert(_mapping[i - 1].first.start <= _mapping[i - 1].first.end);
+            assert(_mapping[i - 1].first.end < _mapping[i].first.start);
+        }
+#endif // NDEBUG
+    }
+
+    MappingT _mapping;
+};
+
+template <typename ValueT, typename IntervalValueT>
+bool FlatDisjunctiveIntervalMap<ValueT, IntervalValueT>::add(
+        const FlatDisjunctiveIntervalMap &rhs) {
+    if (rhs.empty())
+        return false;
+    if (_mapping.empty()) {
+        _mapping = rhs._mapping;
+        return true;
+    }
+
+    // Merge the two sorted sequences of intervals. 'as' and 'bs' are the
+    // starts of the parts of the current intervals that were not processed
+    // yet (the intervals may have been split by the other map).
+    MappingT result;
+    result.reserve(_mapping.size() + rhs._mapping.size());
+    bool changed = false;
+
+    auto a = _mapping.begin();
+    auto b = rhs._mapping.begin();
+    auto as = a->first.start;
+    auto bs = b->first.start;
+    auto next_a = [&]() {
+        if (++a != _mapping.end())
+            as = a->first.start;
+    };
+    auto next_b = [&]() {
+        if (++b != rhs._mapping.end())
+            bs = b->first.start;
+    };
+
+    while (a != _mapping.end() && b != rhs._mapping.end()) {
+        const auto ae = a->first.end;
+        const auto be = b->first.end;
+        if (ae < bs) {
+            result.emplace_back(IntervalT(as, ae), std::move(a->second));
+            next_a();
+        } else if (be < as) {
+            result.emplace_back(IntervalT(bs, be), b->second);
+            changed = true;
+            next_b();
+        } else if (as < bs) {
+            // the part of 'a' before 'b' starts
+            result.emplace_back(IntervalT(as, bs - 1), a->second);
+            changed = true;
+            as = bs;
+        } else if (bs < as) {
+            // the gap before 'a' starts
+            result.emplace_back(IntervalT(bs, as - 1), b->second);
+            changed = true;
+            bs = as;
+        } else {
+            auto e = std::min(ae, be);
+            if (e < ae) {
+                result.emplace_back(IntervalT(as, e), a->second);
+                changed = true;
+            } else {
+                result.emplace_back(IntervalT(as, e), std::move(a->second));
+            }
+            changed |= result.back().second.insert(b->second);
+
+            if (e == ae)
+                next_a();
+            else
+                as = e + 1;
+            if (e == be)
+                next_b();
+            else
+                bs = e + 1;
+        }
+    }
+
+    for (; a != _mapping.end(); next_a())
+        result.emplace_back(IntervalT(as, a->first.end), std::move(a->second));
+    for (; b != rhs._mapping.end(); next_b()) {
+        result.emplace_back(IntervalT(bs, b->first.end), b->second);
+        changed = true;
+    }
+
+    _mapping.swap(result);
+    _check();
+    return changed;
+}
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
@@ -0,0 +1,306 @@
+#ifndef DG_OFFSET_MAP_H_
+#define DG_OFFSET_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dg/Offset.h"
+
+namespace dg {
+namespace ADT {
+
+///
+// Map from offsets to values stored in a sorted array.
+// It is meant for the case when there are just a few keys
+// (e.g., offsets in a memory object where pointers are stored),
+// so up to N entries are stored inline and the entries are moved
+// to the heap only when there are more of them.
+// The entry for Offset::UNKNOWN is (as the greatest offset) always
+// the last one, so it is found in constant time. Iterators
+// are invalidated by inserting or erasing entries.
+template <typename ValueT, size_t N = 2>
+class OffsetMap {
+  public:
+    using value_type = std::pair<Offset, ValueT>;
+    using iterator = value_type *;
+    using const_iterator = const value_type *;
+
+  private:
+    using ContainerT = std::vector<value_type>;
+
+    size_t _size{0};
+    // the entries if there are at most N of them (constructed
+    // only as they are added), otherwise all of them are in '_heap'
+    union {
+        value_type _inline[N];
+    };
+    ContainerT _heap;
+
+    bool _isInline() const { return _size <= N; }
+
+    value_type *_data() { return _isInline() ? _inline : _heap.data(); }
+    const value_type *_data() const {
+        return _isInline() ? _inline : _heap.data();
+    }
+
+    bool _hasUnknown() const {
+        return _size > 0 && _data()[_size - 1].first.isUnknown();
+    }
+
+    // the entries with a known offset
+    iterator _knownEnd() { return _hasUnknown() ? end() - 1 : end(); }
+    const_iterator _knownEnd() const {
+        return _hasUnknown() ? end() - 1 : end();
+    }
+
+    static bool _cmp(const value_type &e, const Offset &off) {
+        return e.first < off;
+    }
+
+    iterator _lowerBound(const Offset &off) {
+        return std::lower_bound(begin(), _knownEnd(), off, _cmp);
+    }
+
+    const_iterator _lowerBound(const Offset &off) const {
+        return std::lower_bound(begin(), _knownEnd(), off, _cmp);
+    }
+
+    iterator _insert(iterator pos, value_type &&entry) {
+        size_t idx = pos - begin();
+        if (_size < N) {
+            if (idx == _size) {
+                new (&_inline[_size]) value_type(std::move(entry));
+            } else {
+                new (&_inline[_size]) value_type(std::move(_inline[_size - 1]));
+                std::move_backward(_inline + idx, _inline + _size - 1,
+                                   _inline + _size);
+                _inline[idx] = std::move(entry);
+            }
+        } else {
+            if (_size == N) {
+                _heap.reserve(2 * N + 1);
+                for (size_t i = 0; i < N; ++i) {
+                    _heap.push_back(std::move(_inline[i]));
+                    _inline[i].~value_type();
+                }
+            }
+            _heap.insert(_heap.begin() + idx, std::move(entry));
+        }
+        ++_size;
+        return begin() + idx;
+    }
+
+    // take the entries (there may be any number of them)
+    void _assign(ContainerT &&entries) {
+        clear();
+        size_t size = entries.size();
+        if (size > N) {
+            _heap = std::move(entries);
+        } else {
+            for (size_t i = 0; i < size; ++i)
+                new (&_inline[i]) value_type(std::move(entries[i]));
+        }
+        _size = size;
+    }
+
+    void _copy(const OffsetMap &rhs) {
+        if (rhs._isInline()) {
+            for (size_t i = 0; i < rhs._size; ++i)
+                new (&_inline[i]) value_type(rhs._inline[i]);
+        } else {
+            _heap = rhs._heap;
+        }
+        _size = rhs._size;
+    }
+
+    void _move(OffsetMap &rhs) {
+        if (rhs._isInline()) {
+            for (size_t i = 0; i < rhs._size; ++i)
+                new (&_inline[i]) value_type(std::move(rhs._inline[i]));
+        } else {
+            _heap = std::move(rhs._heap);
+        }
+        _size = rhs._size;
+        rhs.clear();
+    }
+
+  public:
+    OffsetMap() {}
+    OffsetMap(const OffsetMap &rhs) { _copy(rhs); }
+    OffsetMap(OffsetMap &&rhs) noexcept { _move(rhs); }
+
+    OffsetMap &operator=(const OffsetMap &rhs) {
+        if (this != &rhs) {
+            clear();
+            _copy(rhs);
+        }
+        return *this;
+    }
+
+    OffsetMap &operator=(OffsetMap &&rhs) noexcept {
+        if (this != &rhs) {
+            clear();
+            _move(rhs);
+        }
+        return *this;
+    }
+
+    ~OffsetMap() { clear(); }
+
+    iterator find(const Offset &off) {
+        if (off.isUnknown())
+            return _hasUnknown() ? end() - 1 : end();
+
+        auto it = _lowerBound(off);
+        if (it != _knownEnd() && it->first == off)
+            return it;
+        return end();
+    }
+
+    const_iterator find(const Offset &off) const {
+        if (off.isUnknown())
+            return _hasUnknown() ? end() - 1 : end();
+
+        auto it = _lowerBound(off);
+        if (it != _knownEnd() && it->first == off)
+            return it;
+        return end();
+    }
+
+    // the value for Offset::UNKNOWN or nullptr
+    ValueT *getUnknown() {
+        return _hasUnknown() ? &(end() - 1)->second : nullptr;
+    }
+
+    const ValueT *getUnknown() const {
+        return _hasUnknown() ? &(end() - 1)->second : nullptr;
+    }
+
+    size_t count(const Offset &off) const { return find(off) != end(); }
+
+    // the first entry with a known offset that is not less than 'off'
+    // (the end of the entries with known offsets for Offset::UNKNOWN)
+    const_iterator lowerBound(const Offset &off) const {
+        return off.isUnknown() ? _knownEnd() : _lowerBound(off);
+    }
+
+    // the end of the entries with known offsets, the entry
+    // for Offset::UNKNOWN (if any) follows
+    const_iterator knownEnd() const { return _knownEnd(); }
+
+    ///
+    // Merge the entries [first, last) that are sorted by offsets
+    // (there may be more entries with the same offset) into the map.
+    // 'merge(ValueT &to, const V &from)' returns true if it changed 'to'.
+    // Unlike inserting the entries one by one, the map is rebuilt
+    // just once. Returns true if the map changed.
+    template <typename It, typename MergeF>
+    bool mergeSorted(It first, It last, MergeF merge) {
+        if (first == last)
+            return false;
+
+        bool changed = false;
+        ContainerT merged;
+        merged.reserve(_size + std::distance(first, last));
+        auto it = begin();
+        for (; first != last; ++first) {
+            const Offset &off = first->first;
+            while (it != end() && it->first < off)
+                merged.push_back(std::move(*it++));
+
+            if (it != end() && it->first == off)
+                merged.push_back(std::move(*it++));
+            else if (merged.empty() || merged.back().first != off)
+                merged.emplace_back(off, ValueT());
+
+            changed |= merge(merged.back().second, first->second);
+        }
+
+        while (it != end())
+            merged.push_back(std::move(*it++));
+
+        _assign(std::move(merged));
+        return changed;
+    }
+
+    ValueT &operator[](const Offset &off) {
+        if (off.isUnknown()) {
+            if (!_hasUnknown())
+                _insert(end(), value_type(off, ValueT()));
+            return (end() - 1)->second;
+        }
+
+        auto it = _lowerBound(off);
+        if (it == _knownEnd() || it->first != off)
+            it = _insert(it, value_type(off, ValueT()));
+        return it->second;
+    }
+
+    iterator erase(iterator it) {
+        size_t idx = it - begin();
+        if (_isInline()) {
+            std::move(it + 1, end(), it);
+            _inline[_size - 1].~value_type();
+        } else {
+            _heap.erase(_heap.begin() + idx);
+            // move the entries back inline
+            if (_size == N + 1) {
+                for (size_t i = 0; i < N; ++i)
+                    new (&_inline[i]) value_type(std::move(_heap[i]));
+                _heap.clear();
+            }
+        }
+        --_size;
+        return begin() + idx;
+    }
+
+    size_t erase(const Offset &off) {
+        auto it = find(off);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+    // the iterators are pointers, so erase(0) would erase a null iterator
+    template <typename IntT, typename = typename std::enable_if<
+                                     std::is_integral<IntT>::value>::type>
+    size_t erase(IntT off) {
+        return erase(Offset(off));
+    }
+
+    void clear() {
+        if (_isInline()) {
+            for (size_t i = 0; i < _size; ++i)
+                _inline[i].~value_type();
+        } else {
+            _heap.clear();
+        }
+        _size = 0;
+    }
+
+    void swap(OffsetMap &rhs) {
+        OffsetMap tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    iterator begin() { return _data(); }
+    iterator end() { return _data() + _size; }
+    const_iterator begin() const { return _data(); }
+    const_iterator end() const { return _data() + _size; }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_OFFSET_MAP_H_
@@ -0,0 +1,129 @@
+#ifndef DG_ADT_SMALL_SORTED_SET_H_
+#define DG_ADT_SMALL_SORTED_SET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// A sorted set that keeps up to N values inline and moves them to the heap
+// only when there are more of them. Meant for small values that are cheap
+// to copy (e.g., pointers), the iterators are plain pointers that are
+// invalidated by insertion.
+template <typename T, size_t N = 2>
+class SmallSortedSet {
+    size_t _size{0};
+    T _inline[N]{};
+    // all the values if there are more than N of them
+    std::vector<T> _heap;
+
+    T *_data() { return _size > N ? _heap.data() : _inline; }
+    const T *_data() const { return _size > N ? _heap.data() : _inline; }
+
+  public:
+    using value_type = T;
+    using iterator = const T *;
+    using const_iterator = const T *;
+
+    SmallSortedSet() = default;
+    SmallSortedSet(std::initializer_list<T> vals) {
+        for (const T &v : vals)
+            insert(v);
+    }
+
+    template <typename IteratorT>
+    SmallSortedSet(IteratorT b, IteratorT e) {
+        insert(b, e);
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    const_iterator begin() const { return _data(); }
+    const_iterator end() const { return _data() + _size; }
+
+    const_iterator find(const T &v) const {
+        auto it = std::lower_bound(begin(), end(), v);
+        return (it != end() && *it == v) ? it : end();
+    }
+
+    size_t count(const T &v) const { return find(v) != end() ? 1 : 0; }
+
+    std::pair<const_iterator, bool> insert(const T &v) {
+        auto it = std::lower_bound(begin(), end(), v);
+        if (it != end() && *it == v)
+            return {it, false};
+
+        size_t idx = it - begin();
+        if (_size < N) {
+            std::copy_backward(_inline + idx, _inline + _size,
+                               _inline + _size + 1);
+            _inline[idx] = v;
+        } else {
+            if (_size == N) {
+                _heap.reserve(2 * N);
+                _heap.assign(_inline, _inline + N);
+            }
+            _heap.insert(_heap.begin() + idx, v);
+        }
+        ++_size;
+
+        return {begin() + idx, true};
+    }
+
+    template <typename IteratorT>
+    void insert(IteratorT b, IteratorT e) {
+        for (; b != e; ++b)
+            insert(*b);
+    }
+
+    // union, return true if some value was added
+    bool insert(const SmallSortedSet &rhs) {
+        if (std::includes(begin(), end(), rhs.begin(), rhs.end()))
+            return false;
+
+        std::vector<T> tmp;
+        tmp.reserve(_size + rhs._size);
+        std::set_union(begin(), end(), rhs.begin(), rhs.end(),
+                       std::back_inserter(tmp));
+        _size = tmp.size();
+        if (_size > N) {
+            _heap.swap(tmp);
+        } else {
+            _heap.clear();
+            std::copy(tmp.begin(), tmp.end(), _inline);
+        }
+        return true;
+    }
+
+    void clear() {
+        _size = 0;
+        _heap.clear();
+    }
+
+    void swap(SmallSortedSet &rhs) {
+        std::swap(_size, rhs._size);
+        for (size_t i = 0; i < N; ++i)
+            std::swap(_inline[i], rhs._inline[i]);
+        _heap.swap(rhs._heap);
+    }
+
+    bool operator==(const SmallSortedSet &rhs) const {
+        return _size == rhs._size && std::equal(begin(), end(), rhs.begin());
+    }
+
+    bool operator!=(const SmallSortedSet &rhs) const {
+        return !operator==(rhs);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_SMALL_SORTED_SET_H_
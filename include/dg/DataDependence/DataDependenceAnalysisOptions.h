@@ -101,6 +101,12 @@ enum UndefinedFunsBehavior {
     WRITE_ARGS = 1 << 2,
     READ_ARGS = 1 << 3,
 };
+
+// How DefinitionsMap finds the definitions of a memory object
+enum class DefinitionsMapKind {
+    hashed, // a hash table indexed by the objects
+    denseId // an array sorted by the IDs of the objects
+};
 } // namespace dda
 
 struct DataDependenceAnalysisOptions : AnalysisOptions {
@@ -115,6 +121,15 @@ struct DataDependenceAnalysisOptions : AnalysisOptions {
     // or just objects?
     bool fieldInsensitive{false};
 
+    // The number of threads that compute the definitions
+    // of all uses at once (MemorySSA only)
+    unsigned definitionsThreads{1};
+
+    // The representation of the definitions of memory objects
+    // (MemorySSA only). With denseId, the definitions are iterated in the
+    // order of the IDs of the objects and joins walk the maps in lockstep.
+    dda::DefinitionsMapKind definitionsMap{dda::DefinitionsMapKind::hashed};
+
     bool undefinedArePure() const { return undefinedFunsBehavior == dda::PURE; }
     bool undefinedFunsWriteAny() const {
         return undefinedFunsBehavior & dda::WRITE_ANY;
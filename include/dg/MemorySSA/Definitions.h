@@ -1,11 +1,15 @@
 #ifndef DG_MEMORY_SSA_DEFINITIONS_H_
 #define DG_MEMORY_SSA_DEFINITIONS_H_
 
+#include <cstdint>
 #include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "dg/MemorySSA/DefinitionsMap.h"
 #include "dg/Offset.h"
+#include "dg/ReadWriteGraph/RWBBlock.h"
 #include "dg/ReadWriteGraph/RWNode.h"
 
 namespace dg {
@@ -85,6 +89,59 @@ struct Definitions {
 #endif
 };
 
+///
+// Definitions reaching the nodes of a (long) basic block. Instead of
+// performing LVN from the beginning of the block for every query, the index
+// keeps checkpoints -- the definitions after some number of nodes that
+// change the definitions -- and replays only the changes since the closest
+// checkpoint. A new checkpoint is taken after at least as many changes
+// as is the size of the previous checkpoint, so the checkpoints take memory
+// linear in the number of changes and a query replays about as much as it
+// copies. The checkpoints are computed lazily up to the queried node.
+//
+// The index must be notified about the nodes inserted into the block.
+// If it is not, it is rebuilt when it finds out.
+class DefinitionsIndex {
+    using KeyT = uint64_t;
+
+    // the nodes of the block, their keys grow in the order of the nodes
+    // (and leave gaps, so that we can insert nodes without renumbering)
+    std::vector<RWNode *> _nodes;
+    std::unordered_map<const RWNode *, KeyT> _keys;
+    // the number of nodes that we searched for changes
+    size_t _scanned{0};
+    // the nodes that change the definitions in the order of the nodes
+    std::vector<RWNode *> _changes;
+    // the definitions after the given number of changes
+    std::vector<std::pair<size_t, Definitions>> _checkpoints;
+    // the definitions after all found changes
+    Definitions _last;
+
+    void reset(RWBBlock *block);
+    void renumber();
+    void scan(size_t upto);
+    size_t position(KeyT key) const;
+    size_t changesBefore(KeyT key) const;
+    void truncate(size_t changes);
+
+  public:
+    // blocks with less nodes are not worth indexing
+    static const size_t minBlockSize = 64;
+    // the minimal number of changes between checkpoints
+    static const size_t minInterval = 32;
+
+    static bool changesDefinitions(const RWNode *node) {
+        return !node->getDefines().empty() ||
+               !node->getOverwrites().empty() || node->usesUnknown();
+    }
+
+    // the same as performing LVN in the block of 'to' up to 'to'
+    Definitions get(RWNode *to);
+    // 'node' was inserted into the block before 'before'
+    // (or appended if 'before' is null)
+    void inserted(RWNode *node, const RWNode *before);
+};
+
 } // namespace dda
 } // namespace dg
 
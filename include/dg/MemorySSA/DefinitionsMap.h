@@ -1,14 +1,19 @@
 #ifndef DG_DEFINITIONS_MAP_H_
 #define DG_DEFINITIONS_MAP_H_
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
 #include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #ifndef NDEBUG
 #include <iostream>
 #endif
 
-#include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/FlatDisjunctiveIntervalMap.h"
+#include "dg/DataDependence/DataDependenceAnalysisOptions.h"
 #include "dg/Offset.h"
 #include "dg/ReadWriteGraph/DefSite.h"
 
@@ -21,14 +26,86 @@ class ReachingDefinitionsAnalysis;
 /// A data structure that represents a mapping
 /// DefSite -> RWNode, that is, it stores which memory (DefSite)
 /// was defined where.
+///
+/// The definitions of the targets are kept in an array. The 'hashed' maps
+/// find the targets via a hash table and keep them in the order in which
+/// they were added, the 'denseId' maps keep them sorted by the IDs of the
+/// targets, so that the operations on two maps walk both in lockstep.
+/// New maps get the kind set by setDefaultKind() (MemorySSA sets it from
+/// DataDependenceAnalysisOptions::definitionsMap). Maps of different kinds
+/// can be still combined, just more slowly.
 template <typename NodeT = RWNode>
 class DefinitionsMap {
   public:
-    using OffsetsT = ADT::DisjunctiveIntervalMap<NodeT *>;
+    using OffsetsT = ADT::FlatDisjunctiveIntervalMap<NodeT *>;
     using IntervalT = typename OffsetsT::IntervalT;
+    using EntryT = std::pair<NodeT *, OffsetsT>;
 
   private:
-    std::unordered_map<NodeT *, OffsetsT> _definitions{};
+    static DefinitionsMapKind _defaultKind;
+
+    DefinitionsMapKind _kind{_defaultKind};
+    std::vector<EntryT> _definitions{};
+    // the positions of targets in _definitions (only for 'hashed' maps)
+    std::unordered_map<const NodeT *, unsigned> _index{};
+
+    bool _sorted() const { return _kind == DefinitionsMapKind::denseId; }
+
+    // the order of the entries in 'denseId' maps, the pointers
+    // break ties if the targets come from different graphs
+    static bool _less(const NodeT *a, const NodeT *b) {
+        return a->getID() < b->getID() || (a->getID() == b->getID() && a < b);
+    }
+
+    template <typename IteratorT>
+    static IteratorT _lowerBound(IteratorT b, IteratorT e,
+                                 const NodeT *target) {
+        return std::lower_bound(b, e, target,
+                                [](const EntryT &entry, const NodeT *t) {
+                                    return _less(entry.first, t);
+                                });
+    }
+
+    const OffsetsT *_find(const NodeT *target) const {
+        if (_sorted()) {
+            auto it = _lowerBound(_definitions.begin(), _definitions.end(),
+                                  target);
+            if (it != _definitions.end() && it->first == target)
+                return &it->second;
+            return nullptr;
+        }
+
+        auto it = _index.find(target);
+        return it == _index.end() ? nullptr : &_definitions[it->second].second;
+    }
+
+    // get the definitions of the target, create them if there are none
+    OffsetsT &_get(NodeT *target) {
+        if (_sorted()) {
+            auto it = _lowerBound(_definitions.begin(), _definitions.end(),
+                                  target);
+            if (it == _definitions.end() || it->first != target)
+                it = _definitions.emplace(it, target, OffsetsT());
+            return it->second;
+        }
+
+        auto it = _index.emplace(target, _definitions.size());
+        if (it.second)
+            _definitions.emplace_back(target, OffsetsT());
+        return _definitions[it.first->second].second;
+    }
+
+    // append the definitions of a target that is not in the map
+    // (for 'denseId' maps, it must have the greatest ID)
+    void _append(NodeT *target, OffsetsT offsets) {
+        assert(!_find(target) && "The target is already in the map");
+        assert((!_sorted() || _definitions.empty() ||
+                _less(_definitions.back().first, target)) &&
+               "The target breaks the order");
+        if (!_sorted())
+            _index.emplace(target, _definitions.size());
+        _definitions.emplace_back(target, std::move(offsets));
+    }
 
     // transform (offset, lenght) from a DefSite into the interval
     static std::pair<Offset, Offset> getInterval(const DefSite &ds) {
@@ -40,9 +117,44 @@ class DefinitionsMap {
         return {ds.offset, ds.offset + (ds.len - 1)};
     }
 
+    // add the values from 'from' to the bytes that 'to' does not define
+    static void _addUncovered(OffsetsT &to, const OffsetsT &from) {
+        if (to.empty()) {
+            to.add(from);
+            return;
+        }
+
+        std::vector<IntervalT> uncovered;
+        for (auto &it : from) {
+            uncovered.clear();
+            to.uncovered(it.first, uncovered);
+            for (auto &interv : uncovered)
+                to.add(interv, it.second);
+        }
+    }
+
   public:
-    void clear() { _definitions.clear(); }
-    void swap(DefinitionsMap &rhs) { _definitions.swap(rhs._definitions); }
+    DefinitionsMap() = default;
+    explicit DefinitionsMap(DefinitionsMapKind kind) : _kind(kind) {}
+
+    ///
+    // Set the kind of the maps that are created from now on.
+    static void setDefaultKind(DefinitionsMapKind kind) { _defaultKind = kind; }
+    static DefinitionsMapKind getDefaultKind() { return _defaultKind; }
+
+    DefinitionsMapKind getKind() const { return _kind; }
+
+    void clear() {
+        _definitions.clear();
+        _index.clear();
+    }
+
+    void swap(DefinitionsMap &rhs) {
+        std::swap(_kind, rhs._kind);
+        _definitions.swap(rhs._definitions);
+        _index.swap(rhs._index);
+    }
+
     bool empty() const { return _definitions.empty(); }
 
     bool add(const DefSite &ds, NodeT *node) {
@@ -50,7 +162,7 @@ class DefinitionsMap {
         // definition get stretched over all possible offsets
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return _definitions[ds.target].add(start, end, node);
+        return _get(ds.target).add(start, end, node);
     }
 
     bool addAll(NodeT *node) {
@@ -64,15 +176,14 @@ class DefinitionsMap {
     bool update(const DefSite &ds, NodeT *node) {
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return _definitions[ds.target].update(start, end, node);
+        return _get(ds.target).update(start, end, node);
     }
 
     template <typename ContainerT>
     bool add(const DefSite &ds, const ContainerT &nodes) {
-        bool changed = false;
-        for (auto n : nodes)
-            changed |= add(ds, n);
-        return changed;
+        Offset start, end;
+        std::tie(start, end) = getInterval(ds);
+        return _get(ds.target).add(start, end, nodes);
     }
 
     template <typename ContainerT>
@@ -84,86 +195,157 @@ class DefinitionsMap {
     }
 
     bool add(NodeT *target, const OffsetsT &elems) {
-        bool changed = false;
-        for (auto &it : elems)
-            changed |= _definitions[target].add(it.first, it.second);
-        return changed;
+        return _get(target).add(elems);
     }
 
     bool add(const DefinitionsMap<NodeT> &rhs) {
+        if (!_sorted() || !rhs._sorted()) {
+            bool changed = false;
+            for (auto &it : rhs) {
+                changed |= add(it.first, it.second);
+            }
+            return changed;
+        }
+
+        // merge the maps in lockstep
         bool changed = false;
-        for (auto &it : rhs) {
-            changed |= add(it.first, it.second);
+        std::vector<EntryT> merged;
+        merged.reserve(_definitions.size() + rhs._definitions.size());
+        auto it = _definitions.begin();
+        for (auto &rhsit : rhs._definitions) {
+            while (it != _definitions.end() && _less(it->first, rhsit.first))
+                merged.push_back(std::move(*it++));
+
+            if (it != _definitions.end() && it->first == rhsit.first) {
+                changed |= it->second.add(rhsit.second);
+                merged.push_back(std::move(*it++));
+            } else {
+                merged.push_back(rhsit);
+                changed = true;
+            }
         }
+        std::move(it, _definitions.end(), std::back_inserter(merged));
+        _definitions.swap(merged);
         return changed;
     }
 
+    ///
+    // Add the definitions from 'from' of the bytes that are not defined
+    // in this map (as if the definitions of this map were made after
+    // the definitions of 'from'). Only the targets for which filt(target)
+    // returns true are taken from 'from'.
+    template <typename FiltFun>
+    void addUncovered(const DefinitionsMap<NodeT> &from, FiltFun filt) {
+        if (!_sorted() || !from._sorted()) {
+            for (auto &it : from) {
+                if (filt(it.first))
+                    _addUncovered(_get(it.first), it.second);
+            }
+            return;
+        }
+
+        // walk both maps in lockstep, the new targets
+        // are merged into the map at the end
+        std::vector<EntryT> added;
+        auto it = _definitions.begin();
+        for (auto &fromit : from._definitions) {
+            if (!filt(fromit.first))
+                continue;
+            while (it != _definitions.end() && _less(it->first, fromit.first))
+                ++it;
+
+            if (it != _definitions.end() && it->first == fromit.first)
+                _addUncovered(it->second, fromit.second);
+            else
+                added.push_back(fromit);
+        }
+
+        if (added.empty())
+            return;
+
+        std::vector<EntryT> merged;
+        merged.reserve(_definitions.size() + added.size());
+        std::merge(std::make_move_iterator(_definitions.begin()),
+                   std::make_move_iterator(_definitions.end()),
+                   std::make_move_iterator(added.begin()),
+                   std::make_move_iterator(added.end()),
+                   std::back_inserter(merged),
+                   [](const EntryT &a, const EntryT &b) {
+                       return _less(a.first, b.first);
+                   });
+        _definitions.swap(merged);
+    }
+
+    void addUncovered(const DefinitionsMap<NodeT> &from) {
+        addUncovered(from, [](const NodeT *) { return true; });
+    }
+
     bool update(const DefSite &ds, const std::vector<NodeT *> &nodes) {
-        bool changed = false;
-        for (auto n : nodes)
-            changed |= update(ds, n);
-        return changed;
+        Offset start, end;
+        std::tie(start, end) = getInterval(ds);
+        return _get(ds.target).update(start, end, nodes);
     }
 
     ///
     // Get definitions of the memory described by 'ds'
-    std::set<NodeT *> get(const DefSite &ds) {
-        auto it = _definitions.find(ds.target);
-        if (it == _definitions.end())
+    std::set<NodeT *> get(const DefSite &ds) const {
+        auto *offsets = _find(ds.target);
+        if (!offsets)
             return {};
 
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return it->second.gather(start, end);
+        return offsets->gather(start, end);
     }
 
     ///
     // Return intervals of bytes from 'ds' that are not defined by this map
     std::vector<IntervalT> undefinedIntervals(const DefSite &ds) const {
-        auto it = _definitions.find(ds.target);
-        if (it == _definitions.end())
+        auto *offsets = _find(ds.target);
+        if (!offsets)
             return {IntervalT(ds.offset, ds.offset + (ds.len - 1))};
 
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return it->second.uncovered(start, end);
+        return offsets->uncovered(start, end);
     }
 
     bool definesTarget(NodeT *target) const {
-        return _definitions.find(target) != _definitions.end();
-    }
-
-    /*
-    template <typename KeyFilt, typename SetFilt>
-    DefinitionsMap<NodeT> filter(KeyFilt keyfilt, SetFilt setfilt) {
-        DefinitionsMap<NodeT> tmp;
-        for (auto& it : _definitions) {
-            if (keyfilt(it.first) && setfilt(it.second)) {
-                tmp._definitions.emplace(it.first, it.second);
-            }
-        }
-        return tmp;
+        return _find(target) != nullptr;
     }
-    */
 
     template <typename FiltFun>
     DefinitionsMap<NodeT> filter(FiltFun filt) {
-        DefinitionsMap<NodeT> tmp;
+        DefinitionsMap<NodeT> tmp(_kind);
         for (auto &it : _definitions) {
             if (filt(it.first)) {
-                tmp._definitions.emplace(it.first, it.second);
+                tmp._append(it.first, it.second);
             }
         }
         return tmp;
     }
 
     DefinitionsMap<NodeT> intersect(const DefinitionsMap<NodeT> &rhs) {
-        DefinitionsMap<NodeT> retval;
-        for (auto &it : _definitions) {
-            auto rhsit = rhs._definitions.find(it.first);
-            if (rhsit != rhs._definitions.end()) {
-                retval.add(it.first, it.second.intersection(rhsit->second));
+        DefinitionsMap<NodeT> retval(_kind);
+        if (!_sorted() || !rhs._sorted()) {
+            for (auto &it : _definitions) {
+                if (auto *rhsoffsets = rhs._find(it.first)) {
+                    retval.add(it.first, it.second.intersection(*rhsoffsets));
+                }
             }
+            return retval;
+        }
+
+        auto rhsit = rhs._definitions.begin();
+        for (auto &it : _definitions) {
+            while (rhsit != rhs._definitions.end() &&
+                   _less(rhsit->first, it.first))
+                ++rhsit;
+            if (rhsit == rhs._definitions.end())
+                break;
+            if (rhsit->first == it.first)
+                retval._append(it.first,
+                               it.second.intersection(rhsit->second));
         }
         return retval;
     }
@@ -179,16 +361,26 @@ class DefinitionsMap {
         return ret;
     }
 
-    auto begin() const -> decltype(_definitions.begin()) {
-        return _definitions.begin();
+    auto begin() const -> decltype(_definitions.cbegin()) {
+        return _definitions.cbegin();
     }
 
-    auto end() const -> decltype(_definitions.end()) {
-        return _definitions.end();
+    auto end() const -> decltype(_definitions.cend()) {
+        return _definitions.cend();
     }
 
     bool operator==(const DefinitionsMap<NodeT> &oth) const {
-        return _definitions == oth._definitions;
+        if (_sorted() && oth._sorted())
+            return _definitions == oth._definitions;
+
+        if (size() != oth.size())
+            return false;
+        for (auto &it : _definitions) {
+            auto *othoffsets = oth._find(it.first);
+            if (!othoffsets || !(*othoffsets == it.second))
+                return false;
+        }
+        return true;
     }
 
     size_t size() const { return _definitions.size(); }
@@ -204,6 +396,10 @@ class DefinitionsMap {
 #endif
 };
 
+template <typename NodeT>
+DefinitionsMapKind DefinitionsMap<NodeT>::_defaultKind =
+        DefinitionsMapKind::hashed;
+
 } // namespace dda
 } // namespace dg
 
@@ -2,6 +2,7 @@
 #define DG_MEMORY_SSA_H_
 
 #include <cassert>
+#include <memory>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -14,6 +15,7 @@
 
 #include "dg/ReadWriteGraph/ReadWriteGraph.h"
 
+#include "dg/ADT/Bitvector.h"
 #include "dg/ADT/Queue.h"
 #include "dg/util/debug.h"
 
@@ -27,6 +29,8 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     class BBlockInfo {
         Definitions definitions{};
         RWNodeCall *call{nullptr};
+        // definitions in the prefixes of the block (for long blocks)
+        std::unique_ptr<DefinitionsIndex> index;
 
       public:
         void setCallBlock(RWNodeCall *c) { call = c; }
@@ -36,6 +40,19 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
 
         Definitions &getDefinitions() { return definitions; }
         const Definitions &getDefinitions() const { return definitions; }
+
+        DefinitionsIndex &getDefinitionsIndex() {
+            if (!index)
+                index.reset(new DefinitionsIndex());
+            return *index;
+        }
+
+        // 'node' was inserted into the block before 'before'
+        // (or appended if 'before' is null)
+        void inserted(RWNode *node, const RWNode *before) {
+            if (index)
+                index->inserted(node, before);
+        }
     };
 
     class SubgraphInfo {
@@ -100,8 +117,7 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     // LVN
     ///
     // Perform LVN up to a certain point and search only for a certain memory.
-    // XXX: we could avoid this by (at least virtually) splitting blocks on
-    // uses.
+    // Long blocks use the DefinitionsIndex instead of performing whole LVN.
     Definitions findDefinitionsInBlock(RWNode *to, const RWNode *mem = nullptr);
     Definitions findEscapingDefinitionsInBlock(RWNode *to);
     void performLvn(Definitions &, RWBBlock *);
@@ -185,6 +201,17 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     void addDefinitionsFromCalledValue(RWNode *phi, RWNodeCall *C,
                                        const DefSite &ds, RWNode *calledValue);
 
+    ///
+    // Computing all definitions in parallel. The definitions of uses that
+    // can be found without leaving the subgraph are computed concurrently
+    // for different subgraphs, the other uses are deferred.
+    bool isLocalUse(RWNode *use,
+                    std::unordered_map<const RWNode *, bool> &localTargets);
+    void computeLocalDefinitions(RWSubgraph *subg,
+                                 std::vector<RWNode *> &deferred,
+                                 std::vector<std::unique_ptr<RWNode>> &phis);
+    void computeAllDefinitionsInParallel();
+
     void computeModRef(RWSubgraph *subg, SubgraphInfo &si);
     bool callMayDefineTarget(RWNodeCall *C, RWNode *target);
 
@@ -198,6 +225,24 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
                       const Offset &len);
 
     std::vector<RWNode *> _phis;
+
+    ///
+    // The IDs of non-phi definitions that reach phi nodes. The phis in one
+    // strongly connected component of the def-use edges share the set.
+    // Adding def-use edges to existing phis comes only with creating
+    // new phis, so the sets are dropped when the number of phis changes.
+    using NodesSetT = dg::ADT::SparseBitvectorHashImpl;
+    std::unordered_map<const RWNode *, std::shared_ptr<const NodesSetT>>
+            _phiDefs;
+    size_t _phiDefsPhisNum{0};
+
+    const NodesSetT &getPhiDefinitions(RWNode *phi);
+    // replace the phi nodes in the definitions of the use
+    // by the non-phi definitions that reach them
+    std::vector<RWNode *> gatherNonPhisDefs(RWNode *use);
+    // if set, createPhi() puts new phi nodes here instead of into the graph
+    // (used by the threads that compute the definitions in parallel)
+    static thread_local std::vector<std::unique_ptr<RWNode>> *_detachedPhis;
     dg::ADT::QueueLIFO<RWNode> _queue;
     std::unordered_map<const RWSubgraph *, SubgraphInfo> _subgraphs_info;
 
@@ -227,18 +272,23 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     }
 
   public:
+    // NOTE: sets the kind of all DefinitionsMaps created from now on
+    // (DefinitionsMap::setDefaultKind()) from the options
     MemorySSATransformation(ReadWriteGraph &&graph,
                             const DataDependenceAnalysisOptions &opts)
-            : DataDependenceAnalysisImpl(std::move(graph), opts) {}
+            : DataDependenceAnalysisImpl(std::move(graph), opts) {
+        DefinitionsMap<RWNode>::setDefaultKind(options.definitionsMap);
+    }
 
     MemorySSATransformation(ReadWriteGraph &&graph)
-            : DataDependenceAnalysisImpl(std::move(graph)) {}
+            : MemorySSATransformation(std::move(graph), {}) {}
 
     void run() override;
 
     // compute definitions for all uses at once
     // (otherwise the definitions are computed on demand
-    // when calling getDefinitions())
+    // when calling getDefinitions()). Uses options.definitionsThreads
+    // threads, the result does not depend on the number of threads.
     void computeAllDefinitions();
 
     // return the reaching definitions of ('mem', 'off', 'len')
@@ -2,9 +2,11 @@
 #define DG_MEMORY_OBJECT_H_
 
 #include <cassert>
-#include <map>
+#include <cstdint>
 #include <set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #ifndef NDEBUG
 #include "dg/PointerAnalysis/PSNode.h"
@@ -12,12 +14,15 @@
 #endif // not NDEBUG
 
 #include "PointsToSet.h"
+#include "dg/ADT/OffsetMap.h"
 
 namespace dg {
 namespace pta {
 
 struct MemoryObject {
-    using PointsToMapT = std::map<Offset, PointsToSetT>;
+    // objects hold pointers usually just on a few offsets,
+    // so we keep them in a small sorted vector
+    using PointsToMapT = ADT::OffsetMap<PointsToSetT>;
 
     MemoryObject(/*uint64_t s = 0, bool isheap = false, */ PSNode *n = nullptr)
             : node(n) /*, is_heap(isheap), size(s)*/ {}
@@ -26,6 +31,10 @@ struct MemoryObject {
     PSNode *node;
     // possible pointers stored in this memory object
     PointsToMapT pointsTo;
+    // incremented whenever the methods of this object add a pointer
+    // or move the pointers to other offsets (the analyses that modify
+    // 'pointsTo' directly do not change it)
+    uint64_t version{0};
 
     PointsToSetT &getPointsTo(const Offset off) { return pointsTo[off]; }
 
@@ -35,6 +44,11 @@ struct MemoryObject {
         return pointsTo.find(off);
     }
 
+    // pointers stored on unknown offset (nullptr if there are none)
+    const PointsToSetT *getUnknownPointsTo() const {
+        return pointsTo.getUnknown();
+    }
+
     PointsToMapT::iterator begin() { return pointsTo.begin(); }
     PointsToMapT::iterator end() { return pointsTo.end(); }
     PointsToMapT::const_iterator begin() const { return pointsTo.begin(); }
@@ -48,29 +62,82 @@ struct MemoryObject {
             changed |= pointsTo[rit.first].add(rit.second);
         }
 
-        return changed;
+        return updated(changed);
     }
 
     bool addPointsTo(const Offset &off, const Pointer &ptr) {
         assert(ptr.target != nullptr &&
                "Cannot have NULL target, use unknown instead");
 
-        return pointsTo[off].add(ptr);
+        return updated(pointsTo[off].add(ptr));
     }
 
     bool addPointsTo(const Offset &off, const PointsToSetT &pointers) {
         if (pointers.empty())
             return false;
-        return pointsTo[off].add(pointers);
+        return updated(pointsTo[off].add(pointers));
     }
 
     bool addPointsTo(const Offset &off,
                      std::initializer_list<Pointer> pointers) {
         if (pointers.size() == 0)
             return false;
-        return pointsTo[off].add(pointers);
+        return updated(pointsTo[off].add(pointers));
+    }
+
+    ///
+    // Add the non-empty sets of pointers to the given offsets,
+    // the offsets must be sorted (Offset::UNKNOWN goes last).
+    bool addPointsTo(
+            const std::vector<std::pair<Offset, const PointsToSetT *>>
+                    &pointers) {
+        return updated(pointsTo.mergeSorted(
+                pointers.begin(), pointers.end(),
+                [](PointsToSetT &to, const PointsToSetT *from) {
+                    return to.add(*from);
+                }));
     }
 
+    ///
+    // Move the pointers stored on all offsets to Offset::UNKNOWN
+    // (used when the object is collapsed by the pointer analysis).
+    bool collapseOffsets() {
+        auto *unknown = pointsTo.getUnknown();
+        if (pointsTo.empty() || (pointsTo.size() == 1 && unknown))
+            return false;
+
+        PointsToSetT all;
+        if (unknown)
+            all.swap(*unknown);
+        for (auto &it : pointsTo)
+            all.add(it.second);
+
+        pointsTo.clear();
+        if (!all.empty())
+            pointsTo[Offset::UNKNOWN].swap(all);
+        return updated(true);
+    }
+
+    ///
+    // Call 'rewrite' on the set of pointers stored on every offset,
+    // it returns true if it changed the set.
+    template <typename RewriteF>
+    bool rewritePointers(RewriteF rewrite) {
+        bool changed = false;
+        for (auto &it : pointsTo)
+            changed |= rewrite(it.second);
+        return updated(changed);
+    }
+
+  private:
+    bool updated(bool changed) {
+        if (changed)
+            ++version;
+        return changed;
+    }
+
+  public:
+
 #ifndef NDEBUG
     void dump() const {
         std::cout << "MO [" << this << "] for ";
@@ -2,12 +2,19 @@
 #define DG_POINTER_ANALYSIS_H_
 
 #include <cassert>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "dg/ADT/Queue.h"
 #include "dg/PointerAnalysis/MemoryObject.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointerAnalysisOptions.h"
+#include "dg/PointerAnalysis/PointerAnalysisProfile.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
 
 namespace dg {
@@ -33,10 +40,49 @@ class PointerAnalysis {
 
     const PointerAnalysisOptions options{};
 
+    // null if the profiling is not enabled
+    std::unique_ptr<PointerAnalysisProfile> profile;
+
+    // the state of the budget (see PointerAnalysisOptions::timeLimit)
+    std::chrono::steady_clock::time_point deadline;
+    bool budget_started{false};
+    bool budget_exceeded{false};
+    // the budget is checked only once in a while during an iteration
+    unsigned budget_countdown{0};
+
+    // (source object, destination object, source offset, destination offset)
+    using MemcpyPairT = std::tuple<const MemoryObject *, const MemoryObject *,
+                                   Offset, Offset>;
+    // what the objects were like when the source was copied the last time:
+    // the version of the source before the copy, the version
+    // of the destination after the copy and whether the source
+    // was zero-initialized
+    using MemcpySeenT = std::tuple<uint64_t, uint64_t, bool>;
+    // the copies done by every memcpy node (see processMemcpy),
+    // used only if hasPersistentMemoryObjects() is true
+    std::unordered_map<const PSNode *, std::map<MemcpyPairT, MemcpySeenT>>
+            memcpy_seen;
+
+    // The state of collapsing objects (see
+    // PointerAnalysisOptions::maxObjectOffsets). GEPs may be processed
+    // in more threads, so they only record the offsets and the objects
+    // that exceeded the limit (under the lock). The objects are collapsed
+    // later by collapseObjects(), so the results do not depend
+    // on the order in which the threads process the GEPs.
+    // The vectors are indexed by IDs of objects.
+    mutable std::vector<std::vector<Offset::type>> object_offsets;
+    mutable std::vector<PSNode *> pending_collapses;
+    mutable std::mutex collapse_mutex;
+    // written only by collapseObjects()
+    std::vector<bool> collapsed_flags;
+    std::vector<PSNode *> collapsed_objects;
+
   public:
     PointerAnalysis(PointerGraph *ps, const PointerAnalysisOptions &opts)
             : PG(ps), options(opts) {
         initPointerAnalysis();
+        if (options.profile)
+            profile.reset(new PointerAnalysisProfile());
     }
 
     // default options
@@ -66,9 +112,37 @@ class PointerAnalysis {
 
     virtual bool afterProcessed(PSNode *) { return false; }
 
+    // Return true if it makes sense to dereference this pointer.
+    // PTA is over-approximation, so this is a filter.
+    static bool canBeDereferenced(const Pointer &ptr) {
+        if (!ptr.isValid() || ptr.isInvalidated() || ptr.isUnknown())
+            return false;
+
+        // if the pointer points to a function, we can not dereference it
+        return ptr.target->getType() != PSNodeType::FUNCTION;
+    }
+
     PointerGraph *getPG() { return PG; }
     const PointerGraph *getPG() const { return PG; }
 
+    const PointerAnalysisProfile *getProfile() const { return profile.get(); }
+
+    // the analysis ran out of the budget and its results
+    // are over-approximated
+    bool exceededBudget() const { return budget_exceeded; }
+
+    // the objects that were collapsed because GEPs yielded too many
+    // offsets into them (see PointerAnalysisOptions::maxObjectOffsets),
+    // in the order of collapsing
+    const std::vector<PSNode *> &getCollapsedObjects() const {
+        return collapsed_objects;
+    }
+
+    bool isCollapsedObject(const PSNode *n) const {
+        return n->getID() < collapsed_flags.size() &&
+               collapsed_flags[n->getID()];
+    }
+
     virtual void enqueue(PSNode *n) { changed.push_back(n); }
 
     virtual void preprocess() {}
@@ -89,10 +163,17 @@ class PointerAnalysis {
         }
     }
 
-    bool iteration() {
+    // if 'interruptible' is set, the iteration stops when the budget
+    // is exceeded (the results are then over-approximated in run())
+    bool iteration(bool interruptible = false) {
         assert(changed.empty());
+        PointerIDLookupTable::Scope scope(&PG->getPointerIDs());
 
         for (PSNode *cur : to_process) {
+            if (interruptible && shouldCheckBudget() && checkBudget())
+                break;
+
+            PointerAnalysisProfile::NodeScope prof(profile.get(), cur);
             bool enq = false;
             enq |= beforeProcessed(cur);
             enq |= processNode(cur);
@@ -123,7 +204,7 @@ class PointerAnalysis {
         }
     }
 
-    bool run();
+    virtual bool run();
 
     // generic error
     // @msg - message for the user
@@ -163,15 +244,95 @@ class PointerAnalysis {
     // we do not need to pass this to the LLVM part...
     virtual bool handleJoin(PSNode *) { return false; }
 
-  private:
+  protected:
     // check the sanity of results of pointer analysis
     void sanityCheck();
 
+    // start measuring the time of the analysis (if not started yet)
+    void startBudget();
+    // return true if the budget is exceeded (then it stays exceeded)
+    bool checkBudget();
+    // true every N-th call, so that the budget can be checked
+    // while processing nodes without slowing down the analysis
+    bool shouldCheckBudget() {
+        if (!options.hasBudget())
+            return false;
+        if (budget_countdown > 0) {
+            --budget_countdown;
+            return false;
+        }
+        budget_countdown = 255;
+        return true;
+    }
+
+    // add the unknown pointer to the points-to sets of the nodes
+    // that could still change: 'pending' and all the nodes
+    // that depend on them (used when the budget is exceeded).
+    // If the memory is flow-sensitive, any pending node may carry
+    // the memory to the loads, so all the loads are over-approximated.
+    void overApproximate(const std::vector<PSNode *> &pending,
+                         bool flowSensitive = false);
+
+    // the memory is tracked for every node separately
+    virtual bool hasFlowSensitiveMemory() const { return false; }
+
+    // the memory objects live for the whole analysis and their contents
+    // only grow (via the methods of MemoryObject, so their versions
+    // are up-to-date). Then memcpy does not need to copy again
+    // the objects that did not change since the last copy.
+    virtual bool hasPersistentMemoryObjects() const { return false; }
+
+    // record that a GEP yielded the offset into the object,
+    // return false if the pointer must get Offset::UNKNOWN instead
+    bool trackOffset(PSNode *target, Offset::type offset) const;
+
+    ///
+    // Collapse the objects that exceeded the limit on offsets since
+    // the last call: the pointers into them (except the pointers to their
+    // beginning) get Offset::UNKNOWN in all points-to sets and in memory
+    // (see collapseMemory()). The nodes whose points-to sets changed
+    // are added to 'changedNodes', the solver must process them again.
+    // Must not be called while GEPs are processed.
+    bool collapseObjects(std::vector<PSNode *> &changedNodes);
+
+    // replace the pointers to collapsed objects in 'pointers'
+    // (the objects that were collapsed right now are 'objects')
+    bool collapsePointers(PointsToSetT &pointers,
+                          const std::vector<PSNode *> &objects) const;
+
+    // collapse the memory object: if it belongs to a collapsed object,
+    // move its pointers to Offset::UNKNOWN, and replace the pointers
+    // to collapsed objects in it
+    bool collapseObject(MemoryObject *mo,
+                        const std::vector<PSNode *> &objects) const;
+
+    // collapse the memory objects that the analysis keeps
+    // (using collapseObject())
+    virtual void collapseMemory(const std::vector<PSNode *> & /* objects */) {
+    }
+
+    // process the global nodes, these reach the fixpoint
+    // after one iteration
+    void processGlobals();
+
+    // set points-to sets of the given nodes to {}
+    // (used when the analysis is terminated prematurely)
+    static void setToEmpty(const std::vector<PSNode *> &nodes);
+
     bool processNode(PSNode *);
     bool processLoad(PSNode *node);
+    // process the load as if the operand pointed only to 'pointers'
+    bool processLoad(PSNode *node, const PointsToSetT &pointers);
     bool processGep(PSNode *node);
+    // process the GEP as if the source pointed only to 'pointers'
+    bool processGep(PSNode *node, const PointsToSetT &pointers);
+    // the pointer that the GEP yields for the pointer 'ptr'
+    Pointer getGepPointer(const PSNodeGep *gep, const Pointer &ptr) const;
+    // store 'values' to the memory pointed by 'addresses'
+    bool processStore(PSNode *node, const PointsToSetT &addresses,
+                      const PointsToSetT &values);
     bool processMemcpy(PSNode *node);
-    bool processMemcpy(std::vector<MemoryObject *> &srcObjects,
+    bool processMemcpy(PSNode *node, std::vector<MemoryObject *> &srcObjects,
                        std::vector<MemoryObject *> &destObjects,
                        const Pointer &sptr, const Pointer &dptr, Offset len);
 };
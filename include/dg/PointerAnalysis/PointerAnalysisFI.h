@@ -3,9 +3,12 @@
 
 #include <cassert>
 #include <memory>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "PointerAnalysis.h"
+#include "dg/util/ThreadPool.h"
 
 namespace dg {
 namespace pta {
@@ -16,6 +19,140 @@ namespace pta {
 class PointerAnalysisFI : public PointerAnalysis {
     std::vector<std::unique_ptr<MemoryObject>> memory_objects;
 
+    ///
+    // What the parallel solver computed for one queued node:
+    // the pointers that were not propagated yet and what they add
+    // to the users. The users that cannot be handled in parallel
+    // are processed when the update is committed.
+    struct ParallelUpdate {
+        std::vector<Pointer> delta;
+        std::vector<std::pair<PSNode *, Pointer>> additions;
+        std::vector<PSNode *> deferred;
+
+        void clear() {
+            delta.clear();
+            additions.clear();
+            deferred.clear();
+        }
+    };
+
+    ///
+    // State of the worklist (difference propagation) solver.
+    // The vectors are indexed by IDs of nodes.
+    struct WorklistState {
+        // pointers that were already propagated to the users of the node
+        std::vector<PointsToSetT> propagated;
+        // the node must be re-evaluated from its operands
+        // (not only its new pointers propagated)
+        std::vector<bool> reevaluate;
+        std::vector<bool> queued;
+        // nodes that are reachable from the entry and thus processed
+        std::vector<bool> reachable;
+        // nodes (loads and memcpy) that read the memory objects
+        std::unordered_map<const MemoryObject *, std::set<PSNode *>> readers;
+        // the representant of a collapsed cycle the node belongs to
+        // (nullptr if the node is its own representant)
+        std::vector<PSNode *> representant;
+        // nodes that were collapsed into some other node
+        std::vector<PSNode *> collapsed;
+        // the nodes collapsed into a representant (see collapse())
+        std::unordered_map<PSNode *, std::vector<PSNode *>> members;
+
+        std::vector<PSNode *> queue;
+        std::vector<PSNode *> next_queue;
+
+        // used only if the solver runs in more threads
+        std::unique_ptr<ThreadPool> pool;
+        // the queued nodes that are processed in the current iteration
+        // and their updates
+        std::vector<PSNode *> active;
+        std::vector<ParallelUpdate> updates;
+
+        // used only in the demand-driven mode ('reachable' are then
+        // the relevant nodes, i.e., the nodes that are processed)
+        // nodes that are reachable from the entry
+        std::vector<bool> inProgram;
+        // stores and memcpys that are not relevant yet, indexed
+        // by the allocation sites that their address may be derived from
+        std::unordered_map<PSNode *, std::vector<PSNode *>> writers;
+        // stores and memcpys whose address may come from memory
+        // (or from a call), we do not know where they write
+        std::vector<PSNode *> unknownWriters;
+        // the writers of unknown memory whose address is relevant,
+        // they become relevant if they write to the read memory
+        std::set<PSNode *> pendingWriters;
+        // relevant loads and memcpys and the objects that they read
+        std::vector<PSNode *> relevantReaders;
+        std::set<PSNode *> readObjects;
+    };
+
+    // the state exists only while the worklist solver is running
+    std::unique_ptr<WorklistState> worklist;
+
+    // the pointers returned by the functions regardless of the callers
+    // and memory (computed by the seeded solver)
+    std::unordered_map<const PointerSubgraph *, std::vector<Pointer>>
+            return_seeds;
+
+    // statistics of the worklist solver
+    size_t processed_nodes_num{0};
+    size_t reseeds_num{0};
+    size_t collapsed_nodes_num{0};
+    size_t collapsed_cycles_num{0};
+    size_t relevant_nodes_num{0};
+    size_t seeded_functions_num{0};
+    size_t seeding_components_num{0};
+    size_t seeding_levels_num{0};
+    size_t seed_pointers_num{0};
+
+    void resizeWorklistState();
+    void schedule(PSNode *n, bool reevaluate = false);
+    void seedWorklist();
+    void notifyReaders(PSNode *writer, const PointsToSetT &addresses);
+    bool reevaluateNode(PSNode *n);
+    void propagate(PSNode *from, PSNode *user, const PointsToSetT &delta);
+    bool processQueue();
+    void initWorklist();
+    bool solveWorklist();
+    void overApproximateQueued(bool graphChanged);
+    void collapseQueued();
+    bool runWorklist();
+
+    // demand-driven mode
+    bool runDemandDriven();
+    bool solveDemand();
+    void seedDemand();
+    void buildWritersIndex(const std::vector<PSNode *> &nodes);
+    bool getOrigins(PSNode *addr, std::set<PSNode *> &origins) const;
+    void addWriters(PSNode *object, std::vector<PSNode *> &roots) const;
+    bool expandDemand();
+    bool addRelevant(std::vector<PSNode *> &roots);
+    bool isQueryAnswered(const PSNode *n) const;
+
+    // seeding the points-to sets before the worklist solver
+    struct SeedingState;
+    void computeSeeds();
+    void seedComponent(SeedingState &state, size_t idx) const;
+
+    // parallel solver
+    bool processQueueParallel();
+    void computeUpdate(PSNode *cur, ParallelUpdate &update) const;
+    bool loadPointers(PSNode *load, const std::vector<Pointer> &pointers,
+                      std::vector<std::pair<PSNode *, Pointer>> &out) const;
+    void commitUpdate(PSNode *cur, ParallelUpdate &update);
+
+    // cycle collapsing
+    PSNode *getRepresentant(PSNode *n);
+    // the same as getRepresentant, but does not shorten the paths
+    // to the representants, so it can be called concurrently
+    PSNode *findRepresentant(PSNode *n) const;
+    bool isCopyNode(PSNode *n) const;
+    void collapseCycles();
+    void collapse(const std::vector<PSNode *> &component);
+    const std::vector<PSNode *> *getMembers(PSNode *rep) const;
+    void propagateToMembers(PSNode *rep, const PointsToSetT &delta);
+    void finishCollapsed();
+
     void preprocessGEPs() {
         // if a node is in a loop (a scc that has more than one node),
         // then every GEP that is also stored to the same memory afterwards
@@ -48,10 +185,8 @@ class PointerAnalysisFI : public PointerAnalysis {
             preprocessGEPs();
     }
 
-    void getMemoryObjects(PSNode *where, const Pointer &pointer,
-                          std::vector<MemoryObject *> &objects) override {
-        // irrelevant in flow-insensitive
-        (void) where;
+    // the node that holds the memory object for the pointer
+    static PSNode *getObjectNode(const Pointer &pointer) {
         PSNode *n = pointer.target;
 
         // we want to have memory in allocation sites
@@ -62,6 +197,14 @@ class PointerAnalysisFI : public PointerAnalysis {
             n = (*n->pointsTo.begin()).target;
         }
 
+        return n;
+    }
+
+    void getMemoryObjects(PSNode *where, const Pointer &pointer,
+                          std::vector<MemoryObject *> &objects) override {
+        // irrelevant in flow-insensitive
+        (void) where;
+        PSNode *n = getObjectNode(pointer);
         if (n->getType() == PSNodeType::FUNCTION)
             return;
 
@@ -75,8 +218,73 @@ class PointerAnalysisFI : public PointerAnalysis {
             n->setData<MemoryObject>(mo);
         }
 
+        // the worklist solver needs to know who reads the memory,
+        // so that it can re-process the readers when the memory changes
+        if (worklist && (where->getType() == PSNodeType::LOAD ||
+                         where->getType() == PSNodeType::MEMCPY))
+            worklist->readers[mo].insert(where);
+
         objects.push_back(mo);
     }
+
+    bool hasPersistentMemoryObjects() const override { return true; }
+
+    void collapseMemory(const std::vector<PSNode *> &objects) override;
+
+    bool run() override {
+        startBudget();
+        if (options.demandDriven)
+            return runDemandDriven();
+        if (options.isWorklistSolver())
+            return runWorklist();
+        return PointerAnalysis::run();
+    }
+
+    ///
+    // Compute the points-to set of the node 'n' in the demand-driven mode
+    // (after run() was called). Only the nodes that the points-to set of 'n'
+    // depends on are processed and they stay processed, so a repeated query
+    // is answered immediately and later queries reuse the computed sets.
+    // Returns false if the maximal number of iterations was reached.
+    bool query(PSNode *n);
+
+    // The same as query(), but computes the points-to sets of all
+    // the given nodes at once, so that the nodes that they depend on
+    // are processed in a single run of the solver.
+    bool query(const std::vector<PSNode *> &nodes);
+
+    // number of nodes processed by the worklist solver
+    size_t getNumOfProcessedNodes() const { return processed_nodes_num; }
+    // how many times the worklist solver had to re-seed the worklist
+    // because the graph changed (e.g., a new function was called via pointer)
+    size_t getNumOfReseeds() const { return reseeds_num; }
+    // number of nodes that were collapsed into other nodes
+    // (i.e., not counting the representants of the cycles)
+    size_t getNumOfCollapsedNodes() const { return collapsed_nodes_num; }
+    size_t getNumOfCollapsedCycles() const { return collapsed_cycles_num; }
+    // number of nodes that the demand-driven queries found relevant
+    size_t getNumOfRelevantNodes() const { return relevant_nodes_num; }
+
+    // the pointers that the function returns regardless of its callers
+    // and of the memory (nullptr if the seeded solver did not run
+    // or the function was not reachable)
+    const std::vector<Pointer> *
+    getReturnSeeds(const PointerSubgraph *subgraph) const {
+        auto it = return_seeds.find(subgraph);
+        return it == return_seeds.end() ? nullptr : &it->second;
+    }
+
+    // statistics of the seeded solver
+    size_t getNumOfSeededFunctions() const {
+        return seeded_functions_num;
+    }
+    // strongly connected components of the call graph
+    // and the number of their levels (components in one level
+    // do not depend on each other and are seeded in parallel)
+    size_t getNumOfSeedingComponents() const { return seeding_components_num; }
+    size_t getNumOfSeedingLevels() const { return seeding_levels_num; }
+    // number of pointers that the seeding added to the points-to sets
+    size_t getNumOfSeedPointers() const { return seed_pointers_num; }
 };
 
 } // namespace pta
@@ -3,9 +3,11 @@
 
 #include <cassert>
 #include <memory>
+#include <set>
 
 #include "MemoryObject.h"
 #include "PointerGraph.h"
+#include "dg/util/cow_shared_ptr.h"
 
 namespace dg {
 namespace pta {
@@ -13,10 +15,28 @@ namespace pta {
 ///
 // Flow-sensitive pointer analysis
 //
+// Every node that can change the memory has its own memory map.
+// The memory objects in the maps are copy-on-write: a map takes
+// the object from its predecessor if it would not change it,
+// so the objects that are not changed are shared between the maps
+// (unless turned off by PointerAnalysisOptions::copyOnWriteMemory).
+// An object that is shared must not be modified, use getWritable().
 class PointerAnalysisFS : public PointerAnalysis {
   public:
-    // using MemoryObjectsSetT = std::set<MemoryObject *>;
-    using MemoryMapT = std::map<PSNode *, std::unique_ptr<MemoryObject>>;
+    using MemoryObjectPtrT = cow_shared_ptr<MemoryObject>;
+    using MemoryMapT = std::map<PSNode *, MemoryObjectPtrT>;
+
+    struct MemoryStats {
+        // the number of memory maps
+        size_t maps{0};
+        // the number of entries in all memory maps
+        size_t entries{0};
+        // the number of distinct memory objects in the maps
+        // (less than entries if the objects are shared)
+        size_t objects{0};
+        // the number of pointers stored in the distinct objects
+        size_t pointers{0};
+    };
 
     // this is an easy but not very efficient implementation,
     // works for testing
@@ -30,6 +50,8 @@ class PointerAnalysisFS : public PointerAnalysis {
 
     PointerAnalysisFS(PointerGraph *ps) : PointerAnalysisFS(ps, {}) {}
 
+    bool hasFlowSensitiveMemory() const override { return true; }
+
     bool beforeProcessed(PSNode *n) override {
         MemoryMapT *mm = n->getData<MemoryMapT>();
         if (mm)
@@ -73,10 +95,12 @@ class PointerAnalysisFS : public PointerAnalysis {
         assert(mm && "Do not have memory map");
 
         // every store that stores to a memory allocated
-        // not in a loop is a strong update
+        // not in a loop is a strong update (but not a store
+        // to a collapsed object, we do not know its offset)
         // FIXME: memcpy can be strong update too
         if (n->getType() == PSNodeType::STORE) {
-            if (!pointsToAllocationInLoop(n->getOperand(1)))
+            if (!pointsToAllocationInLoop(n->getOperand(1)) &&
+                !pointsToCollapsedObject(n->getOperand(1)))
                 overwritten = &n->getOperand(1)->pointsTo;
         }
 
@@ -126,20 +150,124 @@ class PointerAnalysisFS : public PointerAnalysis {
 
         auto I = mm->find(pointer.target);
         if (I != mm->end()) {
-            objects.push_back(I->second.get());
+            if (writesTo(where, pointer.target))
+                objects.push_back(getWritable(I->second, pointer.target));
+            else // only reads the object
+                objects.push_back(const_cast<MemoryObject *>(I->second.get()));
         }
 
         // if we haven't found any memory object, but this psnode
         // is a write to memory, create a new one, so that
         // the write has something to write to
         if (objects.empty() && canChangeMM(where)) {
-            MemoryObject *mo = new MemoryObject(pointer.target);
-            mm->emplace(pointer.target, std::unique_ptr<MemoryObject>(mo));
-            objects.push_back(mo);
+            objects.push_back(getWritable((*mm)[pointer.target],
+                                          pointer.target));
+        }
+    }
+
+    void collapseMemory(const std::vector<PSNode *> &objects) override {
+        std::set<MemoryObject *> visited;
+        for (const auto &mm : memoryMaps) {
+            for (auto &it : *mm) {
+                // the objects may be shared by more maps, but all the maps
+                // would get the same result, so change them in place
+                auto *mo = const_cast<MemoryObject *>(it.second.get());
+                if (mo && visited.insert(mo).second)
+                    collapseObject(mo, objects);
+            }
+        }
+    }
+
+    MemoryStats getMemoryStats() const {
+        MemoryStats stats;
+        std::set<const MemoryObject *> objects;
+        for (const auto &mm : memoryMaps) {
+            ++stats.maps;
+            for (const auto &it : *mm) {
+                ++stats.entries;
+                if (!objects.insert(it.second.get()).second)
+                    continue;
+                for (const auto &ptsIt : *it.second.get())
+                    stats.pointers += ptsIt.second.size();
+            }
         }
+        stats.objects = objects.size();
+        return stats;
     }
 
   protected:
+    // get the object that can be modified by the memory map 'mo' is in,
+    // copy the object if it is shared with other maps
+    static MemoryObject *getWritable(MemoryObjectPtrT &mo, PSNode *target) {
+        if (!mo.get())
+            mo.reset(new MemoryObject(target));
+        else if (mo.use_count() > 1)
+            mo.reset(new MemoryObject(*mo.get()));
+
+        return mo.getWritable();
+    }
+
+    // does the node (that has its own memory map) write to the target?
+    static bool writesTo(PSNode *n, PSNode *target) {
+        if (!canChangeMM(n))
+            return false;
+        // memcpy only reads from the source
+        if (auto *memcpy = PSNodeMemcpy::get(n))
+            return memcpy->getDestination()->pointsTo.pointsToTarget(target);
+        return true;
+    }
+
+    static bool isEmpty(const MemoryObject *mo) {
+        for (const auto &it : *mo) {
+            if (!it.second.empty())
+                return false;
+        }
+        return true;
+    }
+
+    // are all the pointers of 'mo' also in 'of'?
+    static bool isSubset(const MemoryObject *mo, const MemoryObject *of) {
+        for (const auto &it : *mo) {
+            if (it.second.empty())
+                continue;
+
+            auto ofIt = of->find(it.first);
+            if (ofIt == of->end())
+                return false;
+
+            for (const auto &ptr : it.second) {
+                if (!ofIt->second.has(ptr))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    ///
+    // Make 'to' share the object 'from' if merging 'from' to 'to'
+    // would yield just 'from' (that is, 'to' is empty or
+    // a subset of 'from'). Set 'changed' if the contents
+    // of 'to' changed. Return false if the object cannot be shared.
+    bool shareObject(MemoryObjectPtrT &to, const MemoryObjectPtrT &from,
+                     bool &changed) const {
+        if (!options.copyOnWriteMemory)
+            return false;
+
+        if (to.get() == from.get())
+            return true;
+
+        if (to.get()) {
+            if (!isSubset(to.get(), from.get()))
+                return false;
+            changed |= !isSubset(from.get(), to.get());
+        } else {
+            changed |= !isEmpty(from.get());
+        }
+
+        to = from;
+        return true;
+    }
+
     static bool canChangeMM(PSNode *n) {
         switch (n->getType()) {
         case PSNodeType::STORE:
@@ -164,7 +292,8 @@ class PointerAnalysisFS : public PointerAnalysis {
         return false;
     }
 
-    static bool mergeObjects(PSNode *node, MemoryObject *to, MemoryObject *from,
+    static bool mergeObjects(PSNode *node, MemoryObject *to,
+                             const MemoryObject *from,
                              PointsToSetT *overwritten) {
         bool changed = false;
 
@@ -182,17 +311,20 @@ class PointerAnalysisFS : public PointerAnalysis {
 
     // Merge two Memory maps, return true if any new information was created,
     // otherwise return false
-    static bool mergeMaps(MemoryMapT *mm, MemoryMapT *from,
-                          PointsToSetT *overwritten) {
+    bool mergeMaps(MemoryMapT *mm, MemoryMapT *from,
+                   PointsToSetT *overwritten) {
         bool changed = false;
         for (auto &it : *from) {
             PSNode *fromTarget = it.first;
-            std::unique_ptr<MemoryObject> &toMo = (*mm)[fromTarget];
-            if (toMo == nullptr)
-                toMo.reset(new MemoryObject(fromTarget));
+            MemoryObjectPtrT &toMo = (*mm)[fromTarget];
+            // the object is not (partially) overwritten,
+            // so we may just take the object from the predecessor
+            if ((!overwritten || !overwritten->pointsToTarget(fromTarget)) &&
+                shareObject(toMo, it.second, changed))
+                continue;
 
-            changed |= mergeObjects(fromTarget, toMo.get(), it.second.get(),
-                                    overwritten);
+            changed |= mergeObjects(fromTarget, getWritable(toMo, fromTarget),
+                                    it.second.get(), overwritten);
         }
 
         return changed;
@@ -221,6 +353,16 @@ class PointerAnalysisFS : public PointerAnalysis {
         return false;
     }
 
+    bool pointsToCollapsedObject(PSNode *n) const {
+        if (collapsed_objects.empty())
+            return false;
+        for (const auto &ptr : n->pointsTo) {
+            if (isCollapsedObject(ptr.target))
+                return true;
+        }
+        return false;
+    }
+
     static inline bool needsMerge(PSNode *n) {
         return n->predecessorsNum() > 1 ||
                n->predecessorsNum() == 0 ||               // root node
@@ -19,12 +19,9 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
     }
 
     static MemoryObject *getOrCreateMO(MemoryMapT *mm, PSNode *target) {
-        std::unique_ptr<MemoryObject> &moptr = (*mm)[target];
-        if (!moptr)
-            moptr.reset(new MemoryObject(target));
-
+        MemoryObject *mo = getWritable((*mm)[target], target);
         assert(mm->find(target) != mm->end());
-        return moptr.get();
+        return mo;
     }
 
   public:
@@ -92,7 +89,7 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
                alloc->getParent() == where->getParent();
     }
 
-    bool containsRemovableLocals(PSNode *where, PointsToSetT &S) {
+    bool containsRemovableLocals(PSNode *where, const PointsToSetT &S) {
         for (const auto &ptr : S) {
             if (ptr.isNull() || ptr.isUnknown() || ptr.isInvalidated())
                 continue;
@@ -106,6 +103,14 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
         return false;
     }
 
+    bool containsRemovableLocals(PSNode *where, const MemoryObject *mo) {
+        for (const auto &it : *mo) {
+            if (containsRemovableLocals(where, it.second))
+                return true;
+        }
+        return false;
+    }
+
     // not very efficient
     void replaceLocalsWithInv(PSNode *where, PointsToSetT &S1) {
         PointsToSetT S;
@@ -155,10 +160,16 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
             if (isInvalidTarget(I.first))
                 continue;
 
+            // the object does not point to any destroyed memory,
+            // just take it from the predecessor if we can
+            if (!containsRemovableLocals(node, I.second.get()) &&
+                shareObject((*mm)[I.first], I.second, changed))
+                continue;
+
             // get or create a memory object for this target
 
             MemoryObject *mo = getOrCreateMO(mm, I.first);
-            MemoryObject *pmo = I.second.get();
+            const MemoryObject *pmo = I.second.get();
 
             for (auto &it : *mo) {
                 // remove pointers to locals from the points-to set
@@ -169,8 +180,8 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
                 }
             }
 
-            for (auto &it : *pmo) {
-                PointsToSetT &predS = it.second;
+            for (const auto &it : *pmo) {
+                const PointsToSetT &predS = it.second;
                 if (predS.empty())
                     continue;
 
@@ -274,6 +285,23 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
         return nullptr;
     }
 
+    // may the object point to the memory invalidated via 'operand'?
+    // (that is, would the invalidation change the object?)
+    static bool mayPointToInvalidated(const PSNode *operand,
+                                      const MemoryObject *mo) {
+        if (operand->pointsTo.hasUnknown())
+            return !isEmpty(mo);
+
+        for (const auto &it : *mo) {
+            for (const auto &ptr : it.second) {
+                if (ptr.isValid() &&
+                    operand->pointsTo.pointsToTarget(ptr.target))
+                    return true;
+            }
+        }
+        return false;
+    }
+
     bool overwriteMOFromFree(MemoryMapT *mm, PSNode *target) {
         // if we know exactly which memory object
         // is being used for freeing the memory,
@@ -325,9 +353,15 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
             if (strong_update == I.first)
                 continue;
 
+            // the object does not point to the invalidated memory,
+            // just take it from the predecessor if we can
+            if (!mayPointToInvalidated(operand, I.second.get()) &&
+                shareObject((*mm)[I.first], I.second, changed))
+                continue;
+
             // get or create a memory object for this target
             MemoryObject *mo = getOrCreateMO(mm, I.first);
-            MemoryObject *pmo = I.second.get();
+            const MemoryObject *pmo = I.second.get();
 
             // Remove references to invalidated memory from mo
             // if the invalidated object is just one.
@@ -363,8 +397,8 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
 
             // merge pointers from pmo to mo, but skip
             // the pointers that may point to the freed memory
-            for (auto &it : *pmo) {
-                PointsToSetT &predS = it.second;
+            for (const auto &it : *pmo) {
+                const PointsToSetT &predS = it.second;
                 if (predS.empty()) // keep the map clean
                     continue;
 
@@ -2,10 +2,28 @@
 #define DG_POINTER_ANALYSIS_OPTIONS_H_
 
 #include "dg/AnalysisOptions.h"
+#include "dg/PointerAnalysis/PointsToSets/PointsToSetKind.h"
 
 namespace dg {
 
 struct PointerAnalysisOptions : AnalysisOptions {
+    // The algorithm used to compute the fixpoint.
+    //  - iterative: in every iteration, process all nodes that are
+    //    reachable from the nodes that changed in the last iteration
+    //  - worklist: process only the users of changed nodes and
+    //    propagate only the newly added pointers (difference
+    //    propagation). Available only for flow-insensitive analysis.
+    //  - seeded: first seed the points-to sets with the pointers that
+    //    do not depend on the callers and memory, over the components
+    //    of the call graph, callees first (independent functions
+    //    in parallel), then finish with the worklist solver.
+    //    Flow-insensitive only.
+    enum class Solver {
+        iterative,
+        worklist,
+        seeded
+    } solver{Solver::iterative};
+
     // Preprocess GEP nodes such that the offset
     // is directly set to UNKNOWN if we can identify
     // that it will be the result of the computation
@@ -18,6 +36,57 @@ struct PointerAnalysisOptions : AnalysisOptions {
     // INVALIDATED object.
     bool invalidateNodes{false};
 
+    // Detect cycles of nodes that only copy pointers (casts, PHIs,
+    // GEPs with zero offset, ...) and collapse them into a single
+    // node, as all these nodes have the same points-to set.
+    // Used only by the worklist solver.
+    bool collapseCycles{false};
+
+    // The number of threads used by the worklist solver. With more than
+    // one thread, the new pointers of the queued nodes are propagated
+    // to their users in parallel (in every iteration of the solver)
+    // and the results are then committed in the order of the queue.
+    unsigned solverThreads{1};
+
+    // Compute the points-to sets only on demand: run() only prepares
+    // the analysis and PointerAnalysisFI::query() then solves the part
+    // of the graph that the queried node depends on. Implies the worklist
+    // solver (without collapsing cycles). Flow-insensitive analysis only.
+    bool demandDriven{false};
+
+    // Share the memory objects that did not change between the memory
+    // maps of flow-sensitive analyses and copy them only when they are
+    // written (copy-on-write).
+    bool copyOnWriteMemory{true};
+
+    // Collect the profile of the fixpoint computation (how many times
+    // and how long the nodes were processed, how the points-to sets grew).
+    // See PointerAnalysisProfile.
+    bool profile{false};
+
+    // The budget of the analysis: the wall-clock time in milliseconds
+    // (measured from the start of the analysis) and the peak memory
+    // of the process in megabytes (0 means no limit). When the budget
+    // is exceeded, the analysis stops and adds the unknown pointer to the
+    // points-to sets of all the nodes that could still change, so the
+    // results stay sound, just imprecise.
+    unsigned timeLimit{0};
+    unsigned memoryLimit{0};
+
+    // The representation of points-to sets. The LLVM pointer analysis
+    // sets it to the pointer graph that it builds, other users
+    // call PointerGraph::setPointsToSetKind() themselves.
+    pta::PointsToSetKind pointsToSet{pta::defaultPointsToSetKind};
+
+    // Adaptive field-insensitivity: when GEPs yield pointers to more than
+    // this number of distinct offsets of one object, the object is collapsed
+    // (the pointers into it get Offset::UNKNOWN, except the pointers
+    // to its beginning, and the pointers stored in it are kept
+    // on Offset::UNKNOWN). 0 means no limit.
+    // Unlike fieldSensitivity, this affects only the objects that would
+    // blow up the number of pointers (e.g., big arrays of structures).
+    unsigned maxObjectOffsets{0};
+
     PointerAnalysisOptions &setInvalidateNodes(bool b) {
         invalidateNodes = b;
         return *this;
@@ -26,6 +95,52 @@ struct PointerAnalysisOptions : AnalysisOptions {
         preprocessGeps = b;
         return *this;
     }
+    PointerAnalysisOptions &setCollapseCycles(bool b) {
+        collapseCycles = b;
+        return *this;
+    }
+    PointerAnalysisOptions &setCopyOnWriteMemory(bool b) {
+        copyOnWriteMemory = b;
+        return *this;
+    }
+    PointerAnalysisOptions &setSolverThreads(unsigned n) {
+        solverThreads = n;
+        return *this;
+    }
+    PointerAnalysisOptions &setDemandDriven(bool b) {
+        demandDriven = b;
+        return *this;
+    }
+    PointerAnalysisOptions &setTimeLimit(unsigned ms) {
+        timeLimit = ms;
+        return *this;
+    }
+    PointerAnalysisOptions &setMemoryLimit(unsigned mb) {
+        memoryLimit = mb;
+        return *this;
+    }
+    PointerAnalysisOptions &setProfile(bool b) {
+        profile = b;
+        return *this;
+    }
+    PointerAnalysisOptions &setPointsToSet(pta::PointsToSetKind kind) {
+        pointsToSet = kind;
+        return *this;
+    }
+    PointerAnalysisOptions &setMaxObjectOffsets(unsigned n) {
+        maxObjectOffsets = n;
+        return *this;
+    }
+    PointerAnalysisOptions &setSolver(Solver s) {
+        solver = s;
+        return *this;
+    }
+
+    // the seeded solver finishes with the worklist solver
+    bool isWorklistSolver() const { return solver != Solver::iterative; }
+    bool isSeededSolver() const { return solver == Solver::seeded; }
+
+    bool hasBudget() const { return timeLimit > 0 || memoryLimit > 0; }
 
     // Perform maximally this number of iterations.
     // If exceeded, the analysis is terminated and points-to sets
@@ -0,0 +1,114 @@
+#ifndef DG_POINTER_ANALYSIS_PROFILE_H_
+#define DG_POINTER_ANALYSIS_PROFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "dg/PointerAnalysis/PSNode.h"
+
+namespace dg {
+namespace pta {
+
+class PointerGraph;
+
+///
+// Profile of the fixpoint computation of pointer analysis.
+// It is collected only if PointerAnalysisOptions::profile is set.
+// For every node (and for every type of nodes), it records how many times
+// the node was processed and how long it took. For every iteration
+// of the analysis, it records how many nodes were processed and how many
+// pointers were added to their points-to sets (since the nodes were
+// processed the last time). Only the sequential parts of the solvers
+// are measured, the time spent in the parallel phase of the worklist
+// solver is not attributed to nodes.
+class PointerAnalysisProfile {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t processed{0};
+        // in nanoseconds
+        uint64_t time{0};
+    };
+
+    struct NodeStats : Stats {
+        // the size of the points-to set when the node was processed
+        // the last time
+        size_t lastSize{0};
+    };
+
+    struct IterationStats : Stats {
+        // the number of nodes whose points-to set grew
+        uint64_t changed{0};
+        // the number of pointers added to the points-to sets
+        uint64_t pointers{0};
+    };
+
+  private:
+    // indexed by PSNodeType
+    std::vector<Stats> _types;
+    // indexed by IDs of nodes
+    std::vector<NodeStats> _nodes;
+    std::vector<IterationStats> _iterations;
+    Clock::time_point _iterationStart;
+    bool _inIteration{false};
+
+    void recordNode(const PSNode *node, bool count, Clock::duration time);
+
+  public:
+    ///
+    // Measures one processing of a node: from the creation of the object
+    // to its destruction. Does nothing if 'profile' is null, so it may
+    // be used unconditionally. With 'count' set to false, only the time
+    // is added to the node (e.g., for a later phase of the same processing).
+    class NodeScope {
+        PointerAnalysisProfile *_profile;
+        const PSNode *_node;
+        bool _count;
+        Clock::time_point _start;
+
+      public:
+        NodeScope(PointerAnalysisProfile *profile, const PSNode *node,
+                  bool count = true)
+                : _profile(profile), _node(node), _count(count) {
+            if (_profile)
+                _start = Clock::now();
+        }
+
+        ~NodeScope() {
+            if (_profile)
+                _profile->recordNode(_node, _count, Clock::now() - _start);
+        }
+
+        NodeScope(const NodeScope &) = delete;
+        NodeScope &operator=(const NodeScope &) = delete;
+    };
+
+    void startIteration();
+    void endIteration();
+
+    const std::vector<Stats> &getTypeStats() const { return _types; }
+    const std::vector<NodeStats> &getNodeStats() const { return _nodes; }
+    const std::vector<IterationStats> &getIterations() const {
+        return _iterations;
+    }
+
+    ///
+    // Dump the profile as JSON. The histogram of sizes of points-to sets
+    // is computed from the current points-to sets of the nodes of 'PG'.
+    // 'describe' (if given) returns a description of the node
+    // (e.g., the program value), it is used for the 'top' hottest nodes.
+    void dumpJSON(std::ostream &os, const PointerGraph *PG,
+                  const std::function<std::string(const PSNode *)> &describe =
+                          nullptr,
+                  unsigned top = 20) const;
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_POINTER_ANALYSIS_PROFILE_H_
@@ -0,0 +1,138 @@
+#ifndef DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+#define DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "MemoryObject.h"
+#include "PointerAnalysisFI.h"
+#include "PointerGraph.h"
+
+namespace dg {
+namespace pta {
+
+///
+// Sparse flow-sensitive pointer analysis
+//
+// The analysis first runs the flow-insensitive analysis. From its results,
+// it builds def-use chains of the memory objects (an SSA form of the
+// address-taken memory): every store and memcpy defines the objects it may
+// write to, every join point of the interprocedural CFG merges the
+// definitions that reach it, and every load (memcpy) reads the definition
+// that reaches it. Then the points-to sets are computed again, but the
+// contents of memory are propagated only along the def-use chains instead
+// of keeping a memory map in (almost) every node like PointerAnalysisFS.
+//
+// The call graph is taken from the flow-insensitive analysis
+// (calls via function pointers are resolved by it).
+class PointerAnalysisSFS : public PointerAnalysisFI {
+    ///
+    // A definition of a memory object: a write to the object (store
+    // or memcpy), a merge of the definitions that reach a join point,
+    // or the initial state of the object set by globals.
+    struct MemoryDef {
+        // nullptr for the initial state
+        PSNode *node;
+        MemoryObject object;
+        // definitions that reach this definition
+        std::vector<MemoryDef *> inputs;
+        // definitions that this definition reaches
+        std::vector<MemoryDef *> successors;
+        // nodes that read this definition
+        std::vector<PSNode *> readers;
+
+        MemoryDef(PSNode *n, PSNode *target) : node(n), object(target) {}
+    };
+
+    struct NodeInfo {
+        // memory objects that are (may be) written by the node
+        // according to the flow-insensitive analysis. Sorted.
+        std::vector<PSNode *> writes;
+        // memory objects that are (may be) read by the node. Sorted.
+        std::vector<PSNode *> reads;
+        // definitions of memory objects in this node
+        std::map<PSNode *, MemoryDef *> defs;
+        // definitions that reach the reads of memory objects in this
+        // node (if the node does not define the object itself)
+        std::map<PSNode *, MemoryDef *> uses;
+        // the number of predecessors in the interprocedural CFG
+        unsigned predecessors{0};
+        // is the node reachable from the entry (PointerGraph::getNodes())?
+        bool reachable{false};
+        bool queued{false};
+    };
+
+    std::vector<std::unique_ptr<MemoryDef>> memory_defs;
+    std::vector<NodeInfo> nodes_info;
+    // the initial states of memory objects (written by globals)
+    std::map<PSNode *, MemoryDef *> global_defs;
+    std::vector<PSNode *> queue;
+
+    // are we running the sparse analysis (or the flow-insensitive one)?
+    bool sparse{false};
+    bool processing_globals{false};
+
+    // statistics
+    size_t memory_phis_num{0};
+    size_t def_use_edges_num{0};
+    size_t sparse_processed_nodes_num{0};
+
+    // an empty object for reading memory that has no definition
+    MemoryObject undefined_memory;
+
+    MemoryDef *getOrCreateDef(PSNode *node, PSNode *target,
+                              bool *created = nullptr);
+    MemoryDef *getGlobalDef(PSNode *target);
+    void addDefUseEdge(MemoryDef *from, MemoryDef *to);
+
+    void computeAccesses(const std::vector<PSNode *> &nodes);
+    void resetPointsTo(const std::vector<PSNode *> &nodes);
+    void buildDefUseChains(const std::vector<PSNode *> &nodes);
+    void buildDefUseChains(PSNode *target,
+                           const std::vector<PSNode *> &writers);
+
+    bool isStrongUpdate(PSNode *node, PSNode *target, Offset &off) const;
+    bool mergeInputs(PSNode *node, MemoryDef *def);
+
+    void schedule(PSNode *n);
+    void scheduleReaders(MemoryDef *def);
+    void processSparse(PSNode *n);
+    void runSparse(const std::vector<PSNode *> &nodes);
+    void overApproximateSparse(std::vector<PSNode *> &pending);
+
+  public:
+    PointerAnalysisSFS(PointerGraph *ps) : PointerAnalysisSFS(ps, {}) {}
+
+    // the sparse analysis works on the original GEPs and we do not want
+    // the pre-analysis to rewire the graph by collapsing cycles
+    PointerAnalysisSFS(PointerGraph *ps, PointerAnalysisOptions opts)
+            : PointerAnalysisFI(
+                      ps,
+                      opts.setPreprocessGeps(false).setCollapseCycles(false)) {}
+
+    void getMemoryObjects(PSNode *where, const Pointer &pointer,
+                          std::vector<MemoryObject *> &objects) override;
+
+    bool run() override;
+
+    // the objects of the sparse analysis are merged at join points
+    bool hasPersistentMemoryObjects() const override { return !sparse; }
+
+    // the number of definitions of memory objects (including merges)
+    size_t getNumOfMemoryDefs() const { return memory_defs.size(); }
+    // the number of merges of definitions at join points
+    size_t getNumOfMemoryPhis() const { return memory_phis_num; }
+    // the number of edges between definitions and their uses
+    size_t getNumOfDefUseEdges() const { return def_use_edges_num; }
+    // the number of nodes processed by the sparse analysis
+    size_t getNumOfSparseProcessedNodes() const {
+        return sparse_processed_nodes_num;
+    }
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
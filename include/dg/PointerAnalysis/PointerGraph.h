@@ -113,6 +113,11 @@ class PointerGraph {
     NodesT nodes;
     SubgraphsT _subgraphs;
 
+    // IDs of pointers that are used in the points-to sets of this graph.
+    // (a pointer so that the address does not change when moving the graph)
+    std::unique_ptr<PointerIDLookupTable> _pointer_ids{
+            new PointerIDLookupTable(/* dense = */ true)};
+
     // Take care of assigning ids to new nodes
     unsigned int last_node_id = PointerGraphReservedIDs::LAST_RESERVED_ID;
     unsigned int getNewNodeId() { return ++last_node_id; }
@@ -179,7 +184,8 @@ class PointerGraph {
         initStaticNodes();
     }
 
-    void initStaticNodes();
+    // (re)initialize the points-to sets of the static nodes
+    static void initStaticNodes();
 
     PointerSubgraph *createSubgraph(PSNode *root, PSNode *vararg = nullptr) {
         // NOTE: id of the subgraph is always index in _subgraphs + 1
@@ -190,6 +196,8 @@ class PointerGraph {
 
     template <PSNodeType Type, typename... Args>
     PSNode *create(Args &&...args) {
+        // nodes may initialize their points-to sets
+        PointerIDLookupTable::Scope scope(_pointer_ids.get());
         PSNode *n = nodeFactory<Type>(std::forward<Args>(args)...);
         nodes.emplace_back(n); // C++17 returns a referece
         assert(n->getID() == nodes.size() - 1);
@@ -208,6 +216,45 @@ class PointerGraph {
         return n;
     }
 
+    ///
+    // Move the node 'nd' that was created in the graph 'from' into this
+    // graph. The node gets a new ID as if it was created now and its
+    // points-to set is built again with the pointer IDs of this graph.
+    // The targets of the pointers are mapped by 'target' (e.g., the nodes
+    // that only stood for nodes of this graph in 'from').
+    template <typename MapT>
+    PSNode *adopt(PointerGraph &from, PSNode *nd, MapT target) {
+        assert(from.nodes[nd->getID()].get() == nd && "Inconsistency in nodes");
+        from.nodes[nd->getID()].release();
+        nd->setID(getNewNodeId());
+        nodes.emplace_back(nd);
+        assert(nd->getID() == nodes.size() - 1);
+
+        if (nd->pointsTo.empty())
+            return nd;
+
+        std::vector<Pointer> ptrs;
+        for (const auto &ptr : nd->pointsTo)
+            ptrs.push_back(ptr);
+
+        PointerIDLookupTable::Scope scope(_pointer_ids.get());
+        nd->pointsTo.clear();
+        for (const auto &ptr : ptrs)
+            nd->addPointsTo(target(ptr.target), ptr.offset);
+        return nd;
+    }
+
+    // move the subgraph 'subg' that was created in the graph 'from'
+    // into this graph (the nodes of the subgraph are moved by adopt())
+    PointerSubgraph *adopt(PointerGraph &from, PointerSubgraph *subg) {
+        auto &owner = from._subgraphs[subg->getID() - 1];
+        assert(owner.get() == subg && "Inconsistency in subgraphs");
+        owner.release();
+        subg->_id = static_cast<unsigned>(_subgraphs.size()) + 1;
+        _subgraphs.emplace_back(subg);
+        return subg;
+    }
+
     bool registerCall(PSNode *a, PSNode *b) { return callGraph.addCall(a, b); }
 
     GenericCallGraph<PSNode *> &getCallGraph() { return callGraph; }
@@ -215,6 +262,18 @@ class PointerGraph {
     const SubgraphsT &getSubgraphs() const { return _subgraphs; }
 
     const NodesT &getNodes() const { return nodes; }
+    PointerIDLookupTable &getPointerIDs() { return *_pointer_ids; }
+    const PointerIDLookupTable &getPointerIDs() const { return *_pointer_ids; }
+
+    // The representation of the points-to sets of this graph. It should be
+    // set before the nodes are created, the sets of different
+    // representations are merged slowly.
+    PointsToSetKind getPointsToSetKind() const {
+        return _pointer_ids->getSetKind();
+    }
+    void setPointsToSetKind(PointsToSetKind kind) {
+        _pointer_ids->setSetKind(kind);
+    }
     const GlobalNodesT &getGlobals() const { return _globals; }
     size_t size() const { return nodes.size() + _globals.size(); }
 
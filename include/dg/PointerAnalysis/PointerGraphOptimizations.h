@@ -73,6 +73,39 @@ class PSEquivalentNodesMerger {
     unsigned merged_nodes_num;
 };
 
+///
+// Offline variable substitution (hash-based value numbering).
+// Find the nodes that are guaranteed to have the same points-to sets
+// before running the analysis and merge them. Every node gets a value
+// number given by its type and the value numbers of its operands
+// (e.g., two loads from the same pointer or two GEPs of the same pointer
+// with the same offset get the same value number), a cast or a PHI
+// with only one distinct operand gets the value number of the operand.
+// The nodes with the same value number are merged into one.
+// Loads are merged too, so the result is valid only for flow-insensitive
+// analysis. The nodes whose operands may be added during the analysis
+// (the arguments of functions) and the global nodes are never removed.
+class PSVariableSubstitution {
+  public:
+    using MappingT = PointsToMapping<PSNode *>;
+
+    PSVariableSubstitution(PointerGraph *g) : G(g) {}
+
+    MappingT &getMapping() { return mapping; }
+    const MappingT &getMapping() const { return mapping; }
+
+    unsigned run();
+
+  private:
+    void merge(PSNode *node, PSNode *repr);
+
+    PointerGraph *G;
+    // map nodes to its equivalent representant
+    MappingT mapping;
+
+    unsigned merged_nodes_num{0};
+};
+
 class PointerGraphOptimizer {
     using MappingT = PointsToMapping<PSNode *>;
 
@@ -105,6 +138,16 @@ class PointerGraphOptimizer {
         }
     }
 
+    // valid only for flow-insensitive analysis, therefore it is not
+    // a part of run()
+    void substituteVariables() {
+        PSVariableSubstitution substitution(G);
+        if (auto r = substitution.run()) {
+            mapping.merge(std::move(substitution.getMapping()));
+            removed += r;
+        }
+    }
+
     unsigned run() {
         removeNoops();
         removeEquivalentNodes();
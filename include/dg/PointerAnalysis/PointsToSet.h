@@ -3,16 +3,22 @@
 
 #include "dg/PointerAnalysis/PointsToSets/AlignedPointerIdPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/AlignedSmallOffsetsPointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/CompressedPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/OffsetsSetPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/PointerIdPointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/PointsToSetKind.h"
+#include "dg/PointerAnalysis/PointsToSets/SelectablePointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/SeparateOffsetsPointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/SharedPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/SimplePointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/SmallOffsetsPointsToSet.h"
 
 namespace dg {
 namespace pta {
 
-using PointsToSetT = PointerIdPointsToSet;
+// the representation is selected at run time,
+// see PointerAnalysisOptions::pointsToSet
+using PointsToSetT = SelectablePointsToSet;
 using PointsToMapT = std::map<Offset, PointsToSetT>;
 
 } // namespace pta
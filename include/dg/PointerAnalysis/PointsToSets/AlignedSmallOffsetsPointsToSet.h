@@ -165,6 +165,14 @@ class AlignedSmallOffsetsPointsToSet {
 
     bool hasNull() const { return pointsToTarget(NULLPTR); }
 
+    bool hasNullWithOffset() const {
+        for (const auto &ptr : *this) {
+            if (ptr.target == NULLPTR && *ptr.offset != 0)
+                return true;
+        }
+        return false;
+    }
+
     bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
 
     size_t size() const { return pointers.size() + oddPointers.size(); }
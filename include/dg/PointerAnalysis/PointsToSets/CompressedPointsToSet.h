@@ -0,0 +1,244 @@
+#ifndef DG_COMPRESSED_POINTS_TO_SET_H_
+#define DG_COMPRESSED_POINTS_TO_SET_H_
+
+#include "LookupTable.h"
+#include "dg/ADT/CompressedBitmap.h"
+#include "dg/PointerAnalysis/Pointer.h"
+
+#include <cassert>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace pta {
+
+class PSNode;
+
+///
+// Points-to set that stores the IDs of pointers (as PointerIdPointsToSet)
+// in a compressed (Roaring-style) bitmap. The IDs are assigned
+// consecutively, so the sets that contain many pointers are dense
+// and the unions of them are done word-parallel on bitmap containers.
+class CompressedPointsToSet {
+    // the table that assigns IDs to the pointers in this set.
+    // It is set when the first pointer is added into the set.
+    PointerIDLookupTable *table{nullptr};
+
+    using PointersT = ADT::CompressedBitmap;
+    PointersT pointers;
+
+    PointerIDLookupTable &getTable() {
+        if (!table)
+            table = &PointerIDLookupTable::getCurrent();
+        return *table;
+    }
+
+    // if the pointer doesn't have ID, it's assigned one
+    size_t getPointerID(const Pointer &ptr) {
+        return getTable().getOrCreate(ptr);
+    }
+
+    // get the ID of the pointer, 0 if the pointer has no ID
+    // (and thus it cannot be in this set)
+    size_t findPointerID(const Pointer &ptr) const {
+        return table ? table->get(ptr) : 0;
+    }
+
+    const Pointer &getPointer(size_t id) const { return table->get(id); }
+
+    bool addWithUnknownOffset(PSNode *node) {
+        auto ptrid = getPointerID({node, Offset::UNKNOWN});
+        if (!pointers.get(ptrid)) {
+            removeAny(node);
+            return !pointers.set(ptrid);
+        }
+        return false; // we already had it
+    }
+
+  public:
+    CompressedPointsToSet() = default;
+    explicit CompressedPointsToSet(const std::initializer_list<Pointer> &elems) {
+        add(elems);
+    }
+
+    bool add(PSNode *target, Offset off) { return add(Pointer(target, off)); }
+
+    bool add(const Pointer &ptr) {
+        if (has({ptr.target, Offset::UNKNOWN})) {
+            return false;
+        }
+        if (ptr.offset.isUnknown()) {
+            return addWithUnknownOffset(ptr.target);
+        }
+        return !pointers.set(getPointerID(ptr));
+    }
+
+    template <typename ContainerTy>
+    bool add(const ContainerTy &C) {
+        bool changed = false;
+        for (const auto &ptr : C)
+            changed |= add(ptr);
+        return changed;
+    }
+
+    bool add(const CompressedPointsToSet &S) {
+        if (S.empty())
+            return false;
+        if (!table)
+            table = S.table;
+        if (table == S.table)
+            return pointers.set(S.pointers);
+
+        // the sets use different tables (e.g., one of them belongs
+        // to a static node), we must add the pointers one by one
+        bool changed = false;
+        for (const auto &ptr : S)
+            changed |= add(ptr);
+        return changed;
+    }
+
+    bool remove(const Pointer &ptr) {
+        auto id = findPointerID(ptr);
+        return id != 0 && pointers.unset(id);
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    bool removeAny(PSNode *target) {
+        const auto *ids = table ? table->getIDs(target) : nullptr;
+        if (!ids)
+            return false;
+
+        // the table knows all the pointers to the target,
+        // go over the whole set only if it is smaller
+        if (ids->size() <= pointers.size()) {
+            bool changed = false;
+            for (const auto &it : *ids)
+                changed |= pointers.unset(it.second);
+            return changed;
+        }
+
+        std::vector<PointersT::IndexT> removed;
+        for (auto ptrid : pointers) {
+            if (getPointer(ptrid).target == target)
+                removed.push_back(ptrid);
+        }
+
+        for (auto ptrid : removed)
+            pointers.unset(ptrid);
+
+        return !removed.empty();
+    }
+
+    void clear() {
+        pointers.reset();
+        table = nullptr;
+    }
+
+    bool pointsTo(const Pointer &ptr) const {
+        auto id = findPointerID(ptr);
+        return id != 0 && pointers.get(id);
+    }
+
+    bool mayPointTo(const Pointer &ptr) const {
+        return pointsTo(ptr) || pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer &ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        for (auto ptrid : pointers) {
+            auto &ptr = getPointer(ptrid);
+            if (ptr.target == target) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isSingleton() const { return pointers.size() == 1; }
+
+    bool empty() const { return pointers.empty(); }
+
+    size_t count(const Pointer &ptr) const { return pointsTo(ptr); }
+
+    bool has(const Pointer &ptr) const { return count(ptr) > 0; }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+
+    bool hasNullWithOffset() const {
+        for (auto ptrid : pointers) {
+            auto &ptr = getPointer(ptrid);
+            if (ptr.target == NULLPTR && *ptr.offset != 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const { return pointers.size(); }
+
+    void swap(CompressedPointsToSet &rhs) {
+        pointers.swap(rhs.pointers);
+        std::swap(table, rhs.table);
+    }
+
+    class const_iterator {
+        const PointerIDLookupTable *table;
+        typename PointersT::const_iterator container_it;
+
+        const_iterator(const PointerIDLookupTable *t, const PointersT &pointers,
+                       bool end = false)
+                : table(t),
+                  container_it(end ? pointers.end() : pointers.begin()) {}
+
+      public:
+        const_iterator &operator++() {
+            container_it++;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const {
+            return Pointer(table->get(*container_it));
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            return container_it == rhs.container_it;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class CompressedPointsToSet;
+    };
+
+    const_iterator begin() const { return const_iterator(table, pointers); }
+    const_iterator end() const {
+        return const_iterator(table, pointers, true /* end */);
+    }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_COMPRESSED_POINTS_TO_SET_H_
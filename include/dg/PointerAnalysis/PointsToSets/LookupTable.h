@@ -1,6 +1,8 @@
 #ifndef DG_PTSETS_LOOKUPTABLE_H_
 #define DG_PTSETS_LOOKUPTABLE_H_
 
+#include <atomic>
+#include <cassert>
 #include <map>
 #include <vector>
 
@@ -10,24 +12,40 @@
 #include "dg/ADT/Map.h"
 #endif
 
+#include "PointsToSetKind.h"
 #include "dg/PointerAnalysis/Pointer.h"
 
 namespace dg {
 
+///
+// Table that assigns IDs to pointers. Every pointer graph owns its table
+// (see PointerGraph::getPointerIDs()), so that the IDs are released with
+// the graph and analyses of different graphs can run in parallel.
+// The points-to sets use the table that is current in the thread
+// when they get their first pointer (see Scope). If there is no such
+// table, the default table of the thread is used. The new points-to sets
+// also take their representation from the current table (see setSetKind()).
 class PointerIDLookupTable {
   public:
     using IDTy = size_t;
     using Pointer = pta::Pointer;
     using PSNode = pta::PSNode;
 #if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
-    using PtrToIDMap = dg::HashMap<PSNode *, dg::HashMap<Offset, IDTy>>;
+    using OffsetsMapT = dg::HashMap<Offset, IDTy>;
+    using PtrToIDMap = dg::HashMap<PSNode *, OffsetsMapT>;
 #else
     // we create the lookup table statically and there is a bug in GCC
     // that breaks statically created std::unordered_map.
     // So if we have not Hopscotch map, use std::map instead.
-    using PtrToIDMap = dg::Map<PSNode *, dg::Map<Offset, IDTy>>;
+    using OffsetsMapT = dg::Map<Offset, IDTy>;
+    using PtrToIDMap = dg::Map<PSNode *, OffsetsMapT>;
 #endif
 
+    // If 'dense' is true, the pointers are indexed by the IDs
+    // of the target nodes, which requires that all the targets
+    // are from one pointer graph.
+    explicit PointerIDLookupTable(bool dense = false) : _dense(dense) {}
+
     // this will get a new ID for the pointer if not present
     IDTy getOrCreate(const Pointer &ptr) {
         auto res = get(ptr);
@@ -39,7 +57,7 @@ class PointerIDLookupTable {
 #ifndef NDEBUG
         bool r =
 #endif
-                _ptrToID[ptr.target].put(ptr.offset, res);
+                getOffsets(ptr.target).put(ptr.offset, res);
 
         assert(r && "Duplicated ID!");
         assert(get(res) == ptr);
@@ -49,13 +67,14 @@ class PointerIDLookupTable {
     }
 
     IDTy get(const Pointer &ptr) const {
-        auto it = _ptrToID.find(ptr.target);
-        if (it == _ptrToID.end()) {
+        const OffsetsMapT *offsets = findOffsets(ptr.target);
+        if (!offsets)
             return 0; // invalid ID
-        }
-        auto it2 = it->second.find(ptr.offset);
-        if (it2 == it->second.end())
+        auto it2 = offsets->find(ptr.offset);
+        if (it2 == offsets->end())
             return 0;
+        assert(_idToPtr[it2->second - 1].target == ptr.target &&
+               "The pointer is from a different graph");
         return it2->second;
     }
 
@@ -64,16 +83,95 @@ class PointerIDLookupTable {
         return _idToPtr[id - 1];
     }
 
+    size_t size() const { return _idToPtr.size(); }
+
+    // the representation of the points-to sets created
+    // while this table is current
+    pta::PointsToSetKind getSetKind() const { return _setKind; }
+    void setSetKind(pta::PointsToSetKind kind) {
+        _setKind = kind;
+        if (kind != pta::defaultPointsToSetKind)
+            _otherSetKinds.store(true, std::memory_order_relaxed);
+    }
+
+    // Has any table got other representation than the default one?
+    // If not, the new points-to sets do not need to look up the current
+    // table. The flag is set before the table is used, so a thread
+    // that can use the table also sees the flag.
+    static bool hasOtherSetKinds() {
+        return _otherSetKinds.load(std::memory_order_relaxed);
+    }
+
+    // the IDs of all the pointers to 'target' (offset -> ID),
+    // nullptr if there is no such pointer
+    const OffsetsMapT *getIDs(PSNode *target) const {
+        return findOffsets(target);
+    }
+
+    ///
+    // Make 'table' the current table of this thread while the scope
+    // exists. nullptr stands for the default table.
+    class Scope {
+        PointerIDLookupTable *_prev;
+
+      public:
+        Scope(PointerIDLookupTable *table) : _prev(_current) {
+            _current = table;
+        }
+        ~Scope() { _current = _prev; }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    static PointerIDLookupTable &getCurrent() {
+        return _current ? *_current : getDefault();
+    }
+
+    // The table used when no table is current. Every thread has its own
+    // default table that is released when the thread exits, so the sets
+    // that use it must not outlive the thread.
+    static PointerIDLookupTable &getDefault();
+
   private:
+    static thread_local PointerIDLookupTable *_current;
+    static std::atomic<bool> _otherSetKinds;
+
+    bool _dense;
+    pta::PointsToSetKind _setKind{pta::defaultPointsToSetKind};
     // PSNode -> (Offset -> id)
     // Not space efficient, but we need mainly the time efficiency here...
-    // NOTE: unfortunately, atm, we cannot use the id of the target for hashing
-    // because it would break repeated runs of the analysis
-    // as multiple graphs will contain nodes with the same id
-    // (and resetting the state is really painful, I tried that,
-    // but just didn't succeed).
+    // NOTE: the default table cannot use the IDs of targets as
+    // multiple graphs contain nodes with the same id, therefore
+    // only the tables that belong to a graph are dense.
     PtrToIDMap _ptrToID;
+    // ID of node -> (Offset -> id), used if the table is dense
+    std::vector<OffsetsMapT> _nodeToIDs;
     std::vector<Pointer> _idToPtr; // starts from 0 (pointer = idVector[id - 1])
+
+    // defined in PointsToSet.cpp, PSNode is incomplete here
+    static unsigned getNodeID(const PSNode *node);
+
+    const OffsetsMapT *findOffsets(PSNode *target) const {
+        if (_dense) {
+            auto id = getNodeID(target);
+            return id < _nodeToIDs.size() ? &_nodeToIDs[id] : nullptr;
+        }
+
+        auto it = _ptrToID.find(target);
+        return it == _ptrToID.end() ? nullptr : &it->second;
+    }
+
+    OffsetsMapT &getOffsets(PSNode *target) {
+        if (_dense) {
+            auto id = getNodeID(target);
+            if (id >= _nodeToIDs.size())
+                _nodeToIDs.resize(id + 1);
+            return _nodeToIDs[id];
+        }
+
+        return _ptrToID[target];
+    }
 };
 
 /*
@@ -7,6 +7,7 @@
 
 #include <cassert>
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace dg {
@@ -15,7 +16,9 @@ namespace pta {
 class PSNode;
 
 class PointerIdPointsToSet {
-    static PointerIDLookupTable lookupTable;
+    // the table that assigns IDs to the pointers in this set.
+    // It is set when the first pointer is added into the set.
+    PointerIDLookupTable *table{nullptr};
 
 #if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
     using PointersT = ADT::SparseBitvectorHashImpl;
@@ -24,12 +27,24 @@ class PointerIdPointsToSet {
 #endif
     PointersT pointers;
 
+    PointerIDLookupTable &getTable() {
+        if (!table)
+            table = &PointerIDLookupTable::getCurrent();
+        return *table;
+    }
+
     // if the pointer doesn't have ID, it's assigned one
-    size_t getPointerID(const Pointer &ptr) const {
-        return lookupTable.getOrCreate(ptr);
+    size_t getPointerID(const Pointer &ptr) {
+        return getTable().getOrCreate(ptr);
     }
 
-    const Pointer &getPointer(size_t id) const { return lookupTable.get(id); }
+    // get the ID of the pointer, 0 if the pointer has no ID
+    // (and thus it cannot be in this set)
+    size_t findPointerID(const Pointer &ptr) const {
+        return table ? table->get(ptr) : 0;
+    }
+
+    const Pointer &getPointer(size_t id) const { return table->get(id); }
 
     bool addWithUnknownOffset(PSNode *node) {
         auto ptrid = getPointerID({node, Offset::UNKNOWN});
@@ -66,10 +81,25 @@ class PointerIdPointsToSet {
         return changed;
     }
 
-    bool add(const PointerIdPointsToSet &S) { return pointers.set(S.pointers); }
+    bool add(const PointerIdPointsToSet &S) {
+        if (S.empty())
+            return false;
+        if (!table)
+            table = S.table;
+        if (table == S.table)
+            return pointers.set(S.pointers);
+
+        // the sets use different tables (e.g., one of them belongs
+        // to a static node), we must add the pointers one by one
+        bool changed = false;
+        for (const auto &ptr : S)
+            changed |= add(ptr);
+        return changed;
+    }
 
     bool remove(const Pointer &ptr) {
-        return pointers.unset(getPointerID(ptr));
+        auto id = findPointerID(ptr);
+        return id != 0 && pointers.unset(id);
     }
 
     bool remove(PSNode *target, Offset offset) {
@@ -77,11 +107,23 @@ class PointerIdPointsToSet {
     }
 
     bool removeAny(PSNode *target) {
+        const auto *ids = table ? table->getIDs(target) : nullptr;
+        if (!ids)
+            return false;
+
+        bool removed = false;
+        // the table knows all the pointers to the target,
+        // go over the whole set only if it is smaller
+        if (ids->size() <= pointers.size()) {
+            for (const auto &it : *ids)
+                removed |= pointers.unset(it.second);
+            return removed;
+        }
+
         decltype(pointers) tmp;
         tmp.reserve(pointers.size());
-        bool removed = false;
         for (const auto &ptrID : pointers) {
-            if (lookupTable.get(ptrID).target != target) {
+            if (getPointer(ptrID).target != target) {
                 tmp.set(ptrID);
             } else {
                 removed = true;
@@ -93,10 +135,14 @@ class PointerIdPointsToSet {
         return removed;
     }
 
-    void clear() { pointers.reset(); }
+    void clear() {
+        pointers.reset();
+        table = nullptr;
+    }
 
     bool pointsTo(const Pointer &ptr) const {
-        return pointers.get(getPointerID(ptr));
+        auto id = findPointerID(ptr);
+        return id != 0 && pointers.get(id);
     }
 
     bool mayPointTo(const Pointer &ptr) const {
@@ -145,13 +191,19 @@ class PointerIdPointsToSet {
 
     size_t size() const { return pointers.size(); }
 
-    void swap(PointerIdPointsToSet &rhs) { pointers.swap(rhs.pointers); }
+    void swap(PointerIdPointsToSet &rhs) {
+        pointers.swap(rhs.pointers);
+        std::swap(table, rhs.table);
+    }
 
     class const_iterator {
+        const PointerIDLookupTable *table;
         typename PointersT::const_iterator container_it;
 
-        const_iterator(const PointersT &pointers, bool end = false)
-                : container_it(end ? pointers.end() : pointers.begin()) {}
+        const_iterator(const PointerIDLookupTable *t, const PointersT &pointers,
+                       bool end = false)
+                : table(t),
+                  container_it(end ? pointers.end() : pointers.begin()) {}
 
       public:
         const_iterator &operator++() {
@@ -166,7 +218,7 @@ class PointerIdPointsToSet {
         }
 
         Pointer operator*() const {
-            return Pointer(lookupTable.get(*container_it));
+            return Pointer(table->get(*container_it));
         }
 
         bool operator==(const const_iterator &rhs) const {
@@ -180,9 +232,9 @@ class PointerIdPointsToSet {
         friend class PointerIdPointsToSet;
     };
 
-    const_iterator begin() const { return const_iterator(pointers); }
+    const_iterator begin() const { return const_iterator(table, pointers); }
     const_iterator end() const {
-        return const_iterator(pointers, true /* end */);
+        return const_iterator(table, pointers, true /* end */);
     }
 
     friend class const_iterator;
@@ -0,0 +1,88 @@
+#ifndef DG_POINTS_TO_SET_KIND_H_
+#define DG_POINTS_TO_SET_KIND_H_
+
+#include <cstring>
+
+namespace dg {
+namespace pta {
+
+///
+// The representations of points-to sets that the pointer analysis
+// can use (see SelectablePointsToSet).
+enum class PointsToSetKind {
+    pointerId,           // PointerIdPointsToSet
+    compressed,          // CompressedPointsToSet
+    shared,              // SharedPointsToSet
+    simple,              // SimplePointsToSet
+    offsetsSet,          // OffsetsSetPointsToSet
+    separateOffsets,     // SeparateOffsetsPointsToSet
+    smallOffsets,        // SmallOffsetsPointsToSet
+    alignedSmallOffsets, // AlignedSmallOffsetsPointsToSet
+    alignedPointerId     // AlignedPointerIdPointsToSet
+};
+
+// the representation that is used if no other is selected
+#if defined(DG_SHARED_POINTS_TO_SETS)
+constexpr PointsToSetKind defaultPointsToSetKind = PointsToSetKind::shared;
+#elif defined(DG_COMPRESSED_POINTS_TO_SETS)
+constexpr PointsToSetKind defaultPointsToSetKind = PointsToSetKind::compressed;
+#else
+constexpr PointsToSetKind defaultPointsToSetKind = PointsToSetKind::pointerId;
+#endif
+
+constexpr PointsToSetKind allPointsToSetKinds[] = {
+        PointsToSetKind::pointerId,       PointsToSetKind::compressed,
+        PointsToSetKind::shared,          PointsToSetKind::simple,
+        PointsToSetKind::offsetsSet,      PointsToSetKind::separateOffsets,
+        PointsToSetKind::smallOffsets,    PointsToSetKind::alignedSmallOffsets,
+        PointsToSetKind::alignedPointerId};
+
+// the name of the representation used on the command line
+inline const char *getPointsToSetKindName(PointsToSetKind kind) {
+    switch (kind) {
+    case PointsToSetKind::pointerId:
+        return "pointer-id";
+    case PointsToSetKind::compressed:
+        return "compressed";
+    case PointsToSetKind::shared:
+        return "shared";
+    case PointsToSetKind::simple:
+        return "simple";
+    case PointsToSetKind::offsetsSet:
+        return "offsets-set";
+    case PointsToSetKind::separateOffsets:
+        return "separate-offsets";
+    case PointsToSetKind::smallOffsets:
+        return "small-offsets";
+    case PointsToSetKind::alignedSmallOffsets:
+        return "aligned-small-offsets";
+    case PointsToSetKind::alignedPointerId:
+        return "aligned-pointer-id";
+    }
+    return "unknown";
+}
+
+// returns false if there is no representation with the name
+inline bool getPointsToSetKindByName(const char *name, PointsToSetKind &kind) {
+    for (auto k : allPointsToSetKinds) {
+        if (strcmp(getPointsToSetKindName(k), name) == 0) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The representations that can be used by more threads at once.
+// The others use global tables or caches without any locking.
+inline bool isThreadSafe(PointsToSetKind kind) {
+    return kind == PointsToSetKind::pointerId ||
+           kind == PointsToSetKind::compressed ||
+           kind == PointsToSetKind::simple ||
+           kind == PointsToSetKind::offsetsSet;
+}
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_POINTS_TO_SET_KIND_H_
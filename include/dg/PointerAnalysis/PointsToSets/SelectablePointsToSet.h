@@ -0,0 +1,732 @@
+#ifndef DG_SELECTABLE_POINTS_TO_SET_H_
+#define DG_SELECTABLE_POINTS_TO_SET_H_
+
+#include "AlignedPointerIdPointsToSet.h"
+#include "AlignedSmallOffsetsPointsToSet.h"
+#include "CompressedPointsToSet.h"
+#include "LookupTable.h"
+#include "OffsetsSetPointsToSet.h"
+#include "PointerIdPointsToSet.h"
+#include "PointsToSetKind.h"
+#include "SeparateOffsetsPointsToSet.h"
+#include "SharedPointsToSet.h"
+#include "SimplePointsToSet.h"
+#include "SmallOffsetsPointsToSet.h"
+#include "dg/PointerAnalysis/Pointer.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace dg {
+namespace pta {
+
+class PSNode;
+
+// Bind 'S' to the representation stored in 'set' and run the code,
+// the code must return. The pointer-ID representation (the default one)
+// is handled inline, the others in a lambda that is not inlined, so that
+// the operations stay small enough to be inlined into the analyses.
+#define DG_PTSET_DISPATCH(set, ...)                                            \
+    if ((set)._kind == PointsToSetKind::pointerId) {                           \
+        auto &S = (set)._storage.pointerId;                                    \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    return [&]() __attribute__((noinline)) {                                   \
+        switch ((set)._kind) {                                                 \
+        case PointsToSetKind::pointerId:                                       \
+            break;                                                             \
+        case PointsToSetKind::compressed: {                                    \
+            auto &S = (set)._storage.compressed;                               \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::shared: {                                        \
+            auto &S = (set)._storage.shared;                                   \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::simple: {                                        \
+            auto &S = (set)._storage.simple;                                   \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::offsetsSet: {                                    \
+            auto &S = (set)._storage.offsetsSet;                               \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::separateOffsets: {                               \
+            auto &S = *(set)._storage.separateOffsets;                         \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::smallOffsets: {                                  \
+            auto &S = *(set)._storage.smallOffsets;                            \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::alignedSmallOffsets: {                           \
+            auto &S = *(set)._storage.alignedSmallOffsets;                     \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::alignedPointerId: {                              \
+            auto &S = *(set)._storage.alignedPointerId;                        \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        }                                                                      \
+        abort();                                                               \
+    }();
+
+// The same for two sets of the same kind, 'R' is bound to 'rhs'.
+#define DG_PTSET_DISPATCH2(set, rhs, ...)                                      \
+    if ((set)._kind == PointsToSetKind::pointerId) {                           \
+        auto &S = (set)._storage.pointerId;                                    \
+        auto &R = (rhs)._storage.pointerId;                                    \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    return [&]() __attribute__((noinline)) {                                   \
+        switch ((set)._kind) {                                                 \
+        case PointsToSetKind::pointerId:                                       \
+            break;                                                             \
+        case PointsToSetKind::compressed: {                                    \
+            auto &S = (set)._storage.compressed;                               \
+            auto &R = (rhs)._storage.compressed;                               \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::shared: {                                        \
+            auto &S = (set)._storage.shared;                                   \
+            auto &R = (rhs)._storage.shared;                                   \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::simple: {                                        \
+            auto &S = (set)._storage.simple;                                   \
+            auto &R = (rhs)._storage.simple;                                   \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::offsetsSet: {                                    \
+            auto &S = (set)._storage.offsetsSet;                               \
+            auto &R = (rhs)._storage.offsetsSet;                               \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::separateOffsets: {                               \
+            auto &S = *(set)._storage.separateOffsets;                         \
+            auto &R = *(rhs)._storage.separateOffsets;                         \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::smallOffsets: {                                  \
+            auto &S = *(set)._storage.smallOffsets;                            \
+            auto &R = *(rhs)._storage.smallOffsets;                            \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::alignedSmallOffsets: {                           \
+            auto &S = *(set)._storage.alignedSmallOffsets;                     \
+            auto &R = *(rhs)._storage.alignedSmallOffsets;                     \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        case PointsToSetKind::alignedPointerId: {                              \
+            auto &S = *(set)._storage.alignedPointerId;                        \
+            auto &R = *(rhs)._storage.alignedPointerId;                        \
+            __VA_ARGS__;                                                       \
+        }                                                                      \
+        }                                                                      \
+        abort();                                                               \
+    }();
+
+// The same for the iterators of the other representations than
+// the pointer-ID one (see SelectablePointsToSet::const_iterator::Other).
+#define DG_PTSET_ITERATOR_DISPATCH(it, ...)                                    \
+    switch ((it)._kind) {                                                      \
+    case PointsToSetKind::pointerId:                                           \
+        break;                                                                 \
+    case PointsToSetKind::compressed: {                                        \
+        auto &I = (it)._it.compressed;                                         \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::shared: {                                            \
+        auto &I = (it)._it.shared;                                             \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::simple: {                                            \
+        auto &I = (it)._it.simple;                                             \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::offsetsSet: {                                        \
+        auto &I = (it)._it.offsetsSet;                                         \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::separateOffsets: {                                   \
+        auto &I = (it)._it.separateOffsets;                                    \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::smallOffsets: {                                      \
+        auto &I = (it)._it.smallOffsets;                                       \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::alignedSmallOffsets: {                               \
+        auto &I = (it)._it.alignedSmallOffsets;                                \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::alignedPointerId: {                                  \
+        auto &I = (it)._it.alignedPointerId;                                   \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    }                                                                          \
+    abort();
+
+#define DG_PTSET_ITERATOR_DISPATCH2(it, rhs, ...)                              \
+    switch ((it)._kind) {                                                      \
+    case PointsToSetKind::pointerId:                                           \
+        break;                                                                 \
+    case PointsToSetKind::compressed: {                                        \
+        auto &I = (it)._it.compressed;                                         \
+        auto &R = (rhs)._it.compressed;                                        \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::shared: {                                            \
+        auto &I = (it)._it.shared;                                             \
+        auto &R = (rhs)._it.shared;                                            \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::simple: {                                            \
+        auto &I = (it)._it.simple;                                             \
+        auto &R = (rhs)._it.simple;                                            \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::offsetsSet: {                                        \
+        auto &I = (it)._it.offsetsSet;                                         \
+        auto &R = (rhs)._it.offsetsSet;                                        \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::separateOffsets: {                                   \
+        auto &I = (it)._it.separateOffsets;                                    \
+        auto &R = (rhs)._it.separateOffsets;                                   \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::smallOffsets: {                                      \
+        auto &I = (it)._it.smallOffsets;                                       \
+        auto &R = (rhs)._it.smallOffsets;                                      \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::alignedSmallOffsets: {                               \
+        auto &I = (it)._it.alignedSmallOffsets;                                \
+        auto &R = (rhs)._it.alignedSmallOffsets;                               \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    case PointsToSetKind::alignedPointerId: {                                  \
+        auto &I = (it)._it.alignedPointerId;                                   \
+        auto &R = (rhs)._it.alignedPointerId;                                  \
+        __VA_ARGS__;                                                           \
+    }                                                                          \
+    }                                                                          \
+    abort();
+
+///
+// Points-to set whose representation is selected at run time.
+// It stores one of the points-to sets from PointsToSets/ and forwards
+// all the operations to it. New sets use the representation of the current
+// pointer-ID table, i.e., of the pointer graph whose nodes are being
+// created or analyzed (see PointerGraph::setPointsToSetKind(), the LLVM
+// pointer analysis sets it from PointerAnalysisOptions::pointsToSet).
+// Sets of different representations can still be merged and copied,
+// e.g., the sets of the static nodes that are shared by all graphs.
+// In that case, the pointers are added one by one. The representations
+// that are bigger than PointerIdPointsToSet are allocated on the heap,
+// so that they do not make all the sets bigger.
+class SelectablePointsToSet {
+    PointsToSetKind _kind;
+
+    union Storage {
+        PointerIdPointsToSet pointerId;
+        CompressedPointsToSet compressed;
+        SharedPointsToSet shared;
+        SimplePointsToSet simple;
+        OffsetsSetPointsToSet offsetsSet;
+        SeparateOffsetsPointsToSet *separateOffsets;
+        SmallOffsetsPointsToSet *smallOffsets;
+        AlignedSmallOffsetsPointsToSet *alignedSmallOffsets;
+        AlignedPointerIdPointsToSet *alignedPointerId;
+
+        Storage() {}
+        ~Storage() {}
+    } _storage;
+
+    template <typename T>
+    static void _constructInPlace(T &where) {
+        new (&where) T();
+    }
+    template <typename T>
+    static void _copyInPlace(T &where, const T &from) {
+        new (&where) T(from);
+    }
+    template <typename T>
+    static void _moveInPlace(T &where, T &from) {
+        new (&where) T(std::move(from));
+    }
+    template <typename T>
+    static void _destroyInPlace(T &what) {
+        what.~T();
+    }
+
+    // the pointer-ID representation is handled inline, the others
+    // in the *Other() methods that are not inlined
+    void _construct(PointsToSetKind kind) {
+        _kind = kind;
+        if (kind == PointsToSetKind::pointerId)
+            return _constructInPlace(_storage.pointerId);
+        _constructOther();
+    }
+
+    __attribute__((noinline)) void _constructOther() {
+        switch (_kind) {
+        case PointsToSetKind::pointerId:
+            return _constructInPlace(_storage.pointerId);
+        case PointsToSetKind::compressed:
+            return _constructInPlace(_storage.compressed);
+        case PointsToSetKind::shared:
+            return _constructInPlace(_storage.shared);
+        case PointsToSetKind::simple:
+            return _constructInPlace(_storage.simple);
+        case PointsToSetKind::offsetsSet:
+            return _constructInPlace(_storage.offsetsSet);
+        case PointsToSetKind::separateOffsets:
+            _storage.separateOffsets = new SeparateOffsetsPointsToSet();
+            return;
+        case PointsToSetKind::smallOffsets:
+            _storage.smallOffsets = new SmallOffsetsPointsToSet();
+            return;
+        case PointsToSetKind::alignedSmallOffsets:
+            _storage.alignedSmallOffsets = new AlignedSmallOffsetsPointsToSet();
+            return;
+        case PointsToSetKind::alignedPointerId:
+            _storage.alignedPointerId = new AlignedPointerIdPointsToSet();
+            return;
+        }
+        abort();
+    }
+
+    void _copy(const SelectablePointsToSet &rhs) {
+        _kind = rhs._kind;
+        if (_kind == PointsToSetKind::pointerId)
+            return _copyInPlace(_storage.pointerId, rhs._storage.pointerId);
+        _copyOther(rhs);
+    }
+
+    __attribute__((noinline)) void
+    _copyOther(const SelectablePointsToSet &rhs) {
+        switch (_kind) {
+        case PointsToSetKind::pointerId:
+            return _copyInPlace(_storage.pointerId, rhs._storage.pointerId);
+        case PointsToSetKind::compressed:
+            return _copyInPlace(_storage.compressed, rhs._storage.compressed);
+        case PointsToSetKind::shared:
+            return _copyInPlace(_storage.shared, rhs._storage.shared);
+        case PointsToSetKind::simple:
+            return _copyInPlace(_storage.simple, rhs._storage.simple);
+        case PointsToSetKind::offsetsSet:
+            return _copyInPlace(_storage.offsetsSet, rhs._storage.offsetsSet);
+        case PointsToSetKind::separateOffsets:
+            _storage.separateOffsets =
+                    new SeparateOffsetsPointsToSet(*rhs._storage.separateOffsets);
+            return;
+        case PointsToSetKind::smallOffsets:
+            _storage.smallOffsets =
+                    new SmallOffsetsPointsToSet(*rhs._storage.smallOffsets);
+            return;
+        case PointsToSetKind::alignedSmallOffsets:
+            _storage.alignedSmallOffsets = new AlignedSmallOffsetsPointsToSet(
+                    *rhs._storage.alignedSmallOffsets);
+            return;
+        case PointsToSetKind::alignedPointerId:
+            _storage.alignedPointerId = new AlignedPointerIdPointsToSet(
+                    *rhs._storage.alignedPointerId);
+            return;
+        }
+        abort();
+    }
+
+    // 'rhs' is left empty
+    void _move(SelectablePointsToSet &rhs) {
+        _kind = rhs._kind;
+        if (_kind == PointsToSetKind::pointerId)
+            return _moveInPlace(_storage.pointerId, rhs._storage.pointerId);
+        _moveOther(rhs);
+    }
+
+    __attribute__((noinline)) void _moveOther(SelectablePointsToSet &rhs) {
+        switch (_kind) {
+        case PointsToSetKind::pointerId:
+            return _moveInPlace(_storage.pointerId, rhs._storage.pointerId);
+        case PointsToSetKind::compressed:
+            return _moveInPlace(_storage.compressed, rhs._storage.compressed);
+        case PointsToSetKind::shared:
+            return _moveInPlace(_storage.shared, rhs._storage.shared);
+        case PointsToSetKind::simple:
+            return _moveInPlace(_storage.simple, rhs._storage.simple);
+        case PointsToSetKind::offsetsSet:
+            return _moveInPlace(_storage.offsetsSet, rhs._storage.offsetsSet);
+        // take over the allocated sets, 'rhs' gets an empty set
+        // of a representation that does not allocate
+        case PointsToSetKind::separateOffsets:
+            _storage.separateOffsets = rhs._storage.separateOffsets;
+            break;
+        case PointsToSetKind::smallOffsets:
+            _storage.smallOffsets = rhs._storage.smallOffsets;
+            break;
+        case PointsToSetKind::alignedSmallOffsets:
+            _storage.alignedSmallOffsets = rhs._storage.alignedSmallOffsets;
+            break;
+        case PointsToSetKind::alignedPointerId:
+            _storage.alignedPointerId = rhs._storage.alignedPointerId;
+            break;
+        }
+        rhs._construct(PointsToSetKind::pointerId);
+    }
+
+    void _destroy() {
+        if (_kind == PointsToSetKind::pointerId)
+            return _destroyInPlace(_storage.pointerId);
+        _destroyOther();
+    }
+
+    __attribute__((noinline)) void _destroyOther() {
+        switch (_kind) {
+        case PointsToSetKind::pointerId:
+            return _destroyInPlace(_storage.pointerId);
+        case PointsToSetKind::compressed:
+            return _destroyInPlace(_storage.compressed);
+        case PointsToSetKind::shared:
+            return _destroyInPlace(_storage.shared);
+        case PointsToSetKind::simple:
+            return _destroyInPlace(_storage.simple);
+        case PointsToSetKind::offsetsSet:
+            return _destroyInPlace(_storage.offsetsSet);
+        case PointsToSetKind::separateOffsets:
+            delete _storage.separateOffsets;
+            return;
+        case PointsToSetKind::smallOffsets:
+            delete _storage.smallOffsets;
+            return;
+        case PointsToSetKind::alignedSmallOffsets:
+            delete _storage.alignedSmallOffsets;
+            return;
+        case PointsToSetKind::alignedPointerId:
+            delete _storage.alignedPointerId;
+            return;
+        }
+    }
+
+    void _assign(const SelectablePointsToSet &rhs) {
+        DG_PTSET_DISPATCH2(*this, rhs, S = R; return)
+    }
+
+  public:
+    SelectablePointsToSet() { _construct(getDefaultKind()); }
+    explicit SelectablePointsToSet(PointsToSetKind kind) { _construct(kind); }
+    explicit SelectablePointsToSet(
+            const std::initializer_list<Pointer> &elems) {
+        _construct(getDefaultKind());
+        add(elems);
+    }
+
+    SelectablePointsToSet(const SelectablePointsToSet &rhs) { _copy(rhs); }
+    SelectablePointsToSet(SelectablePointsToSet &&rhs) noexcept {
+        _move(rhs);
+    }
+
+    SelectablePointsToSet &operator=(const SelectablePointsToSet &rhs) {
+        if (this == &rhs)
+            return *this;
+        if (_kind == rhs._kind) {
+            _assign(rhs);
+            return *this;
+        }
+        _destroy();
+        _copy(rhs);
+        return *this;
+    }
+
+    SelectablePointsToSet &operator=(SelectablePointsToSet &&rhs) noexcept {
+        if (this != &rhs) {
+            _destroy();
+            _move(rhs);
+        }
+        return *this;
+    }
+
+    ~SelectablePointsToSet() { _destroy(); }
+
+    // the representation of the sets that are created now
+    static PointsToSetKind getDefaultKind() {
+        // do not read the thread-local current table for every set
+        // when no graph uses other representation
+        if (!PointerIDLookupTable::hasOtherSetKinds())
+            return defaultPointsToSetKind;
+        return PointerIDLookupTable::getCurrent().getSetKind();
+    }
+
+    PointsToSetKind getKind() const { return _kind; }
+
+    bool add(PSNode *target, Offset off) { return add(Pointer(target, off)); }
+
+    bool add(const Pointer &ptr) {
+        DG_PTSET_DISPATCH(*this, return S.add(ptr))
+    }
+
+    template <typename ContainerTy>
+    bool add(const ContainerTy &C) {
+        bool changed = false;
+        for (const auto &ptr : C)
+            changed |= add(ptr);
+        return changed;
+    }
+
+    bool add(const SelectablePointsToSet &rhs) {
+        if (_kind == rhs._kind) {
+            DG_PTSET_DISPATCH2(*this, rhs, return S.add(R))
+        }
+
+        bool changed = false;
+        for (const auto &ptr : rhs)
+            changed |= add(ptr);
+        return changed;
+    }
+
+    bool remove(const Pointer &ptr) {
+        DG_PTSET_DISPATCH(*this, return S.remove(ptr))
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    bool removeAny(PSNode *target) {
+        DG_PTSET_DISPATCH(*this, return S.removeAny(target))
+    }
+
+    // the cleared set gets the default representation
+    void clear() {
+        if (_kind == getDefaultKind()) {
+            DG_PTSET_DISPATCH(*this, return S.clear())
+        }
+        _destroy();
+        _construct(getDefaultKind());
+    }
+
+    bool pointsTo(const Pointer &ptr) const {
+        DG_PTSET_DISPATCH(*this, return S.pointsTo(ptr))
+    }
+
+    bool mayPointTo(const Pointer &ptr) const {
+        DG_PTSET_DISPATCH(*this, return S.mayPointTo(ptr))
+    }
+
+    bool mustPointTo(const Pointer &ptr) const {
+        DG_PTSET_DISPATCH(*this, return S.mustPointTo(ptr))
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        DG_PTSET_DISPATCH(*this, return S.pointsToTarget(target))
+    }
+
+    bool isSingleton() const {
+        DG_PTSET_DISPATCH(*this, return S.isSingleton())
+    }
+
+    bool empty() const { DG_PTSET_DISPATCH(*this, return S.empty()) }
+
+    size_t count(const Pointer &ptr) const {
+        DG_PTSET_DISPATCH(*this, return S.count(ptr))
+    }
+
+    bool has(const Pointer &ptr) const { return count(ptr) > 0; }
+
+    bool hasUnknown() const {
+        DG_PTSET_DISPATCH(*this, return S.hasUnknown())
+    }
+
+    bool hasNull() const { DG_PTSET_DISPATCH(*this, return S.hasNull()) }
+
+    bool hasNullWithOffset() const {
+        DG_PTSET_DISPATCH(*this, return S.hasNullWithOffset())
+    }
+
+    bool hasInvalidated() const {
+        DG_PTSET_DISPATCH(*this, return S.hasInvalidated())
+    }
+
+    size_t size() const { DG_PTSET_DISPATCH(*this, return S.size()) }
+
+    void swap(SelectablePointsToSet &rhs) {
+        if (_kind == rhs._kind) {
+            DG_PTSET_DISPATCH2(*this, rhs, return S.swap(R))
+        }
+
+        SelectablePointsToSet tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    class const_iterator {
+        // The iterator of other representation than the pointer-ID one.
+        // It is allocated on the heap and used only by the methods that are
+        // not inlined, so that the address of const_iterator does not escape
+        // and the pointer-ID iterator can be kept in registers in the loops.
+        struct Other {
+            PointsToSetKind _kind;
+
+            union Iterator {
+                CompressedPointsToSet::const_iterator compressed;
+                SharedPointsToSet::const_iterator shared;
+                SimplePointsToSet::const_iterator simple;
+                OffsetsSetPointsToSet::const_iterator offsetsSet;
+                SeparateOffsetsPointsToSet::const_iterator separateOffsets;
+                SmallOffsetsPointsToSet::const_iterator smallOffsets;
+                AlignedSmallOffsetsPointsToSet::const_iterator
+                        alignedSmallOffsets;
+                AlignedPointerIdPointsToSet::const_iterator alignedPointerId;
+
+                Iterator() {}
+                ~Iterator() {}
+            } _it;
+
+            template <typename It>
+            Other(PointsToSetKind kind, const It &it) : _kind(kind) {
+                new (&_it) It(it);
+            }
+
+            Other(const Other &rhs) : _kind(rhs._kind) {
+                DG_PTSET_ITERATOR_DISPATCH2(
+                        *this, rhs, SelectablePointsToSet::_copyInPlace(I, R);
+                        return)
+            }
+
+            ~Other() {
+                DG_PTSET_ITERATOR_DISPATCH(
+                        *this, SelectablePointsToSet::_destroyInPlace(I);
+                        return)
+            }
+
+            Other &operator=(const Other &) = delete;
+        };
+
+        PointsToSetKind _kind;
+
+        union Iterator {
+            PointerIdPointsToSet::const_iterator pointerId;
+            Other *other;
+
+            Iterator() {}
+            ~Iterator() {}
+        } _it;
+
+        const_iterator(PointsToSetKind kind,
+                       const PointerIdPointsToSet::const_iterator &it)
+                : _kind(kind) {
+            assert(kind == PointsToSetKind::pointerId);
+            SelectablePointsToSet::_copyInPlace(_it.pointerId, it);
+        }
+
+        template <typename It>
+        const_iterator(PointsToSetKind kind, const It &it) : _kind(kind) {
+            _it.other = new Other(kind, it);
+        }
+
+        __attribute__((noinline)) static Other *_copyOther(const Other *it) {
+            return new Other(*it);
+        }
+
+        __attribute__((noinline)) static void _destroyOther(Other *it) {
+            delete it;
+        }
+
+        __attribute__((noinline)) static void _incrementOther(Other *it) {
+            DG_PTSET_ITERATOR_DISPATCH(*it, ++I; return)
+        }
+
+        __attribute__((noinline)) static Pointer
+        _dereferenceOther(const Other *it) {
+            DG_PTSET_ITERATOR_DISPATCH(*it, return *I)
+        }
+
+        __attribute__((noinline)) static bool _equalOther(const Other *it,
+                                                          const Other *rhs) {
+            DG_PTSET_ITERATOR_DISPATCH2(*it, *rhs, return I == R)
+        }
+
+        void _copy(const const_iterator &rhs) {
+            _kind = rhs._kind;
+            if (_kind == PointsToSetKind::pointerId)
+                return SelectablePointsToSet::_copyInPlace(_it.pointerId,
+                                                           rhs._it.pointerId);
+            _it.other = _copyOther(rhs._it.other);
+        }
+
+        void _destroy() {
+            if (_kind == PointsToSetKind::pointerId)
+                return SelectablePointsToSet::_destroyInPlace(_it.pointerId);
+            _destroyOther(_it.other);
+        }
+
+      public:
+        const_iterator(const const_iterator &rhs) { _copy(rhs); }
+
+        const_iterator &operator=(const const_iterator &rhs) {
+            if (this != &rhs) {
+                _destroy();
+                _copy(rhs);
+            }
+            return *this;
+        }
+
+        ~const_iterator() { _destroy(); }
+
+        const_iterator &operator++() {
+            if (_kind == PointsToSetKind::pointerId)
+                ++_it.pointerId;
+            else
+                _incrementOther(_it.other);
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const {
+            if (_kind == PointsToSetKind::pointerId)
+                return *_it.pointerId;
+            return _dereferenceOther(_it.other);
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            assert(_kind == rhs._kind && "Iterators of different sets");
+            if (_kind == PointsToSetKind::pointerId)
+                return _it.pointerId == rhs._it.pointerId;
+            return _equalOther(_it.other, rhs._it.other);
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class SelectablePointsToSet;
+    };
+
+    const_iterator begin() const {
+        DG_PTSET_DISPATCH(*this, return const_iterator(_kind, S.begin()))
+    }
+
+    const_iterator end() const {
+        DG_PTSET_DISPATCH(*this, return const_iterator(_kind, S.end()))
+    }
+
+    friend class const_iterator;
+};
+
+#undef DG_PTSET_DISPATCH
+#undef DG_PTSET_DISPATCH2
+#undef DG_PTSET_ITERATOR_DISPATCH
+#undef DG_PTSET_ITERATOR_DISPATCH2
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_SELECTABLE_POINTS_TO_SET_H_
@@ -0,0 +1,437 @@
+#ifndef DG_SHARED_POINTS_TO_SET_H_
+#define DG_SHARED_POINTS_TO_SET_H_
+
+#include "LookupTable.h"
+#include "dg/PointerAnalysis/Pointer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace pta {
+
+class PSNode;
+
+///
+// Points-to set that is represented by a handle (ID) to an interned
+// immutable set of pointers. Equal sets share the same storage and have
+// the same ID, so copying a set and checking the equality is O(1).
+// The results of unions of sets are cached (set-id x set-id -> set-id),
+// so repeated unions of the same sets are O(1) too.
+//
+// Adding a single pointer creates (or finds) a new set, therefore this
+// implementation pays off when the sets are mostly merged together
+// (which is the case in the pointer analysis) and many sets are equal.
+// The interned sets are reference-counted and released when no handle
+// (or iterator) uses them.
+class SharedPointsToSet {
+  public:
+    using SetID = size_t;
+
+  private:
+    using IDTy = PointerIDLookupTable::IDTy;
+    using ElementsT = std::vector<IDTy>;
+
+    struct PairHash {
+        size_t operator()(const std::pair<SetID, SetID> &p) const {
+            return std::hash<SetID>()(p.first) * 31 +
+                   std::hash<SetID>()(p.second);
+        }
+    };
+
+    struct Storage {
+        PointerIDLookupTable pointers;
+        // sorted IDs of pointers, the set with ID 0 is the empty set
+        // (which is not reference-counted)
+        std::vector<ElementsT> sets;
+        std::vector<size_t> refs;
+        // incremented when the set is released, so that we can
+        // recognize stale cached unions
+        std::vector<unsigned> generation;
+        std::vector<SetID> free_ids;
+        // hash of the set -> IDs of the sets with this hash
+        std::unordered_multimap<size_t, SetID> ids;
+
+        struct CachedUnion {
+            SetID result;
+            unsigned gen_lhs, gen_rhs, gen_result;
+        };
+        // cached unions, the key is ordered (smaller ID first)
+        std::unordered_map<std::pair<SetID, SetID>, CachedUnion, PairHash>
+                unions;
+
+        size_t live{0};
+
+        Storage() {
+            sets.emplace_back();
+            refs.push_back(0);
+            generation.push_back(0);
+        }
+
+        static size_t hash(const ElementsT &elems) {
+            size_t h = elems.size();
+            for (auto id : elems)
+                h ^= std::hash<IDTy>()(id) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+
+        void ref(SetID id) {
+            if (id != 0)
+                ++refs[id];
+        }
+
+        void unref(SetID id) {
+            if (id == 0)
+                return;
+
+            assert(refs[id] > 0);
+            if (--refs[id] == 0)
+                release(id);
+        }
+
+        void release(SetID id) {
+            auto range = ids.equal_range(hash(sets[id]));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == id) {
+                    ids.erase(it);
+                    break;
+                }
+            }
+
+            ElementsT().swap(sets[id]);
+            ++generation[id];
+            free_ids.push_back(id);
+            --live;
+        }
+
+        // the returned set must be referenced by the caller
+        SetID intern(ElementsT &&elems) {
+            if (elems.empty())
+                return 0;
+
+            auto h = hash(elems);
+            auto range = ids.equal_range(h);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (sets[it->second] == elems)
+                    return it->second;
+            }
+
+            SetID id;
+            if (free_ids.empty()) {
+                id = sets.size();
+                sets.push_back(std::move(elems));
+                refs.push_back(0);
+                generation.push_back(0);
+            } else {
+                id = free_ids.back();
+                free_ids.pop_back();
+                sets[id] = std::move(elems);
+            }
+
+            ids.emplace(h, id);
+            ++live;
+            return id;
+        }
+
+        bool isValid(const CachedUnion &u, SetID lhs, SetID rhs) const {
+            return generation[lhs] == u.gen_lhs &&
+                   generation[rhs] == u.gen_rhs &&
+                   generation[u.result] == u.gen_result;
+        }
+
+        // remove the cached unions of released sets
+        void purgeUnions() {
+            for (auto it = unions.begin(); it != unions.end();) {
+                if (isValid(it->second, it->first.first, it->first.second))
+                    ++it;
+                else
+                    it = unions.erase(it);
+            }
+        }
+
+        SetID unite(SetID a, SetID b) {
+            if (a > b)
+                std::swap(a, b);
+
+            auto it = unions.find({a, b});
+            if (it != unions.end() && isValid(it->second, a, b))
+                return it->second.result;
+
+            const auto &A = sets[a];
+            const auto &B = sets[b];
+            ElementsT result;
+            result.reserve(A.size() + B.size());
+            std::set_union(A.begin(), A.end(), B.begin(), B.end(),
+                           std::back_inserter(result));
+
+            auto id = intern(std::move(result));
+            if (unions.size() > 2 * live + 1024)
+                purgeUnions();
+            unions[{a, b}] = {id, generation[a], generation[b],
+                              generation[id]};
+            return id;
+        }
+    };
+
+    // defined in PointsToSet.cpp
+    static Storage &storage();
+
+    SetID _id{0};
+
+    void setID(SetID id) {
+        storage().ref(id);
+        storage().unref(_id);
+        _id = id;
+    }
+
+    const ElementsT &elements() const { return storage().sets[_id]; }
+
+    static IDTy getPointerID(const Pointer &ptr) {
+        return storage().pointers.getOrCreate(ptr);
+    }
+
+    static const Pointer &getPointer(IDTy id) {
+        return storage().pointers.get(id);
+    }
+
+    bool hasID(IDTy id) const {
+        const auto &elems = elements();
+        return std::binary_search(elems.begin(), elems.end(), id);
+    }
+
+    // keep only the pointers for which pred(ptr) returns false
+    template <typename Pred>
+    bool removeIf(Pred pred) {
+        ElementsT tmp;
+        tmp.reserve(size());
+        for (auto id : elements()) {
+            if (!pred(getPointer(id)))
+                tmp.push_back(id);
+        }
+
+        if (tmp.size() == size())
+            return false;
+
+        setID(storage().intern(std::move(tmp)));
+        return true;
+    }
+
+    bool insertID(IDTy id) {
+        const auto &elems = elements();
+        auto it = std::lower_bound(elems.begin(), elems.end(), id);
+        if (it != elems.end() && *it == id)
+            return false;
+
+        ElementsT tmp;
+        tmp.reserve(elems.size() + 1);
+        tmp.insert(tmp.end(), elems.begin(), it);
+        tmp.push_back(id);
+        tmp.insert(tmp.end(), it, elems.end());
+        setID(storage().intern(std::move(tmp)));
+        return true;
+    }
+
+    bool addWithUnknownOffset(PSNode *target) {
+        auto ptrid = getPointerID({target, Offset::UNKNOWN});
+        if (hasID(ptrid))
+            return false;
+
+        removeAny(target);
+        return insertID(ptrid);
+    }
+
+  public:
+    SharedPointsToSet() = default;
+    explicit SharedPointsToSet(const std::initializer_list<Pointer> &elems) {
+        add(elems);
+    }
+
+    SharedPointsToSet(const SharedPointsToSet &rhs) : _id(rhs._id) {
+        storage().ref(_id);
+    }
+
+    SharedPointsToSet(SharedPointsToSet &&rhs) : _id(rhs._id) { rhs._id = 0; }
+
+    SharedPointsToSet &operator=(const SharedPointsToSet &rhs) {
+        setID(rhs._id);
+        return *this;
+    }
+
+    SharedPointsToSet &operator=(SharedPointsToSet &&rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    ~SharedPointsToSet() { storage().unref(_id); }
+
+    bool add(PSNode *target, Offset off) { return add(Pointer(target, off)); }
+
+    bool add(const Pointer &ptr) {
+        if (has({ptr.target, Offset::UNKNOWN})) {
+            return false;
+        }
+        if (ptr.offset.isUnknown()) {
+            return addWithUnknownOffset(ptr.target);
+        }
+        return insertID(getPointerID(ptr));
+    }
+
+    template <typename ContainerTy>
+    bool add(const ContainerTy &C) {
+        bool changed = false;
+        for (const auto &ptr : C)
+            changed |= add(ptr);
+        return changed;
+    }
+
+    bool add(const SharedPointsToSet &S) {
+        if (S._id == _id || S.empty())
+            return false;
+
+        auto id = empty() ? S._id : storage().unite(_id, S._id);
+        if (id == _id)
+            return false;
+
+        setID(id);
+        return true;
+    }
+
+    bool remove(const Pointer &ptr) {
+        auto id = storage().pointers.get(ptr);
+        if (id == 0 || !hasID(id))
+            return false;
+
+        return removeIf([&ptr](const Pointer &p) { return p == ptr; });
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    bool removeAny(PSNode *target) {
+        return removeIf(
+                [target](const Pointer &p) { return p.target == target; });
+    }
+
+    void clear() { setID(0); }
+
+    bool pointsTo(const Pointer &ptr) const {
+        auto id = storage().pointers.get(ptr);
+        return id != 0 && hasID(id);
+    }
+
+    bool mayPointTo(const Pointer &ptr) const {
+        return pointsTo(ptr) || pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer &ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        for (auto id : elements()) {
+            if (getPointer(id).target == target)
+                return true;
+        }
+        return false;
+    }
+
+    bool isSingleton() const { return size() == 1; }
+
+    bool empty() const { return _id == 0; }
+
+    size_t count(const Pointer &ptr) const { return pointsTo(ptr); }
+
+    bool has(const Pointer &ptr) const { return count(ptr) > 0; }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+
+    bool hasNullWithOffset() const {
+        for (auto id : elements()) {
+            const auto &ptr = getPointer(id);
+            if (ptr.target == NULLPTR && *ptr.offset != 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const { return elements().size(); }
+
+    void swap(SharedPointsToSet &rhs) { std::swap(_id, rhs._id); }
+
+    // equal sets have the same ID
+    SetID getSetID() const { return _id; }
+
+    // statistics of the shared storage
+    static size_t getNumOfSets() { return storage().live; }
+    static size_t getNumOfCachedUnions() { return storage().unions.size(); }
+
+    // The iterator keeps a reference to the iterated set, so it stays
+    // valid even when the handle that created it is changed.
+    class const_iterator {
+        SetID set_id;
+        size_t pos;
+
+        const_iterator(SetID id, size_t p) : set_id(id), pos(p) {
+            storage().ref(set_id);
+        }
+
+      public:
+        const_iterator(const const_iterator &rhs)
+                : const_iterator(rhs.set_id, rhs.pos) {}
+
+        const_iterator &operator=(const const_iterator &rhs) {
+            storage().ref(rhs.set_id);
+            storage().unref(set_id);
+            set_id = rhs.set_id;
+            pos = rhs.pos;
+            return *this;
+        }
+
+        ~const_iterator() { storage().unref(set_id); }
+
+        const_iterator &operator++() {
+            ++pos;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const {
+            return getPointer(storage().sets[set_id][pos]);
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            return set_id == rhs.set_id && pos == rhs.pos;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class SharedPointsToSet;
+    };
+
+    const_iterator begin() const { return const_iterator(_id, 0); }
+    const_iterator end() const { return const_iterator(_id, size()); }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif
@@ -125,12 +125,21 @@ class SimplePointsToSet {
 
     bool isSingleton() const { return pointers.size() == 1; }
 
-    size_t count(const Pointer &ptr) { return pointers.count(ptr); }
+    size_t count(const Pointer &ptr) const { return pointers.count(ptr); }
     size_t size() const { return pointers.size(); }
     bool empty() const { return pointers.empty(); }
-    bool has(const Pointer &ptr) { return count(ptr) > 0; }
+    bool has(const Pointer &ptr) const { return count(ptr) > 0; }
     bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
     bool hasNull() const { return pointsToTarget(NULLPTR); }
+
+    bool hasNullWithOffset() const {
+        for (const auto &ptr : *this) {
+            if (ptr.target == NULLPTR && *ptr.offset != 0)
+                return true;
+        }
+        return false;
+    }
+
     bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
 
     void swap(SimplePointsToSet &rhs) { pointers.swap(rhs.pointers); }
@@ -86,6 +86,21 @@ class ReadWriteGraph {
         return *_nodes.back().get();
     }
 
+    // Create a node that is not in the graph yet. Unlike create(),
+    // this may be called concurrently. The node gets its ID when
+    // it is added to the graph by adopt().
+    static std::unique_ptr<RWNode> createDetached(RWNodeType t) {
+        assert(t != RWNodeType::CALL && "Detached calls are not supported");
+        return std::unique_ptr<RWNode>(new RWNode(0, t));
+    }
+
+    RWNode &adopt(std::unique_ptr<RWNode> node) {
+        assert(node->getID() == 0 && "The node is already in a graph");
+        node->setID(++lastNodeID);
+        _nodes.push_back(std::move(node));
+        return *_nodes.back().get();
+    }
+
     RWSubgraph &createSubgraph() {
         _subgraphs.emplace_back(new RWSubgraph());
         return *_subgraphs.back().get();
@@ -2,6 +2,7 @@
 #define DG_SCC_H_
 
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "dg/ADT/Queue.h"
@@ -9,17 +10,27 @@
 
 namespace dg {
 
+// the default edges for SCC: the successors of the node
+template <typename NodeT>
+struct SCCSuccessorEdges {
+    auto operator()(NodeT *n) const -> decltype(n->successors()) {
+        return n->successors();
+    }
+};
+
 // implementation of tarjan's algorithm for
 // computing strongly connected components
 // for a directed graph that has a starting vertex
-// from which are all other vertices reachable
-template <typename NodeT>
+// from which are all other vertices reachable.
+// The edges of the graph are given by EdgesT
+// (a functor that returns the successors of a node).
+template <typename NodeT, typename EdgesT = SCCSuccessorEdges<NodeT>>
 class SCC {
   public:
     using SCC_component_t = std::vector<NodeT *>;
     using SCC_t = std::vector<SCC_component_t>;
 
-    SCC<NodeT>() {}
+    SCC(EdgesT edges = EdgesT()) : _edges(std::move(edges)) {}
 
     // returns a vector of vectors - every inner vector
     // contains the nodes contained in one SCC
@@ -32,6 +43,14 @@ class SCC {
 
     const SCC_t &getSCC() const { return scc; }
 
+    // was the node visited by some previous call of compute()?
+    // (compute() can be called repeatedly to cover also the nodes
+    // that are not reachable from a single starting vertex)
+    bool visited(NodeT *n) const {
+        auto it = _info.find(n);
+        return it != _info.end() && it->second.dfs_id != 0;
+    }
+
     SCC_component_t &operator[](unsigned idx) {
         assert(idx < scc.size());
         return scc[idx];
@@ -44,6 +63,7 @@ class SCC {
         bool on_stack{false};
     };
 
+    EdgesT _edges;
     ADT::QueueLIFO<NodeT *> stack;
     CachingHashMap<NodeT *, NodeInfo> _info;
     unsigned index{0};
@@ -60,7 +80,7 @@ class SCC {
         info.on_stack = true;
         stack.push(n);
 
-        for (auto *succ : n->successors()) {
+        for (auto *succ : _edges(n)) {
             auto &succ_info = _info[succ];
             if (succ_info.dfs_id == 0) {
                 assert(!succ_info.on_stack);
@@ -60,6 +60,9 @@ class SubgraphNode {
     // size of the memory
     size_t size{0};
 
+    // for graphs that take over nodes created by another graph
+    void setID(IDType i) { id = i; }
+
   public:
     SubgraphNode(IDType id) : id(id) {}
 #ifndef NDEBUG
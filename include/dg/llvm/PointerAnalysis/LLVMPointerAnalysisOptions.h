@@ -4,17 +4,42 @@
 #include "dg/PointerAnalysis/PointerAnalysisOptions.h"
 #include "dg/llvm/LLVMAnalysisOptions.h"
 
+#include <string>
+
 namespace dg {
 
 struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions,
                                     PointerAnalysisOptions {
-    enum class AnalysisType { fi, fs, inv, svf } analysisType{AnalysisType::fi};
+    enum class AnalysisType {
+        fi,
+        fs,
+        inv,
+        sfs,
+        svf
+    } analysisType{AnalysisType::fi};
 
     bool threads{false};
 
+    // The number of threads that build the subgraphs of functions
+    // in the pointer graph. The built graph (including the IDs of nodes)
+    // does not depend on the number of threads.
+    // See LLVMPointerGraphBuilder::buildFunctionsInParallel.
+    unsigned buildThreads{1};
+
+    // Merge the nodes of the pointer graph that must have the same
+    // points-to sets before running the analysis (flow-insensitive only).
+    // See PSVariableSubstitution.
+    bool substituteVariables{false};
+
+    // Directory where the results of the analysis are cached
+    // between runs on the same module (no caching if empty).
+    // See LLVMPointerAnalysisCache.
+    std::string cacheDir;
+
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
     bool isFI() const { return analysisType == AnalysisType::fi; }
+    bool isSFS() const { return analysisType == AnalysisType::sfs; }
     bool isSVF() const { return analysisType == AnalysisType::svf; }
 };
 
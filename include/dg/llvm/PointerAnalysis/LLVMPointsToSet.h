@@ -6,6 +6,8 @@ SILENCE_LLVM_WARNINGS_PUSH
 #include <llvm/IR/Value.h>
 SILENCE_LLVM_WARNINGS_POP
 
+#include <utility>
+
 #include "dg/PointerAnalysis/PointsToSet.h"
 
 namespace dg {
@@ -464,6 +466,114 @@ class DGLLVMPointsToSet
     }
 };
 
+///
+// Non-owning view of a points-to set computed by DG's pointer analysis.
+// It has the same interface as LLVMPointsToSet, but creating it does not
+// allocate and iterating over it does not go through virtual calls,
+// so it is cheap to get it repeatedly. The view refers to the points-to
+// set in the pointer graph, so it must not be used after the set changes
+// (e.g., by another query in the demand-driven mode) or after
+// the analysis is destroyed.
+class LLVMPointsToView {
+    using SetIteratorT =
+            decltype(std::declval<const PointsToSetT &>().begin());
+
+    const PointsToSetT *_set{nullptr};
+
+  public:
+    class const_iterator {
+        SetIteratorT it;
+        SetIteratorT end;
+
+        // skip the pointers that do not correspond to any llvm::Value
+        void _findNextReal() {
+            while (it != end && (!(*it).isValid() || (*it).isInvalidated()))
+                ++it;
+        }
+
+        const_iterator(SetIteratorT b, SetIteratorT e) : it(b), end(e) {
+            _findNextReal();
+        }
+
+      public:
+        const_iterator &operator++() {
+            ++it;
+            _findNextReal();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        LLVMPointer operator*() const {
+            assert(it != end && "Dereferenced end() iterator");
+            return LLVMPointer{(*it).target->getUserData<llvm::Value>(),
+                               (*it).offset};
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            return it == rhs.it;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class LLVMPointsToView;
+    };
+
+    // an empty view, e.g., for buffers of batched queries
+    LLVMPointsToView() = default;
+    explicit LLVMPointsToView(const PointsToSetT &S) : _set(&S) {}
+
+    const PointsToSetT &getPointsToSet() const {
+        assert(_set && "The view does not refer to any set");
+        return *_set;
+    }
+
+    ///
+    // NOTE: this may not be O(1) operation
+    bool hasUnknown() const { return getPointsToSet().hasUnknown(); }
+    bool hasNull() const { return getPointsToSet().hasNull(); }
+    bool hasNullWithOffset() const {
+        return getPointsToSet().hasNullWithOffset();
+    }
+    bool hasInvalidated() const { return getPointsToSet().hasInvalidated(); }
+    bool empty() const { return getPointsToSet().empty(); }
+    size_t size() const { return getPointsToSet().size(); }
+
+    bool isSingleton() const { return size() == 1; }
+    bool isKnownSingleton() const {
+        return isSingleton() && !hasUnknown() && !hasNull() &&
+               !hasInvalidated();
+    }
+
+    // matches {unknown}
+    bool isUnknownSingleton() const { return isSingleton() && hasUnknown(); }
+
+    LLVMPointer getKnownSingleton() const {
+        assert(isKnownSingleton());
+        const auto &ptr = *getPointsToSet().begin();
+        return LLVMPointer(ptr.target->getUserData<llvm::Value>(), ptr.offset);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(getPointsToSet().begin(),
+                              getPointsToSet().end());
+    }
+    const_iterator end() const {
+        return const_iterator(getPointsToSet().end(), getPointsToSet().end());
+    }
+
+    // create the owning (and allocating) LLVMPointsToSet
+    LLVMPointsToSet toLLVMPointsToSet() const {
+        return (new DGLLVMPointsToSet(getPointsToSet()))->toLLVMPointsToSet();
+    }
+};
+
 } // namespace dg
 
 #endif // _LLVM_DG_POINTS_TO_SET_H_
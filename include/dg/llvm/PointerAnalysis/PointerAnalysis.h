@@ -13,11 +13,13 @@ SILENCE_LLVM_WARNINGS_POP
 #include "dg/PointerAnalysis/PointerAnalysisFI.h"
 #include "dg/PointerAnalysis/PointerAnalysisFS.h"
 #include "dg/PointerAnalysis/PointerAnalysisFSInv.h"
+#include "dg/PointerAnalysis/PointerAnalysisSFS.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
 #include "dg/PointerAnalysis/PointerGraphOptimizations.h"
 
 #include "dg/llvm/PointerAnalysis/LLVMPointerAnalysisOptions.h"
 #include "dg/llvm/PointerAnalysis/LLVMPointsToSet.h"
+#include "dg/llvm/PointerAnalysis/PointerAnalysisCache.h"
 #include "dg/llvm/PointerAnalysis/PointerGraph.h"
 
 namespace dg {
@@ -192,6 +194,41 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
         return _unknownPTSet;
     }
 
+    // in the demand-driven mode, the points-to set
+    // of the node is computed when it is asked for
+    PSNode *solvePointsToNode(const llvm::Value *val) {
+        PSNode *node = getPointsToNode(val);
+        if (node && PTA && options.demandDriven && options.isFI())
+            static_cast<pta::PointerAnalysisFI *>(PTA.get())->query(node);
+        return node;
+    }
+
+    std::vector<PSNode *> solvePointsToNodes(const llvm::Value *const *vals,
+                                             size_t num) {
+        std::vector<PSNode *> nodes;
+        nodes.reserve(num);
+        for (size_t i = 0; i < num; ++i)
+            nodes.push_back(getPointsToNode(vals[i]));
+
+        if (PTA && options.demandDriven && options.isFI()) {
+            std::vector<PSNode *> queried;
+            queried.reserve(num);
+            for (PSNode *node : nodes) {
+                if (node)
+                    queried.push_back(node);
+            }
+            static_cast<pta::PointerAnalysisFI *>(PTA.get())->query(queried);
+        }
+        return nodes;
+    }
+
+    // the node without points-to set has the unknown points-to set
+    std::pair<bool, LLVMPointsToView> getView(const PSNode *node) const {
+        if (node && !node->pointsTo.empty())
+            return {true, LLVMPointsToView(node->pointsTo)};
+        return {false, LLVMPointsToView(getUnknownPTSet())};
+    }
+
   public:
     DGLLVMPointerAnalysis(const llvm::Module *m,
                           const char *entry_func = "main",
@@ -216,10 +253,22 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
     pta::PointerAnalysis *getPTA() { return PTA.get(); }
     const pta::PointerAnalysis *getPTA() const { return PTA.get(); }
 
+    ///
+    // Dump the profile of the analysis as JSON (the analysis must be run
+    // with the 'profile' option, otherwise false is returned).
+    // The 'top' hottest nodes are described by their LLVM values.
+    bool dumpProfile(std::ostream &os, unsigned top = 20) const;
+
+    ///
+    // The analysis ran out of the time or memory budget
+    // (see PointerAnalysisOptions::timeLimit) and its results
+    // are over-approximated.
+    bool exceededBudget() const { return PTA && PTA->exceededBudget(); }
+
     bool threads() const { return _builder->threads(); }
 
     bool hasPointsTo(const llvm::Value *val) override {
-        if (auto node = getPointsToNode(val)) {
+        if (auto node = solvePointsToNode(val)) {
             return !node->pointsTo.empty();
         }
         return false;
@@ -233,17 +282,7 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
     // and hasNull() that reflect whether the points-to set of the
     // LLVM value contains unknown element of null.
     LLVMPointsToSet getLLVMPointsTo(const llvm::Value *val) override {
-        DGLLVMPointsToSet *pts;
-        if (auto node = getPointsToNode(val)) {
-            if (node->pointsTo.empty()) {
-                pts = new DGLLVMPointsToSet(getUnknownPTSet());
-            } else {
-                pts = new DGLLVMPointsToSet(node->pointsTo);
-            }
-        } else {
-            pts = new DGLLVMPointsToSet(getUnknownPTSet());
-        }
-        return pts->toLLVMPointsToSet();
+        return getLLVMPointsToView(val).toLLVMPointsToSet();
     }
 
     ///
@@ -253,19 +292,44 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
     // unknown element when the node does not exists)
     std::pair<bool, LLVMPointsToSet>
     getLLVMPointsToChecked(const llvm::Value *val) override {
-        DGLLVMPointsToSet *pts;
-        if (auto node = getPointsToNode(val)) {
-            if (node->pointsTo.empty()) {
-                pts = new DGLLVMPointsToSet(getUnknownPTSet());
-                return {false, pts->toLLVMPointsToSet()};
-            } else {
-                pts = new DGLLVMPointsToSet(node->pointsTo);
-                return {true, pts->toLLVMPointsToSet()};
-            }
-        } else {
-            pts = new DGLLVMPointsToSet(getUnknownPTSet());
-            return {false, pts->toLLVMPointsToSet()};
-        }
+        auto view = getLLVMPointsToViewChecked(val);
+        return {view.first, view.second.toLLVMPointsToSet()};
+    }
+
+    ///
+    // The same as getLLVMPointsTo, but the returned view does not
+    // allocate anything. The view refers to the points-to set
+    // of the node, see LLVMPointsToView for how long it is valid.
+    LLVMPointsToView getLLVMPointsToView(const llvm::Value *val) {
+        return getLLVMPointsToViewChecked(val).second;
+    }
+
+    // The same as getLLVMPointsToChecked, but returns the view
+    std::pair<bool, LLVMPointsToView>
+    getLLVMPointsToViewChecked(const llvm::Value *val) {
+        return getView(solvePointsToNode(val));
+    }
+
+    ///
+    // Get the points-to sets of 'num' values from 'vals' at once
+    // and store them to 'out' (that must have space for 'num' views).
+    // In the demand-driven mode, the points-to sets of all the values
+    // are computed by a single run of the solver.
+    void getLLVMPointsToViews(const llvm::Value *const *vals, size_t num,
+                              LLVMPointsToView *out) {
+        auto nodes = solvePointsToNodes(vals, num);
+        for (size_t i = 0; i < num; ++i)
+            out[i] = getView(nodes[i]).second;
+    }
+
+    // The same as getLLVMPointsToViews, but stores also the information
+    // whether the node of pointer analysis exists (see getLLVMPointsToChecked)
+    void getLLVMPointsToViewsChecked(const llvm::Value *const *vals,
+                                     size_t num,
+                                     std::pair<bool, LLVMPointsToView> *out) {
+        auto nodes = solvePointsToNodes(vals, num);
+        for (size_t i = 0; i < num; ++i)
+            out[i] = getView(nodes[i]);
     }
 
     const std::vector<std::unique_ptr<PSNode>> &getNodes() {
@@ -292,16 +356,13 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
             abort();
         }
 
-        /*
-        pta::PointerGraphOptimizer optimizer(PS);
-        optimizer.run();
+        if (options.isFI() && options.substituteVariables) {
+            pta::PointerGraphOptimizer optimizer(PS);
+            optimizer.substituteVariables();
 
-        if (optimizer.getNumOfRemovedNodes() > 0)
-            _builder->composeMapping(std::move(optimizer.getMapping()));
-
-        llvm::errs() << "PS optimization removed " <<
-        optimizer.getNumOfRemovedNodes() << " nodes\n";
-        */
+            if (optimizer.getNumOfRemovedNodes() > 0)
+                _builder->composeMapping(std::move(optimizer.getMapping()));
+        }
     }
 
     void initialize() {
@@ -320,6 +381,9 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
         } else if (options.isFSInv()) {
             PTA.reset(new DGLLVMPointerAnalysisImpl<pta::PointerAnalysisFSInv>(
                     PS, _builder.get(), options));
+        } else if (options.isSFS()) {
+            PTA.reset(new DGLLVMPointerAnalysisImpl<pta::PointerAnalysisSFS>(
+                    PS, _builder.get(), options));
         } else {
             assert(0 && "Wrong pointer analysis");
             abort();
@@ -330,7 +394,27 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
         if (!PTA) {
             initialize();
         }
-        return PTA->run();
+
+        if (!pta::LLVMPointerAnalysisCache::canCache(options))
+            return PTA->run();
+
+        pta::LLVMPointerAnalysisCache cache(options.cacheDir,
+                                            _builder->getModule(), options);
+        if (cache.load(PTA.get(), _builder.get()))
+            return true;
+
+        if (!PTA->run())
+            return false;
+
+        // do not cache the over-approximated results
+        if (PTA->exceededBudget())
+            return true;
+
+        if (!cache.store(PTA.get(), _builder.get())) {
+            llvm::errs() << "Failed storing the results of pointer analysis "
+                         << "to " << cache.getPath() << "\n";
+        }
+        return true;
     }
 };
 
@@ -0,0 +1,65 @@
+#ifndef DG_LLVM_POINTER_ANALYSIS_CACHE_H_
+#define DG_LLVM_POINTER_ANALYSIS_CACHE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "dg/llvm/PointerAnalysis/LLVMPointerAnalysisOptions.h"
+
+namespace llvm {
+class Module;
+}
+
+namespace dg {
+namespace pta {
+
+class PointerAnalysis;
+class LLVMPointerGraphBuilder;
+
+///
+// Cache of the results of pointer analysis on the disk.
+// The results are stored in a file whose name is given by the hash
+// of the module and the hash of the options that affect the results.
+// The pointer graph is not stored, it is built from the module again
+// (the building is deterministic). The file contains the calls
+// of functions that were inserted into the graph during the analysis
+// (in the order of insertion, so that the same nodes are created)
+// and the points-to sets of all nodes. The points-to sets are stored
+// by the IDs of nodes in flat arrays of fixed-size records, so the file
+// is mapped into memory and read without any parsing.
+// Only the graph and the points-to sets are restored, not the internal
+// state of the analysis (e.g., the memory maps of flow-sensitive analyses).
+class LLVMPointerAnalysisCache {
+    std::string _path;
+    uint64_t _moduleHash;
+    uint64_t _optionsHash;
+
+  public:
+    LLVMPointerAnalysisCache(const std::string &dir, const llvm::Module *M,
+                             const LLVMPointerAnalysisOptions &opts);
+
+    const std::string &getPath() const { return _path; }
+
+    // the cache cannot replay the changes of the graph done for threads,
+    // the demand-driven analysis does not compute all the results
+    // and the profile needs the analysis to really run
+    static bool canCache(const LLVMPointerAnalysisOptions &opts) {
+        return !opts.cacheDir.empty() && !opts.threads &&
+               !opts.demandDriven && !opts.profile;
+    }
+
+    ///
+    // Load the cached results into the graph of 'PTA' (the graph must be
+    // freshly built by 'builder'). Return false if there are no valid
+    // results in the cache, the graph is not modified in that case.
+    bool load(PointerAnalysis *PTA, const LLVMPointerGraphBuilder *builder);
+
+    ///
+    // Store the results of 'PTA' that was run on the graph built by 'builder'.
+    bool store(PointerAnalysis *PTA, const LLVMPointerGraphBuilder *builder);
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_LLVM_POINTER_ANALYSIS_CACHE_H_
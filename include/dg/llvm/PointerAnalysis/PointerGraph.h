@@ -1,6 +1,7 @@
 #ifndef _LLVM_DG_POINTER_SUBGRAPH_H_
 #define _LLVM_DG_POINTER_SUBGRAPH_H_
 
+#include <memory>
 #include <unordered_map>
 
 #include <dg/util/SilenceLLVMWarnings.h>
@@ -42,6 +43,48 @@ class LLVMPointerGraphBuilder {
 
     bool threads_ = false;
 
+    // The subgraphs of functions may be built in parallel. Every thread
+    // builds functions into its own builder (an arena) that does not touch
+    // anything shared: the nodes from outside of the built function
+    // (globals, constants and special nodes) are replaced by placeholders
+    // and the calls of functions are only recorded. Then the nodes are moved
+    // from the arenas into this graph in the order in which the serial
+    // building creates them, so the graph does not depend on the number
+    // of threads. See buildFunctionsInParallel().
+    struct ArenaEvent {
+        enum class Kind {
+            placeholder, // the node at 'position' stands for 'value'
+                         // or for the special 'node' if 'value' is null
+            mapped,      // nodes were mapped to 'value'
+            call         // 'node' calls 'function' in the call 'value'
+        } kind;
+        // the number of nodes in the arena when the event happened
+        size_t position;
+        const llvm::Value *value;
+        PSNode *node;
+        const llvm::Function *function;
+    };
+
+    struct ArenaFunction {
+        LLVMPointerGraphBuilder *arena{nullptr};
+        // the indices of the nodes of the function in the arena
+        size_t begin{0};
+        size_t end{0};
+        std::vector<ArenaEvent> events;
+    };
+
+    // the builder of the graph if this builder is an arena
+    const LLVMPointerGraphBuilder *_shared{nullptr};
+    // the events of the function that is being built in this arena
+    std::vector<ArenaEvent> *_events{nullptr};
+    // the placeholders created in the function that is being built
+    std::unordered_map<const void *, PSNode *> _placeholders;
+    // arenas have their own data layout, it caches the layouts of types
+    std::unique_ptr<llvm::DataLayout> _dataLayout;
+    // the functions built in arenas while they are moved into this graph
+    std::unordered_map<const llvm::Function *, ArenaFunction> *_arenaFunctions{
+            nullptr};
+
     class PSNodesSeq {
         using NodesT = std::vector<PSNode *>;
         NodesT _nodes;
@@ -75,6 +118,19 @@ class LLVMPointerGraphBuilder {
         void append(PSNode *n) { _nodes.push_back(n); }
         bool empty() const { return _nodes.empty(); }
 
+        // replace the nodes that were removed by optimizations
+        // of the graph with the nodes given by the mapping
+        void replace(const PointsToMapping<PSNode *> &mp) {
+            for (auto &n : _nodes) {
+                if (PSNode *r = mp.get(n))
+                    n = r;
+            }
+            if (_repr) {
+                if (PSNode *r = mp.get(_repr))
+                    _repr = r;
+            }
+        }
+
         PSNode *getFirst() {
             assert(!_nodes.empty());
             return _nodes.front();
@@ -203,14 +259,21 @@ class LLVMPointerGraphBuilder {
     std::vector<PSNodeFork *> forkNodes;
     std::vector<PSNodeJoin *> joinNodes;
 
+    // calls inserted by insertFunctionCall() in the order of insertion
+    // (callsite, called function)
+    std::vector<std::pair<PSNode *, PSNode *>> insertedCalls;
+
   public:
     const PointerGraph *getPS() const { return &PS; }
+    const llvm::Module *getModule() const { return M; }
 
     inline bool threads() const { return threads_; }
 
     LLVMPointerGraphBuilder(const llvm::Module *m,
                             const LLVMPointerAnalysisOptions &opts)
-            : M(m), _options(opts), threads_(opts.threads) {}
+            : M(m), _options(opts), threads_(opts.threads) {
+        PS.setPointsToSetKind(opts.pointsToSet);
+    }
 
     PointerGraph *buildLLVMPointerGraph();
 
@@ -227,6 +290,10 @@ class LLVMPointerGraphBuilder {
     // The call will be inserted betwee the callsite and
     // the return from the call nodes.
     void insertFunctionCall(PSNode *callsite, PSNode *called);
+    const std::vector<std::pair<PSNode *, PSNode *>> &
+    getInsertedFunctionCalls() const {
+        return insertedCalls;
+    }
     void insertPthreadCreateByPtrCall(PSNode *callsite);
     void insertPthreadJoinByPtrCall(PSNode *callsite);
 
@@ -273,6 +340,8 @@ class LLVMPointerGraphBuilder {
     }
 
     void composeMapping(PointsToMapping<PSNode *> &&rhs) {
+        for (auto &it : nodes_map)
+            it.second.replace(rhs);
         mapping.compose(std::move(rhs));
     }
 
@@ -316,6 +385,7 @@ class LLVMPointerGraphBuilder {
         assert(nodes_map.find(val) == nodes_map.end());
         auto it = nodes_map.emplace(val, node);
         node->setUserData(const_cast<llvm::Value *>(val));
+        recordEvent(ArenaEvent::Kind::mapped, val);
 
         return it.first->second;
     }
@@ -324,10 +394,38 @@ class LLVMPointerGraphBuilder {
         assert(nodes_map.find(val) == nodes_map.end());
         seq.getRepresentant()->setUserData(const_cast<llvm::Value *>(val));
         auto it = nodes_map.emplace(val, std::move(seq));
+        recordEvent(ArenaEvent::Kind::mapped, val);
 
         return it.first->second;
     }
 
+    // building in arenas (see buildFunctionsInParallel())
+    explicit LLVMPointerGraphBuilder(const LLVMPointerGraphBuilder *shared);
+
+    void recordEvent(ArenaEvent::Kind kind, const llvm::Value *val,
+                     PSNode *node = nullptr,
+                     const llvm::Function *F = nullptr) {
+        if (_events)
+            _events->push_back({kind, PS.getNodes().size(), val, node, F});
+    }
+
+    bool canBuildInParallel() const;
+    void buildFunctionsInParallel(const llvm::Function *entry);
+    void buildInArena(const llvm::Function &F, ArenaFunction &fun);
+    PointerSubgraph &adoptFunction(const llvm::Function &F);
+    PSNode *getPlaceholder(const llvm::Value *val, PSNode *special);
+    PSNode *getArenaConstant(const llvm::Value *val);
+
+    // the special node (UNKNOWN_MEMORY, NULLPTR) as an operand
+    // of a new node (arenas use placeholders for special nodes)
+    PSNode *special(PSNode *nd) {
+        return _shared ? getPlaceholder(nullptr, nd) : nd;
+    }
+
+    const llvm::DataLayout &getDataLayout() const {
+        return _dataLayout ? *_dataLayout : M->getDataLayout();
+    }
+
     bool isRelevantInstruction(const llvm::Instruction &Inst);
 
     PSNodesSeq &createAlloc(const llvm::Instruction *Inst);
@@ -0,0 +1,123 @@
+#ifndef DG_UTIL_THREAD_POOL_H_
+#define DG_UTIL_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dg {
+
+///
+// A fixed set of threads that process index ranges in parallel.
+// The threads are started once and wait for the next job,
+// so that jobs may be small and frequent (e.g., one per iteration
+// of an analysis). The thread calling parallelFor() works too.
+class ThreadPool {
+    std::vector<std::thread> _workers;
+
+    std::mutex _mtx;
+    std::condition_variable _startCv;
+    std::condition_variable _doneCv;
+
+    // the current job
+    std::function<void(size_t)> _fn;
+    size_t _jobSize{0};
+    size_t _chunk{1};
+    std::atomic<size_t> _next{0};
+    // incremented with every job so that the workers know
+    // that there is something new to do
+    unsigned long _generation{0};
+    unsigned _running{0};
+    bool _stop{false};
+
+    void _work() {
+        size_t i;
+        while ((i = _next.fetch_add(_chunk)) < _jobSize) {
+            auto end = std::min(i + _chunk, _jobSize);
+            for (; i < end; ++i)
+                _fn(i);
+        }
+    }
+
+    void _workerLoop() {
+        unsigned long seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mtx);
+                _startCv.wait(lock,
+                              [&] { return _stop || _generation != seen; });
+                if (_stop)
+                    return;
+                seen = _generation;
+            }
+
+            _work();
+
+            std::lock_guard<std::mutex> lock(_mtx);
+            if (--_running == 0)
+                _doneCv.notify_one();
+        }
+    }
+
+  public:
+    // 'threads' is the total number of threads including the caller
+    explicit ThreadPool(unsigned threads) {
+        for (unsigned i = 1; i < threads; ++i)
+            _workers.emplace_back(&ThreadPool::_workerLoop, this);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _stop = true;
+        }
+        _startCv.notify_all();
+        for (auto &t : _workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return _workers.size() + 1; }
+
+    ///
+    // Call fn(i) for every i in [0, n) and wait until all the calls finish.
+    // The indices are taken by the threads in chunks of 'chunk' indices,
+    // fn must be safe to be called concurrently for different indices.
+    void parallelFor(size_t n, const std::function<void(size_t)> &fn,
+                     size_t chunk = 16) {
+        assert(chunk > 0);
+        if (_workers.empty() || n <= chunk) {
+            for (size_t i = 0; i < n; ++i)
+                fn(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _fn = fn;
+            _jobSize = n;
+            _chunk = chunk;
+            _next = 0;
+            _running = _workers.size();
+            ++_generation;
+        }
+        _startCv.notify_all();
+
+        _work();
+
+        std::unique_lock<std::mutex> lock(_mtx);
+        _doneCv.wait(lock, [&] { return _running == 0; });
+        _fn = nullptr;
+    }
+};
+
+} // namespace dg
+
+#endif // DG_UTIL_THREAD_POOL_H_
@@ -17,6 +17,12 @@ class cow_shared_ptr : public std::shared_ptr<T> {
     cow_shared_ptr(const cow_shared_ptr &rhs)
             : std::shared_ptr<T>(rhs), owner(false) {}
 
+    cow_shared_ptr &operator=(const cow_shared_ptr &rhs) {
+        std::shared_ptr<T>::operator=(rhs);
+        owner = false;
+        return *this;
+    }
+
     void reset(T *p) {
         owner = true;
         std::shared_ptr<T>::reset(p);
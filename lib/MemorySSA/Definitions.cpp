@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "dg/MemorySSA/MemorySSA.h"
 
 #include "dg/util/debug.h"
@@ -63,6 +65,161 @@ void Definitions::join(const Definitions &rhs) {
                         rhs.unknownReads.end());
 }
 
+/// ------------------------------------------------------------------
+// class DefinitionsIndex
+/// ------------------------------------------------------------------
+
+const size_t DefinitionsIndex::minBlockSize;
+const size_t DefinitionsIndex::minInterval;
+
+// the distance between the keys of nodes after (re)numbering
+static const uint64_t keysGap = 1UL << 20;
+
+static size_t definitionsSize(const Definitions &D) {
+    return D.definitions.size() + D.kills.size() + D.unknownWrites.size() +
+           D.unknownReads.size();
+}
+
+void DefinitionsIndex::reset(RWBBlock *block) {
+    _nodes.assign(block->getNodes().begin(), block->getNodes().end());
+    _keys.clear();
+    _keys.reserve(_nodes.size());
+    renumber();
+
+    _scanned = 0;
+    _changes.clear();
+    _checkpoints.clear();
+    _checkpoints.emplace_back(0, Definitions());
+    _last = Definitions();
+}
+
+void DefinitionsIndex::renumber() {
+    KeyT key = keysGap;
+    for (auto *node : _nodes) {
+        _keys[node] = key;
+        key += keysGap;
+    }
+}
+
+// search the nodes up to the position 'upto' for changes
+void DefinitionsIndex::scan(size_t upto) {
+    for (; _scanned < upto; ++_scanned) {
+        RWNode *node = _nodes[_scanned];
+        if (!changesDefinitions(node))
+            continue;
+
+        _changes.push_back(node);
+        _last.update(node);
+
+        auto since = _changes.size() - _checkpoints.back().first;
+        if (since >= std::max(minInterval, definitionsSize(_last)))
+            _checkpoints.emplace_back(_changes.size(), _last);
+    }
+}
+
+// the position of the first node that has at least the key 'key'
+// in the given nodes
+template <typename KeysT>
+static size_t lowerBound(const std::vector<RWNode *> &nodes,
+                         const KeysT &keys, uint64_t key) {
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), key,
+                               [&keys](const RWNode *node, uint64_t k) {
+                                   return keys.find(node)->second < k;
+                               });
+    return it - nodes.begin();
+}
+
+size_t DefinitionsIndex::position(KeyT key) const {
+    return lowerBound(_nodes, _keys, key);
+}
+
+// the number of changes in the nodes with smaller key than 'key'
+size_t DefinitionsIndex::changesBefore(KeyT key) const {
+    return lowerBound(_changes, _keys, key);
+}
+
+// forget all but the first 'changes' changes
+void DefinitionsIndex::truncate(size_t changes) {
+    _changes.resize(changes);
+    while (_checkpoints.back().first > changes)
+        _checkpoints.pop_back();
+
+    _last = _checkpoints.back().second;
+    for (auto i = _checkpoints.back().first; i < changes; ++i)
+        _last.update(_changes[i]);
+}
+
+Definitions DefinitionsIndex::get(RWNode *to) {
+    auto *block = to->getBBlock();
+    auto it = _keys.find(to);
+    if (it == _keys.end() || _nodes.size() != block->size()) {
+        // we were not notified about some change of the block
+        reset(block);
+        it = _keys.find(to);
+    }
+    assert(it != _keys.end() && "The node is not in the block");
+    auto key = it->second;
+
+    auto pos = position(key);
+    assert(_nodes[pos] == to);
+    scan(pos);
+
+    auto changes = changesBefore(key);
+    if (changes == _changes.size())
+        return _last;
+
+    // the last checkpoint with at most 'changes' changes
+    auto cp = std::upper_bound(
+            _checkpoints.begin(), _checkpoints.end(), changes,
+            [](size_t n, const std::pair<size_t, Definitions> &checkpoint) {
+                return n < checkpoint.first;
+            });
+    assert(cp != _checkpoints.begin());
+    --cp;
+
+    Definitions D = cp->second;
+    for (auto i = cp->first; i < changes; ++i)
+        D.update(_changes[i]);
+    return D;
+}
+
+void DefinitionsIndex::inserted(RWNode *node, const RWNode *before) {
+    if (_keys.empty())
+        return; // not built yet
+
+    size_t pos = _nodes.size();
+    if (before) {
+        auto it = _keys.find(before);
+        if (it == _keys.end()) {
+            // we lost track of the block, build the index again on demand
+            _nodes.clear();
+            _keys.clear();
+            return;
+        }
+        pos = position(it->second);
+    }
+
+    KeyT prev = pos > 0 ? _keys[_nodes[pos - 1]] : 0;
+    KeyT next = pos < _nodes.size() ? _keys[_nodes[pos]] : prev + 2 * keysGap;
+    _nodes.insert(_nodes.begin() + pos, node);
+    if (next - prev < 2) {
+        renumber();
+    } else {
+        _keys[node] = prev + (next - prev) / 2;
+    }
+
+    if (pos >= _scanned)
+        return;
+
+    if (changesDefinitions(node)) {
+        // the changes after the node must be found again
+        truncate(changesBefore(_keys[node]));
+        _scanned = pos;
+    } else {
+        ++_scanned;
+    }
+}
+
 #ifndef NDEBUG
 void Definitions::dump() const {
     std::cout << "processed: " << _processed << "\n";
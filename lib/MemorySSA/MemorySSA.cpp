@@ -3,8 +3,10 @@
 
 #include "dg/ADT/Bitvector.h"
 #include "dg/MemorySSA/MemorySSA.h"
+#include "dg/SCC.h"
 //#include "dg/BBlocksBuilder.h"
 
+#include "dg/util/ThreadPool.h"
 #include "dg/util/debug.h"
 
 namespace dg {
@@ -91,10 +93,19 @@ MemorySSATransformation::findDefinitions(RWNode *node, const DefSite &ds) {
     return defs;
 }
 
+thread_local std::vector<std::unique_ptr<RWNode>>
+        *MemorySSATransformation::_detachedPhis = nullptr;
+
 RWNode *MemorySSATransformation::createPhi(const DefSite &ds, RWNodeType type) {
     // This phi is the definition that we are looking for.
-    _phis.emplace_back(&graph.create(type));
-    auto *phi = _phis.back();
+    RWNode *phi;
+    if (_detachedPhis) {
+        _detachedPhis->push_back(ReadWriteGraph::createDetached(type));
+        phi = _detachedPhis->back().get();
+    } else {
+        _phis.emplace_back(&graph.create(type));
+        phi = _phis.back();
+    }
     assert(phi->isPhi() && "Got wrong type");
 
     phi->addOverwrites(ds);
@@ -133,7 +144,9 @@ RWNode *MemorySSATransformation::createAndPlacePhi(RWBBlock *block,
     // create PHI node and find definitions for the PHI node
     auto &D = getBBlockDefinitions(block, &ds);
     auto *phi = createPhi(D, ds);
+    auto *first = block->getFirst();
     block->prepend(phi);
+    getBBlockInfo(block).inserted(phi, first);
     return phi;
 }
 
@@ -367,6 +380,7 @@ void MemorySSATransformation::fillDefinitionsFromCall(Definitions &D,
         // possibly called subgraphs
         auto *phi = createPhi(D, uncoveredds, RWNodeType::CALLOUT);
         C->getBBlock()->append(phi);
+        getBBlockInfo(C->getBBlock()).inserted(phi, nullptr);
         C->addOutput(phi);
 
         // recursively find definitions for this phi node
@@ -396,6 +410,7 @@ void MemorySSATransformation::findDefinitionsFromCalledFun(RWNode *phi,
         // create input PHI for this call
         auto *callphi = createPhi(ds, RWNodeType::CALLIN);
         bblock->insertBefore(callphi, C);
+        getBBlockInfo(bblock).inserted(callphi, C);
         C->addInput(callphi);
 
         phi->addDefUse(callphi);
@@ -459,6 +474,10 @@ void MemorySSATransformation::performLvn(Definitions &D, RWBBlock *block) {
 Definitions MemorySSATransformation::findDefinitionsInBlock(RWNode *to,
                                                             const RWNode *mem) {
     auto *block = to->getBBlock();
+    if (!mem && block->size() >= DefinitionsIndex::minBlockSize) {
+        return getBBlockInfo(block).getDefinitionsIndex().get(to);
+    }
+
     // perform LVN up to the node
     Definitions D;
     for (RWNode *node : block->getNodes()) {
@@ -495,28 +514,9 @@ MemorySSATransformation::findEscapingDefinitionsInBlock(RWNode *to) {
 ///
 static void joinDefinitions(DefinitionsMap<RWNode> &from,
                             DefinitionsMap<RWNode> &to, bool escaping = false) {
-    for (auto &it : from) {
-        if (escaping && !it.first->canEscape()) {
-            continue;
-        }
-
-        if (!to.definesTarget(it.first)) {
-            // just copy the definitions
-            to.add(it.first, it.second);
-            continue;
-        }
-
-        for (auto &it2 : it.second) {
-            auto &interv = it2.first;
-            auto uncovered = to.undefinedIntervals(
-                    {it.first, interv.start, interv.length()});
-            for (auto &undefInterv : uncovered) {
-                // we still do not have definitions for these bytes, add it
-                to.add({it.first, undefInterv.start, undefInterv.length()},
-                       it2.second);
-            }
-        }
-    }
+    to.addUncovered(from, [escaping](const RWNode *target) {
+        return !escaping || target->canEscape();
+    });
 }
 
 static void joinDefinitions(Definitions &from, Definitions &to,
@@ -717,7 +717,118 @@ MemorySSATransformation::findAllDefinitions(RWNode *from) {
     return std::vector<RWNode *>(values.begin(), values.end());
 }
 
+///
+// Check whether the definitions of the use can be found without leaving
+// its subgraph, that is, without creating phi nodes or summaries in
+// other subgraphs. This holds when the used memory cannot be an input
+// of the subgraph and no call in the subgraph may define it.
+bool MemorySSATransformation::isLocalUse(
+        RWNode *use, std::unordered_map<const RWNode *, bool> &localTargets) {
+    if (use->usesUnknown())
+        return false;
+
+    auto *block = use->getBBlock();
+    auto *subg = block->getSubgraph();
+    auto &si = getSubgraphInfo(subg);
+    if (si.getBBlockInfo(block).isCallBlock())
+        return false;
+
+    for (auto &ds : use->getUses()) {
+        auto it = localTargets.find(ds.target);
+        if (it == localTargets.end()) {
+            bool local = !canBeInput(ds.target, subg);
+            for (auto *b : subg->bblocks()) {
+                if (!local)
+                    break;
+                auto &bi = si.getBBlockInfo(b);
+                if (bi.isCallBlock())
+                    local = !callMayDefineTarget(bi.getCall(), ds.target);
+            }
+            it = localTargets.emplace(ds.target, local).first;
+        }
+        if (!it->second)
+            return false;
+    }
+    return true;
+}
+
+void MemorySSATransformation::computeLocalDefinitions(
+        RWSubgraph *subg, std::vector<RWNode *> &deferred,
+        std::vector<std::unique_ptr<RWNode>> &phis) {
+    _detachedPhis = &phis;
+
+    std::unordered_map<const RWNode *, bool> localTargets;
+    for (auto *b : subg->bblocks()) {
+        for (auto *n : b->getNodes()) {
+            if (!n->isUse() || n->defuse.initialized())
+                continue;
+
+            if (isLocalUse(n, localTargets)) {
+                n->addDefUse(findDefinitions(n));
+                assert(n->defuse.initialized());
+            } else {
+                deferred.push_back(n);
+            }
+        }
+    }
+
+    _detachedPhis = nullptr;
+}
+
+void MemorySSATransformation::computeAllDefinitionsInParallel() {
+    DBG_SECTION_BEGIN(dda, "Computing definitions for all uses in "
+                                   << options.definitionsThreads
+                                   << " threads");
+    std::vector<RWSubgraph *> subgraphs;
+    subgraphs.reserve(graph.size());
+    for (auto *subg : graph.subgraphs()) {
+        subgraphs.push_back(subg);
+        // the threads only read the mod/ref information
+        computeModRef(subg, getSubgraphInfo(subg));
+    }
+
+    std::vector<std::vector<RWNode *>> deferred(subgraphs.size());
+    std::vector<std::vector<std::unique_ptr<RWNode>>> phis(subgraphs.size());
+
+    // every subgraph is processed by one thread,
+    // so the blocks and their definitions are not shared
+    ThreadPool pool(options.definitionsThreads);
+    pool.parallelFor(
+            subgraphs.size(),
+            [&](size_t i) {
+                computeLocalDefinitions(subgraphs[i], deferred[i], phis[i]);
+            },
+            /* chunk = */ 1);
+
+    // give IDs to the new phi nodes in the order of subgraphs,
+    // so that the graph does not depend on the scheduling of threads
+    for (auto &subgphis : phis) {
+        for (auto &phi : subgphis)
+            _phis.push_back(&graph.adopt(std::move(phi)));
+    }
+
+    // the rest may create phi nodes and summaries in other subgraphs
+    size_t deferredNum = 0;
+    for (auto &uses : deferred) {
+        deferredNum += uses.size();
+        for (auto *n : uses) {
+            if (!n->defuse.initialized()) {
+                n->addDefUse(findDefinitions(n));
+                assert(n->defuse.initialized());
+            }
+        }
+    }
+
+    DBG_SECTION_END(dda, "Computing definitions for all uses finished ("
+                                 << deferredNum << " uses deferred)");
+}
+
 void MemorySSATransformation::computeAllDefinitions() {
+    if (options.definitionsThreads > 1) {
+        computeAllDefinitionsInParallel();
+        return;
+    }
+
     DBG_SECTION_BEGIN(dda, "Computing definitions for all uses (requested)");
     for (auto *subg : graph.subgraphs()) {
         for (auto *b : subg->bblocks()) {
@@ -768,61 +879,83 @@ RWNode *MemorySSATransformation::insertUse(RWNode *where, RWNode *mem,
     use.addUse({mem, off, len});
     use.insertBefore(where);
     where->getBBlock()->insertBefore(&use, where);
+    getBBlockInfo(where->getBBlock()).inserted(&use, where);
     // DBG_SECTION_END(dda, "Created MU node " << use->getID());
 
     return &use;
 }
 
-static void recGatherNonPhisDefs(RWNode *phi,
-                                 dg::ADT::SparseBitvectorHashImpl &phis,
-                                 dg::ADT::SparseBitvectorHashImpl &ret,
-                                 bool intraproc = false) {
-    assert(phi->isPhi());
-    // set returns the previous value, so if its 'true',
-    // we already had the phi
-    if (phis.set(phi->getID()))
-        return; // we already visited this phi
+namespace {
+// the def-use edges between phi nodes whose definitions are not known yet
+template <typename ResolvedT>
+struct UnresolvedPhiEdges {
+    const ResolvedT &resolved;
 
-    for (auto n : phi->defuse) {
-        if (!n->isPhi()) {
-            ret.set(n->getID());
-        } else {
-            if (intraproc && n->isInOut()) {
-                ret.set(n->getID());
-            } else {
-                recGatherNonPhisDefs(n, phis, ret, intraproc);
+    std::vector<RWNode *> operator()(RWNode *phi) const {
+        std::vector<RWNode *> succs;
+        for (auto *n : phi->defuse) {
+            if (n->isPhi() && resolved.count(n) == 0)
+                succs.push_back(n);
+        }
+        return succs;
+    }
+};
+} // anonymous namespace
+
+const MemorySSATransformation::NodesSetT &
+MemorySSATransformation::getPhiDefinitions(RWNode *phi) {
+    assert(phi->isPhi());
+    if (_phiDefsPhisNum != _phis.size()) {
+        _phiDefs.clear();
+        _phiDefsPhisNum = _phis.size();
+    }
+
+    auto it = _phiDefs.find(phi);
+    if (it != _phiDefs.end())
+        return *it->second;
+
+    // the components come in reverse topological order,
+    // so the successors of a component are resolved before it
+    using EdgesT = UnresolvedPhiEdges<decltype(_phiDefs)>;
+    SCC<RWNode, EdgesT> scc(EdgesT{_phiDefs});
+    for (auto &component : scc.compute(phi)) {
+        std::shared_ptr<NodesSetT> defs(new NodesSetT());
+        for (auto *member : component) {
+            for (auto *n : member->defuse) {
+                if (!n->isPhi()) {
+                    assert(n->getID() > 0);
+                    defs->set(n->getID());
+                    continue;
+                }
+                // phis from the same component are not resolved yet
+                auto nit = _phiDefs.find(n);
+                if (nit != _phiDefs.end())
+                    defs->set(*nit->second);
             }
         }
+        for (auto *member : component)
+            _phiDefs[member] = defs;
     }
-}
 
-// recursivelu replace all phi values with its non-phi definitions
-template <typename ContT>
-std::vector<RWNode *> gatherNonPhisDefs(ReadWriteGraph *graph,
-                                        const ContT &nodes,
-                                        bool intraproc = false) {
-    dg::ADT::SparseBitvectorHashImpl ret; // use set to get rid of duplicates
-    dg::ADT::SparseBitvectorHashImpl
-            phis; // set of visited phi nodes - to check the fixpoint
+    return *_phiDefs[phi];
+}
 
-    for (auto n : nodes) {
+std::vector<RWNode *>
+MemorySSATransformation::gatherNonPhisDefs(RWNode *use) {
+    NodesSetT ret; // use set to get rid of duplicates
+    for (auto *n : use->defuse) {
         if (!n->isPhi()) {
             assert(n->getID() > 0);
             ret.set(n->getID());
         } else {
-            if (intraproc && n->isInOut()) {
-                assert(n->getID() > 0);
-                ret.set(n->getID());
-            } else {
-                recGatherNonPhisDefs(n, phis, ret, intraproc);
-            }
+            ret.set(getPhiDefinitions(n));
         }
     }
 
     std::vector<RWNode *> retval;
     retval.reserve(ret.size());
     for (auto i : ret) {
-        retval.push_back(graph->getNode(i));
+        retval.push_back(graph.getNode(i));
     }
     return retval;
 }
@@ -833,7 +966,7 @@ std::vector<RWNode *> MemorySSATransformation::getDefinitions(RWNode *use) {
         use->addDefUse(findDefinitions(use));
         assert(use->defuse.initialized());
     }
-    return gatherNonPhisDefs(getGraph(), use->defuse);
+    return gatherNonPhisDefs(use);
 }
 
 // return the reaching definitions of ('mem', 'off', 'len')
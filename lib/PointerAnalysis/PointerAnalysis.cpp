@@ -1,3 +1,7 @@
+#include <algorithm>
+
+#include <sys/resource.h>
+
 #include "dg/PointerAnalysis/PointerAnalysis.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointsToSet.h"
@@ -7,19 +11,6 @@
 namespace dg {
 namespace pta {
 
-// Return true if it makes sense to dereference this pointer.
-// PTA is over-approximation, so this is a filter.
-static inline bool canBeDereferenced(const Pointer &ptr) {
-    if (!ptr.isValid() || ptr.isInvalidated() || ptr.isUnknown())
-        return false;
-
-    // if the pointer points to a function, we can not dereference it
-    if (ptr.target->getType() == PSNodeType::FUNCTION)
-        return false;
-
-    return true;
-}
-
 static bool funHasAddressTaken(PSNode *node) {
     if (node->getType() != PSNodeType::FUNCTION)
         return false;
@@ -35,13 +26,18 @@ static bool funHasAddressTaken(PSNode *node) {
 }
 
 bool PointerAnalysis::processLoad(PSNode *node) {
-    bool changed = false;
     PSNode *operand = node->getOperand(0);
 
     if (operand->pointsTo.empty())
         return error(operand, "Load's operand has no points-to set");
 
-    for (const Pointer &ptr : operand->pointsTo) {
+    return processLoad(node, operand->pointsTo);
+}
+
+bool PointerAnalysis::processLoad(PSNode *node, const PointsToSetT &pointers) {
+    bool changed = false;
+
+    for (const Pointer &ptr : pointers) {
         if (ptr.isUnknown()) {
             // load from unknown pointer yields unknown pointer
             changed |= node->addPointsTo(UnknownPointer);
@@ -97,6 +93,8 @@ bool PointerAnalysis::processLoad(PSNode *node) {
                 continue;
             }
 
+            const PointsToSetT *unknownPts = o->getUnknownPointsTo();
+
             // load from empty points-to set
             // - that is load from unknown memory
             auto it = o->pointsTo.find(ptr.offset);
@@ -108,7 +106,7 @@ bool PointerAnalysis::processLoad(PSNode *node) {
                 // if we don't have a definition even with unknown offset
                 // it is an error
                 // FIXME: don't triplicate the code!
-                else if (!o->pointsTo.count(Offset::UNKNOWN))
+                else if (!unknownPts)
                     changed |= errorEmptyPointsTo(node, target);
             } else {
                 // we have pointers on that memory, so we can
@@ -118,9 +116,8 @@ bool PointerAnalysis::processLoad(PSNode *node) {
 
             // plus always add the pointers at unknown offset,
             // since these can be what we need too
-            it = o->pointsTo.find(Offset::UNKNOWN);
-            if (it != o->pointsTo.end()) {
-                changed |= node->addPointsTo(it->second);
+            if (unknownPts) {
+                changed |= node->addPointsTo(*unknownPts);
             }
         }
     }
@@ -167,8 +164,8 @@ bool PointerAnalysis::processMemcpy(PSNode *node) {
                 return changed;
             }
 
-            changed |= processMemcpy(srcObjects, destObjects, ptr, dptr,
-                                     memcpy->getLength());
+            changed |= processMemcpy(node, srcObjects, destObjects, ptr,
+                                     dptr, memcpy->getLength());
         }
     }
 
@@ -185,7 +182,59 @@ static Pointer unwrapConstants(const Pointer &ptr) {
     return Pointer(target, offset);
 }
 
-bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
+///
+// Gather the pointers from 'src' that are stored in the copied range
+// [srcOffset, srcOffset + len), shifted to 'destOffset' in 'dest'.
+// The entries of 'src' are sorted by offsets, so we find the range
+// by binary search. Shifting keeps the order of offsets and once a shifted
+// offset does not fit into the destination, the following ones do not
+// fit either, so the gathered offsets are sorted too (the pointers that
+// do not fit go to Offset::UNKNOWN, which is the last).
+static void gatherCopied(const MemoryObject *src, const MemoryObject *dest,
+                         Offset srcOffset, Offset destOffset, Offset len,
+                         Offset fieldSensitivity,
+                         std::vector<std::pair<Offset, const PointsToSetT *>>
+                                 &copied) {
+    const auto &srcMap = src->pointsTo;
+    auto rangeEnd = srcMap.knownEnd();
+    if (srcOffset.isUnknown()) {
+        // we copy from unknown offset, so everything may be copied
+        for (auto it = srcMap.begin(); it != rangeEnd; ++it)
+            copied.emplace_back(Offset::UNKNOWN, &it->second);
+    } else {
+        auto it = srcMap.lowerBound(srcOffset);
+        if (!len.isUnknown() && *len < Offset::UNKNOWN - *srcOffset)
+            rangeEnd = srcMap.lowerBound(srcOffset + len);
+
+        for (; it != rangeEnd; ++it) {
+            // check that new offset does not overflow Offset::UNKNOWN
+            if (destOffset.isUnknown() ||
+                Offset::UNKNOWN - *destOffset <= *it->first - *srcOffset) {
+                copied.emplace_back(Offset::UNKNOWN, &it->second);
+                continue;
+            }
+
+            Offset newOff = *it->first - *srcOffset + *destOffset;
+            if (newOff >= dest->node->getSize() || newOff >= fieldSensitivity)
+                copied.emplace_back(Offset::UNKNOWN, &it->second);
+            else
+                copied.emplace_back(newOff, &it->second);
+        }
+    }
+
+    // the pointers on unknown offset may be in the range
+    if (const auto *unknownPts = src->getUnknownPointsTo())
+        copied.emplace_back(Offset::UNKNOWN, unknownPts);
+
+    // drop the empty sets, so that we do not create empty entries
+    copied.erase(std::remove_if(copied.begin(), copied.end(),
+                                [](const std::pair<Offset, const PointsToSetT *>
+                                           &it) { return it.second->empty(); }),
+                 copied.end());
+}
+
+bool PointerAnalysis::processMemcpy(PSNode *node,
+                                    std::vector<MemoryObject *> &srcObjects,
                                     std::vector<MemoryObject *> &destObjects,
                                     const Pointer &sptr, const Pointer &dptr,
                                     Offset len) {
@@ -202,13 +251,17 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
     Offset destOffset = tmp.offset;
     PSNodeAlloc *destAlloc = PSNodeAlloc::get(tmp.target);
     assert(destAlloc && "Destination in memcpy is invalid");
+    // a collapsed object keeps all pointers on Offset::UNKNOWN
+    if (isCollapsedObject(destAlloc))
+        destOffset = Offset::UNKNOWN;
 
     // set to true if the contents of destination memory
     // can contain null
     bool contains_null_somewhere = false;
 
     // if the source is zero initialized, we may copy null pointer
-    if (sourceAlloc->isZeroInitialized()) {
+    bool zeroInitialized = sourceAlloc->isZeroInitialized();
+    if (zeroInitialized) {
         // if we really copy the whole object, just set it zero-initialized
         if ((sourceAlloc->getSize() != Offset::UNKNOWN) &&
             (sourceAlloc->getSize() == destAlloc->getSize()) &&
@@ -223,6 +276,11 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
         }
     }
 
+    std::map<MemcpyPairT, MemcpySeenT> *seen = nullptr;
+    if (hasPersistentMemoryObjects())
+        seen = &memcpy_seen[node];
+
+    std::vector<std::pair<Offset, const PointsToSetT *>> copied;
     for (MemoryObject *destO : destObjects) {
         if (contains_null_somewhere)
             changed |= destO->addPointsTo(Offset::UNKNOWN, NullPointer);
@@ -230,42 +288,39 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
         // copy every pointer from srcObjects that is in
         // the range to destination's objects
         for (MemoryObject *so : srcObjects) {
-            for (auto &src : so->pointsTo) { // src.first is offset,
-                                             // src.second is a PointToSet
-
-                // if the offset is inbound of the copied memory
-                // or we copy from unknown offset, or this pointer
-                // is on unknown offset, copy this pointer
-                if (src.first.isUnknown() || srcOffset.isUnknown() ||
-                    (srcOffset <= src.first &&
-                     (len.isUnknown() || *src.first - *srcOffset < *len))) {
-                    // copy the pointer, but shift it by the offsets
-                    // we are working with
-                    if (!src.first.isUnknown() && !srcOffset.isUnknown() &&
-                        !destOffset.isUnknown()) {
-                        // check that new offset does not overflow
-                        // Offset::UNKNOWN
-                        if (Offset::UNKNOWN - *destOffset <=
-                            *src.first - *srcOffset) {
-                            changed |= destO->addPointsTo(Offset::UNKNOWN,
-                                                          src.second);
-                            continue;
-                        }
-
-                        Offset newOff = *src.first - *srcOffset + *destOffset;
-                        if (newOff >= destO->node->getSize() ||
-                            newOff >= options.fieldSensitivity) {
-                            changed |= destO->addPointsTo(Offset::UNKNOWN,
-                                                          src.second);
-                        } else {
-                            changed |= destO->addPointsTo(newOff, src.second);
-                        }
-                    } else {
-                        changed |=
-                                destO->addPointsTo(Offset::UNKNOWN, src.second);
-                    }
-                }
+            MemcpySeenT *last = nullptr;
+            uint64_t srcVersion = so->version;
+            if (seen) {
+                // copying the same contents of the source into the same
+                // destination again changes nothing. The destination is
+                // compared too, its pointers may have been moved
+                // (e.g., when it was collapsed) since the last copy.
+                // If the source is the destination, the copy changes
+                // the version and we copy again until nothing changes.
+                MemcpySeenT now{srcVersion, destO->version, zeroInitialized};
+                auto it = seen->emplace(
+                        MemcpyPairT(so, destO, srcOffset, destOffset), now);
+                if (!it.second && it.first->second == now)
+                    continue;
+                last = &it.first->second;
+            }
+
+            // adding pointers to destO may move the entries of its map,
+            // so copy from a snapshot when copying inside one object
+            MemoryObject snapshot;
+            if (so == destO) {
+                snapshot.pointsTo = so->pointsTo;
+                snapshot.node = so->node;
+                so = &snapshot;
             }
+
+            copied.clear();
+            gatherCopied(so, destO, srcOffset, destOffset, len,
+                         options.fieldSensitivity, copied);
+            changed |= destO->addPointsTo(copied);
+            if (last)
+                *last = MemcpySeenT{srcVersion, destO->version,
+                                    zeroInitialized};
         }
     }
 
@@ -273,27 +328,176 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
 }
 
 bool PointerAnalysis::processGep(PSNode *node) {
+    PSNodeGep *gep = PSNodeGep::get(node);
+    assert(gep && "Non-GEP given");
+
+    return processGep(node, gep->getSource()->pointsTo);
+}
+
+Pointer PointerAnalysis::getGepPointer(const PSNodeGep *gep,
+                                       const Pointer &ptr) const {
+    Offset::type new_offset;
+    if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
+        // set it like this to avoid overflow when adding
+        new_offset = Offset::UNKNOWN;
+    else
+        new_offset = *ptr.offset + *gep->getOffset();
+
+    // in the case PSNodeType::the memory has size 0, then every pointer
+    // will have unknown offset with the exception that it points
+    // to the begining of the memory - therefore make 0 exception
+    if ((new_offset == 0 || new_offset < ptr.target->getSize()) &&
+        new_offset < *options.fieldSensitivity &&
+        (options.maxObjectOffsets == 0 || trackOffset(ptr.target, new_offset)))
+        return Pointer(ptr.target, new_offset);
+
+    return Pointer(ptr.target, Offset::UNKNOWN);
+}
+
+bool PointerAnalysis::trackOffset(PSNode *target, Offset::type offset) const {
+    // only allocations are collapsed
+    if (target->getType() != PSNodeType::ALLOC)
+        return true;
+    // the pointers to the beginning of collapsed objects are kept
+    // (e.g., the allocation points to the beginning of the object)
+    if (isCollapsedObject(target))
+        return offset == 0;
+
+    std::lock_guard<std::mutex> lock(collapse_mutex);
+    auto id = target->getID();
+    if (object_offsets.size() <= id)
+        object_offsets.resize(id + 1);
+
+    // the object already waits for collapsing
+    auto &offsets = object_offsets[id];
+    if (offsets.size() > options.maxObjectOffsets)
+        return true;
+
+    auto it = std::lower_bound(offsets.begin(), offsets.end(), offset);
+    if (it != offsets.end() && *it == offset)
+        return true;
+
+    offsets.insert(it, offset);
+    if (offsets.size() > options.maxObjectOffsets)
+        pending_collapses.push_back(target);
+    return true;
+}
+
+bool PointerAnalysis::collapseObjects(std::vector<PSNode *> &changedNodes) {
+    std::vector<PSNode *> objects;
+    {
+        std::lock_guard<std::mutex> lock(collapse_mutex);
+        objects.swap(pending_collapses);
+    }
+
+    if (objects.empty())
+        return false;
+
+    // the order of the pending objects depends on the threads
+    std::sort(objects.begin(), objects.end(),
+              [](const PSNode *a, const PSNode *b) {
+                  return a->getID() < b->getID();
+              });
+
+    for (PSNode *obj : objects) {
+        auto id = obj->getID();
+        if (collapsed_flags.size() <= id)
+            collapsed_flags.resize(id + 1, false);
+        collapsed_flags[id] = true;
+        collapsed_objects.push_back(obj);
+        std::vector<Offset::type>().swap(object_offsets[id]);
+    }
+
+    for (const auto &nd : PG->getNodes()) {
+        if (nd && collapsePointers(nd->pointsTo, objects))
+            changedNodes.push_back(nd.get());
+    }
+
+    collapseMemory(objects);
+
+    DBG(pta, "Collapsed " << objects.size() << " objects, "
+                          << collapsed_objects.size() << " in total");
+    return true;
+}
+
+bool PointerAnalysis::collapsePointers(
+        PointsToSetT &pointers, const std::vector<PSNode *> &objects) const {
+    // rebuilding the set is linear in its size anyway,
+    // so look up the objects only if there are fewer of them
+    if (objects.size() < pointers.size()) {
+        bool found = false;
+        for (PSNode *obj : objects) {
+            if (pointers.pointsToTarget(obj)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            return false;
+    }
+
+    bool changed = false;
+    PointsToSetT collapsed;
+    for (const Pointer &ptr : pointers) {
+        if (!ptr.offset.isUnknown() && *ptr.offset != 0 &&
+            isCollapsedObject(ptr.target)) {
+            collapsed.add(Pointer(ptr.target, Offset::UNKNOWN));
+            changed = true;
+        } else {
+            collapsed.add(ptr);
+        }
+    }
+
+    if (changed)
+        pointers.swap(collapsed);
+    return changed;
+}
+
+bool PointerAnalysis::collapseObject(
+        MemoryObject *mo, const std::vector<PSNode *> &objects) const {
+    bool changed = false;
+    if (mo->node && isCollapsedObject(mo->node))
+        changed |= mo->collapseOffsets();
+
+    changed |= mo->rewritePointers([this, &objects](PointsToSetT &pointers) {
+        return collapsePointers(pointers, objects);
+    });
+    return changed;
+}
+
+bool PointerAnalysis::processGep(PSNode *node, const PointsToSetT &pointers) {
     bool changed = false;
 
     PSNodeGep *gep = PSNodeGep::get(node);
     assert(gep && "Non-GEP given");
 
-    for (const Pointer &ptr : gep->getSource()->pointsTo) {
-        Offset::type new_offset;
-        if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
-            // set it like this to avoid overflow when adding
-            new_offset = Offset::UNKNOWN;
-        else
-            new_offset = *ptr.offset + *gep->getOffset();
-
-        // in the case PSNodeType::the memory has size 0, then every pointer
-        // will have unknown offset with the exception that it points
-        // to the begining of the memory - therefore make 0 exception
-        if ((new_offset == 0 || new_offset < ptr.target->getSize()) &&
-            new_offset < *options.fieldSensitivity)
-            changed |= node->addPointsTo(ptr.target, new_offset);
-        else
-            changed |= node->addPointsTo(ptr.target, Offset::UNKNOWN);
+    for (const Pointer &ptr : pointers)
+        changed |= node->addPointsTo(getGepPointer(gep, ptr));
+
+    return changed;
+}
+
+bool PointerAnalysis::processStore(PSNode *node, const PointsToSetT &addresses,
+                                   const PointsToSetT &values) {
+    bool changed = false;
+    std::vector<MemoryObject *> objects;
+
+    for (const Pointer &ptr : addresses) {
+        assert(ptr.target && "Got nullptr as target");
+
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        // a collapsed object keeps all pointers on Offset::UNKNOWN
+        // (the pointers to its beginning still have offset 0)
+        Offset offset =
+                isCollapsedObject(ptr.target) ? Offset::UNKNOWN : ptr.offset;
+
+        objects.clear();
+        getMemoryObjects(node, ptr, objects);
+        for (MemoryObject *o : objects) {
+            changed |= o->addPointsTo(offset, values);
+        }
     }
 
     return changed;
@@ -301,7 +505,6 @@ bool PointerAnalysis::processGep(PSNode *node) {
 
 bool PointerAnalysis::processNode(PSNode *node) {
     bool changed = false;
-    std::vector<MemoryObject *> objects;
 
 #ifdef DEBUG_ENABLED
     size_t prev_size = node->pointsTo.size();
@@ -312,19 +515,8 @@ bool PointerAnalysis::processNode(PSNode *node) {
         changed |= processLoad(node);
         break;
     case PSNodeType::STORE:
-        for (const Pointer &ptr : node->getOperand(1)->pointsTo) {
-            assert(ptr.target && "Got nullptr as target");
-
-            if (!canBeDereferenced(ptr))
-                continue;
-
-            objects.clear();
-            getMemoryObjects(node, ptr, objects);
-            for (MemoryObject *o : objects) {
-                changed |= o->addPointsTo(ptr.offset,
-                                          node->getOperand(0)->pointsTo);
-            }
-        }
+        changed |= processStore(node, node->getOperand(1)->pointsTo,
+                                node->getOperand(0)->pointsTo);
         break;
     case PSNodeType::INVALIDATE_OBJECT:
     case PSNodeType::FREE:
@@ -479,7 +671,7 @@ void PointerAnalysis::sanityCheck() {
 #endif // not NDEBUG
 }
 
-static void setToEmpty(std::vector<PSNode *> &nodes) {
+void PointerAnalysis::setToEmpty(const std::vector<PSNode *> &nodes) {
     for (auto *n : nodes) {
         if (n->getType() != PSNodeType::ALLOC &&
             n->getType() != PSNodeType::CONSTANT) {
@@ -488,14 +680,7 @@ static void setToEmpty(std::vector<PSNode *> &nodes) {
     }
 }
 
-bool PointerAnalysis::run() {
-    DBG_SECTION_BEGIN(pta, "Running pointer analysis");
-
-    preprocess();
-
-    // check that the current state of pointer analysis makes sense
-    sanityCheck();
-
+void PointerAnalysis::processGlobals() {
     // process global nodes, these must reach fixpoint after one iteration
     DBG(pta, "Processing global nodes");
     queue_globals();
@@ -505,6 +690,158 @@ bool PointerAnalysis::run() {
            "Globals did not reach fixpoint");
     to_process.clear();
     changed.clear();
+}
+
+// the peak resident memory of the process in megabytes
+static size_t getPeakMemoryMB() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024 * 1024);
+#else
+    return usage.ru_maxrss / 1024;
+#endif
+}
+
+void PointerAnalysis::startBudget() {
+    if (budget_started)
+        return;
+
+    budget_started = true;
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::milliseconds(options.timeLimit);
+}
+
+bool PointerAnalysis::checkBudget() {
+    if (budget_exceeded || !options.hasBudget())
+        return budget_exceeded;
+
+    if (options.timeLimit > 0 && std::chrono::steady_clock::now() >= deadline) {
+        DBG(pta, "Exceeded the time limit of " << options.timeLimit << " ms");
+        budget_exceeded = true;
+    } else if (options.memoryLimit > 0 &&
+               getPeakMemoryMB() >= options.memoryLimit) {
+        DBG(pta, "Exceeded the memory limit of " << options.memoryLimit
+                                                 << " MB");
+        budget_exceeded = true;
+    }
+
+    return budget_exceeded;
+}
+
+// the points-to sets of these nodes do not depend on other nodes
+static bool hasFixedPointsTo(const PSNode *n) {
+    switch (n->getType()) {
+    case PSNodeType::ALLOC:
+    case PSNodeType::FUNCTION:
+    case PSNodeType::CONSTANT:
+    case PSNodeType::NULL_ADDR:
+    case PSNodeType::UNKNOWN_MEM:
+    case PSNodeType::INVALIDATED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// the node adds edges to the graph once its operands are known
+static bool changesGraph(const PSNode *n) {
+    return n->getType() == PSNodeType::CALL_FUNCPTR ||
+           n->getType() == PSNodeType::FORK || n->getType() == PSNodeType::JOIN;
+}
+
+// the node changes the memory
+static bool writesMemory(const PSNode *n) {
+    switch (n->getType()) {
+    case PSNodeType::STORE:
+    case PSNodeType::MEMCPY:
+    case PSNodeType::FREE:
+    case PSNodeType::INVALIDATE_OBJECT:
+    case PSNodeType::INVALIDATE_LOCALS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+///
+// The pointers flow from operands to users and through the memory.
+// So the nodes that could still change are the pending nodes, their users
+// (transitively), and if some of these nodes writes to memory,
+// also all the loads (and their users). If a call via a function pointer
+// (or a fork or join) could still change, we do not know which parts
+// of the graph it would connect, so all the nodes are over-approximated.
+// The memory maps of flow-sensitive analyses are not over-approximated,
+// only the points-to sets.
+void PointerAnalysis::overApproximate(const std::vector<PSNode *> &pending,
+                                      bool flowSensitive) {
+    DBG_SECTION_BEGIN(pta, "Over-approximating the unfinished points-to sets");
+
+    const auto &nodes = PG->getNodes();
+    std::vector<bool> visited(nodes.size(), false);
+    std::vector<PSNode *> stack;
+    bool loadsAdded = false;
+    // the nodes are pending, so the memory may change
+    bool addLoads = flowSensitive && !pending.empty();
+
+    auto push = [&](PSNode *n) {
+        if (!visited[n->getID()]) {
+            visited[n->getID()] = true;
+            stack.push_back(n);
+        }
+    };
+
+    for (PSNode *n : pending)
+        push(n);
+
+    size_t changed_num = 0;
+    while (!stack.empty()) {
+        PSNode *n = stack.back();
+        stack.pop_back();
+
+        if (changesGraph(n)) {
+            for (const auto &nd : nodes) {
+                if (nd && !hasFixedPointsTo(nd.get()) &&
+                    nd->addPointsTo(UnknownPointer))
+                    ++changed_num;
+            }
+            break;
+        }
+
+        if (!hasFixedPointsTo(n) && n->addPointsTo(UnknownPointer))
+            ++changed_num;
+
+        for (PSNode *user : n->getUsers())
+            push(user);
+
+        if (!loadsAdded && (addLoads || writesMemory(n))) {
+            loadsAdded = true;
+            for (const auto &nd : nodes) {
+                if (nd && nd->getType() == PSNodeType::LOAD)
+                    push(nd.get());
+            }
+        }
+    }
+
+    DBG(pta, "Added the unknown pointer to " << changed_num << " nodes");
+    DBG_SECTION_END(pta, "Over-approximating the unfinished points-to sets done");
+}
+
+bool PointerAnalysis::run() {
+    DBG_SECTION_BEGIN(pta, "Running pointer analysis");
+
+    startBudget();
+
+    // the new points-to sets use the pointer IDs of the graph
+    PointerIDLookupTable::Scope scope(&PG->getPointerIDs());
+
+    preprocess();
+
+    // check that the current state of pointer analysis makes sense
+    sanityCheck();
+
+    processGlobals();
 
     initialize_queue();
 
@@ -528,10 +865,42 @@ bool PointerAnalysis::run() {
             DBG(pta, "Iteration " << n << ", queue size " << to_process.size());
         }
 #endif
+        if (checkBudget()) {
+            overApproximate(to_process, hasFlowSensitiveMemory());
+            to_process.clear();
+            break;
+        }
         ++n;
 
-        iteration();
-        queue_changed();
+        if (profile)
+            profile->startIteration();
+        iteration(/* interruptible = */ true);
+        if (budget_exceeded) {
+            // the iteration was interrupted, all the nodes
+            // that it should have processed are unfinished
+            to_process.insert(to_process.end(), changed.begin(),
+                              changed.end());
+            changed.clear();
+            overApproximate(to_process, hasFlowSensitiveMemory());
+            to_process.clear();
+        } else {
+            // the nodes that pointed to the collapsed objects
+            // must be processed again
+            std::vector<PSNode *> collapsed;
+            if (collapseObjects(collapsed)) {
+                changed.insert(changed.end(), collapsed.begin(),
+                               collapsed.end());
+                std::sort(changed.begin(), changed.end(),
+                          [](const PSNode *a, const PSNode *b) {
+                              return a->getID() < b->getID();
+                          });
+                changed.erase(std::unique(changed.begin(), changed.end()),
+                              changed.end());
+            }
+            queue_changed();
+        }
+        if (profile)
+            profile->endIteration();
     } while (!to_process.empty());
 
     DBG(pta, "Reached fixpoint after " << n << " iterations\n");
@@ -0,0 +1,1113 @@
+#include <algorithm>
+
+#include "dg/PointerAnalysis/PointerAnalysisFI.h"
+#include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSet.h"
+#include "dg/SCC.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace pta {
+
+// processing of these nodes may change the pointer graph
+static inline bool canChangeGraph(const PSNode *n) {
+    return n->getType() == PSNodeType::CALL_FUNCPTR ||
+           n->getType() == PSNodeType::FORK || n->getType() == PSNodeType::JOIN;
+}
+
+void PointerAnalysisFI::resizeWorklistState() {
+    auto size = getPG()->getNodes().size();
+    if (worklist->propagated.size() >= size)
+        return;
+
+    worklist->propagated.resize(size);
+    worklist->reevaluate.resize(size, false);
+    worklist->queued.resize(size, false);
+    worklist->reachable.resize(size, false);
+    worklist->representant.resize(size, nullptr);
+    worklist->inProgram.resize(size, false);
+}
+
+void PointerAnalysisFI::schedule(PSNode *n, bool reevaluate) {
+    n = getRepresentant(n);
+    auto id = n->getID();
+    assert(id < worklist->queued.size());
+
+    if (reevaluate)
+        worklist->reevaluate[id] = true;
+
+    if (!worklist->queued[id]) {
+        worklist->queued[id] = true;
+        worklist->next_queue.push_back(n);
+    }
+}
+
+///
+// Queue all nodes that are reachable from the entry for re-evaluation.
+// The already propagated pointers are kept, so only the new information
+// is propagated further.
+void PointerAnalysisFI::seedWorklist() {
+    if (options.demandDriven) {
+        seedDemand();
+        return;
+    }
+
+    resizeWorklistState();
+
+    auto nodes = getPG()->getNodes(getPG()->getEntry()->getRoot());
+    for (PSNode *n : nodes)
+        worklist->reachable[n->getID()] = true;
+
+    // the graph may have changed, so there may be new cycles
+    if (options.collapseCycles)
+        collapseCycles();
+
+    for (PSNode *n : nodes)
+        schedule(n, /* reevaluate = */ true);
+
+    ++reseeds_num;
+}
+
+// the memory pointed by 'addresses' was changed by 'writer',
+// so re-evaluate all nodes that read this memory
+void PointerAnalysisFI::notifyReaders(PSNode *writer,
+                                      const PointsToSetT &addresses) {
+    std::vector<MemoryObject *> objects;
+    for (const Pointer &ptr : addresses) {
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        objects.clear();
+        getMemoryObjects(writer, ptr, objects);
+        for (MemoryObject *o : objects) {
+            auto it = worklist->readers.find(o);
+            if (it == worklist->readers.end())
+                continue;
+
+            for (PSNode *reader : it->second) {
+                if (worklist->reachable[reader->getID()])
+                    schedule(reader, /* reevaluate = */ true);
+            }
+        }
+    }
+}
+
+// process the node with the whole points-to sets of its operands
+bool PointerAnalysisFI::reevaluateNode(PSNode *n) {
+    bool changed = false;
+    changed |= beforeProcessed(n);
+    changed |= processNode(n);
+    changed |= afterProcessed(n);
+
+    if (!changed)
+        return false;
+
+    if (n->getType() == PSNodeType::STORE) {
+        notifyReaders(n, n->getOperand(1)->pointsTo);
+    } else if (n->getType() == PSNodeType::MEMCPY) {
+        notifyReaders(n, PSNodeMemcpy::get(n)->getDestination()->pointsTo);
+    }
+
+    return true;
+}
+
+///
+// Propagate the pointers 'delta' that were newly added to 'from'
+// to its user 'user' ('from' is a representant, the user may be a user
+// of a node collapsed into it). Nodes whose semantics is not monotone
+// in the operands' points-to sets (or that are not worth
+// the special handling) are just queued for re-evaluation.
+void PointerAnalysisFI::propagate(PSNode *from, PSNode *user,
+                                  const PointsToSetT &delta) {
+    auto id = user->getID();
+    // the user is not reachable (yet), or it was created during
+    // this round of the worklist algorithm
+    if (id >= worklist->reachable.size() || !worklist->reachable[id])
+        return;
+
+    PSNode *rep = getRepresentant(user);
+    if (rep != user) {
+        // the user was collapsed into a cycle of copy nodes,
+        // it just copies the pointers to its representant
+        if (rep->addPointsTo(delta))
+            schedule(rep);
+        return;
+    }
+
+    switch (user->getType()) {
+    case PSNodeType::CALL_RETURN:
+        if (options.invalidateNodes) {
+            schedule(user, /* reevaluate = */ true);
+            break;
+        }
+        // fall-through
+    case PSNodeType::CAST:
+    case PSNodeType::PHI:
+    case PSNodeType::RETURN:
+        if (user->addPointsTo(delta))
+            schedule(user);
+        break;
+    case PSNodeType::GEP:
+        if (processGep(user, delta))
+            schedule(user);
+        break;
+    case PSNodeType::LOAD:
+        if (processLoad(user, delta))
+            schedule(user);
+        break;
+    case PSNodeType::STORE: {
+        PSNode *val = getRepresentant(user->getOperand(0));
+        PSNode *addr = getRepresentant(user->getOperand(1));
+        if (val == from && addr == from) {
+            schedule(user, /* reevaluate = */ true);
+        } else if (addr == from) {
+            if (processStore(user, delta, val->pointsTo))
+                notifyReaders(user, delta);
+        } else {
+            assert(val == from);
+            if (processStore(user, addr->pointsTo, delta))
+                notifyReaders(user, addr->pointsTo);
+        }
+        break;
+    }
+    case PSNodeType::ALLOC:
+    case PSNodeType::FUNCTION:
+    case PSNodeType::CONSTANT:
+    case PSNodeType::NOOP:
+    case PSNodeType::ENTRY:
+    case PSNodeType::CALL:
+    case PSNodeType::FREE:
+    case PSNodeType::INVALIDATE_OBJECT:
+    case PSNodeType::INVALIDATE_LOCALS:
+        // these nodes do not depend on the points-to sets of operands
+        break;
+    default:
+        schedule(user, /* reevaluate = */ true);
+    }
+}
+
+// process the nodes queued in the last iteration, return true
+// if the graph changed. If the budget is exceeded, the nodes that
+// were not processed are left in the queue.
+bool PointerAnalysisFI::processQueue() {
+    bool graphChanged = false;
+    PointsToSetT delta;
+
+    auto &queue = worklist->queue;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        if (shouldCheckBudget() && checkBudget()) {
+            queue.erase(queue.begin(), queue.begin() + i);
+            return graphChanged;
+        }
+
+        PSNode *cur = queue[i];
+        auto id = cur->getID();
+        worklist->queued[id] = false;
+        // the node was collapsed after it had been queued
+        if (getRepresentant(cur) != cur)
+            continue;
+
+        ++processed_nodes_num;
+        PointerAnalysisProfile::NodeScope prof(profile.get(), cur);
+
+        if (worklist->reevaluate[id]) {
+            worklist->reevaluate[id] = false;
+            if (reevaluateNode(cur) && canChangeGraph(cur))
+                graphChanged = true;
+        }
+
+        // gather the pointers that were not propagated yet
+        auto &propagated = worklist->propagated[id];
+        delta.clear();
+        for (const Pointer &ptr : cur->pointsTo) {
+            if (!propagated.has(ptr))
+                delta.add(ptr);
+        }
+
+        if (delta.empty())
+            continue;
+
+        propagated.add(delta);
+
+        for (PSNode *user : cur->getUsers())
+            propagate(cur, user, delta);
+        propagateToMembers(cur, delta);
+    }
+
+    queue.clear();
+    return graphChanged;
+}
+
+///
+// Parallel solver.
+//
+// The nodes queued in the last iteration are first re-evaluated
+// (if needed) sequentially. Then the new pointers of the nodes
+// and the pointers that they add to the users of the nodes
+// are computed in parallel. This phase only reads the graph, the memory
+// objects and the pointer IDs, so the threads need no locking
+// (except for recording the offsets of objects, see trackOffset()).
+// Finally, the updates are committed sequentially in the order
+// of the queue, which also handles the users that cannot be processed
+// in parallel (stores, calls, ...). The order of the updates does not
+// depend on the number of threads, so the solver is deterministic.
+
+bool PointerAnalysisFI::processQueueParallel() {
+    bool graphChanged = false;
+
+    auto &active = worklist->active;
+    active.clear();
+    for (PSNode *cur : worklist->queue) {
+        auto id = cur->getID();
+        worklist->queued[id] = false;
+        // the node was collapsed after it had been queued
+        if (getRepresentant(cur) != cur)
+            continue;
+
+        ++processed_nodes_num;
+        active.push_back(cur);
+    }
+
+    for (PSNode *cur : active) {
+        PointerAnalysisProfile::NodeScope prof(profile.get(), cur);
+        auto id = cur->getID();
+        if (worklist->reevaluate[id]) {
+            worklist->reevaluate[id] = false;
+            if (reevaluateNode(cur) && canChangeGraph(cur))
+                graphChanged = true;
+        }
+    }
+
+    auto &updates = worklist->updates;
+    if (updates.size() < active.size())
+        updates.resize(active.size());
+
+    worklist->pool->parallelFor(active.size(), [&](size_t i) {
+        updates[i].clear();
+        computeUpdate(active[i], updates[i]);
+    });
+
+    for (size_t i = 0; i < active.size(); ++i) {
+        // the node was already counted when it was re-evaluated
+        PointerAnalysisProfile::NodeScope prof(profile.get(), active[i],
+                                               /* count = */ false);
+        commitUpdate(active[i], updates[i]);
+    }
+
+    return graphChanged;
+}
+
+// compute what the new pointers of 'cur' add to its users.
+// Must not modify anything but 'update'.
+void PointerAnalysisFI::computeUpdate(PSNode *cur,
+                                      ParallelUpdate &update) const {
+    const auto &propagated = worklist->propagated[cur->getID()];
+    for (const Pointer &ptr : cur->pointsTo) {
+        if (!propagated.has(ptr))
+            update.delta.push_back(ptr);
+    }
+
+    if (update.delta.empty())
+        return;
+
+    auto &additions = update.additions;
+    auto addUser = [&](PSNode *user) {
+        auto id = user->getID();
+        if (id >= worklist->reachable.size() || !worklist->reachable[id])
+            return;
+
+        // the user was collapsed into a cycle of copy nodes,
+        // it just copies the pointers to its representant
+        PSNode *target = findRepresentant(user);
+        PSNodeType type = target != user ? PSNodeType::CAST : user->getType();
+
+        switch (type) {
+        case PSNodeType::CALL_RETURN:
+            if (options.invalidateNodes) {
+                update.deferred.push_back(user);
+                break;
+            }
+            // fall-through
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+        case PSNodeType::RETURN:
+            for (const Pointer &ptr : update.delta) {
+                if (!target->pointsTo.has(ptr))
+                    additions.emplace_back(target, ptr);
+            }
+            break;
+        case PSNodeType::GEP: {
+            const PSNodeGep *gep = PSNodeGep::get(user);
+            for (const Pointer &ptr : update.delta) {
+                Pointer gepPtr = getGepPointer(gep, ptr);
+                if (!user->pointsTo.has(gepPtr))
+                    additions.emplace_back(user, gepPtr);
+            }
+            break;
+        }
+        case PSNodeType::LOAD: {
+            auto num = additions.size();
+            if (!loadPointers(user, update.delta, additions)) {
+                additions.resize(num);
+                update.deferred.push_back(user);
+            }
+            break;
+        }
+        case PSNodeType::ALLOC:
+        case PSNodeType::FUNCTION:
+        case PSNodeType::CONSTANT:
+        case PSNodeType::NOOP:
+        case PSNodeType::ENTRY:
+        case PSNodeType::CALL:
+        case PSNodeType::FREE:
+        case PSNodeType::INVALIDATE_OBJECT:
+        case PSNodeType::INVALIDATE_LOCALS:
+            // these nodes do not depend on the points-to sets of operands
+            break;
+        default:
+            update.deferred.push_back(user);
+        }
+    };
+
+    for (PSNode *user : cur->getUsers())
+        addUser(user);
+
+    // the nodes collapsed into 'cur' copy its pointers
+    // and pass them to their users (see propagateToMembers())
+    if (const auto *members = getMembers(cur)) {
+        for (PSNode *m : *members) {
+            for (const Pointer &ptr : update.delta) {
+                if (!m->pointsTo.has(ptr))
+                    additions.emplace_back(m, ptr);
+            }
+            for (PSNode *user : m->getUsers())
+                addUser(user);
+        }
+    }
+}
+
+///
+// The pointers that the load 'load' reads via 'pointers' (the same as
+// processLoad, but the pointers are put to 'out'). Return false if the load
+// must be processed sequentially: the memory object was not created yet,
+// the load is not registered as its reader, or the load reads from memory
+// that has no pointers (that is handled by errorEmptyPointsTo).
+bool PointerAnalysisFI::loadPointers(
+        PSNode *load, const std::vector<Pointer> &pointers,
+        std::vector<std::pair<PSNode *, Pointer>> &out) const {
+    for (const Pointer &ptr : pointers) {
+        if (ptr.isUnknown()) {
+            // load from unknown pointer yields unknown pointer
+            out.emplace_back(load, UnknownPointer);
+            continue;
+        }
+
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        PSNodeAlloc *target = PSNodeAlloc::get(ptr.target);
+        assert(target && "Target is not memory allocation");
+
+        PSNode *n = getObjectNode(ptr);
+        const MemoryObject *o = n->getType() == PSNodeType::FUNCTION
+                                        ? nullptr
+                                        : n->getData<MemoryObject>();
+        if (!o)
+            return false;
+
+        auto readers = worklist->readers.find(o);
+        if (readers == worklist->readers.end() ||
+            readers->second.count(load) == 0)
+            return false;
+
+        if (ptr.offset.isUnknown()) {
+            if (o->pointsTo.empty()) {
+                if (!target->isZeroInitialized())
+                    return false;
+                out.emplace_back(load, NullPointer);
+            }
+
+            for (const auto &it : o->pointsTo) {
+                for (const Pointer &loaded : it.second)
+                    out.emplace_back(load, loaded);
+            }
+            continue;
+        }
+
+        const PointsToSetT *unknownPts = o->getUnknownPointsTo();
+        auto it = o->find(ptr.offset);
+        if (it == o->end()) {
+            if (target->isZeroInitialized())
+                out.emplace_back(load, NullPointer);
+            else if (!unknownPts)
+                return false;
+        } else {
+            for (const Pointer &loaded : it->second)
+                out.emplace_back(load, loaded);
+        }
+
+        if (unknownPts) {
+            for (const Pointer &loaded : *unknownPts)
+                out.emplace_back(load, loaded);
+        }
+    }
+
+    return true;
+}
+
+void PointerAnalysisFI::commitUpdate(PSNode *cur, ParallelUpdate &update) {
+    if (update.delta.empty())
+        return;
+
+    PointsToSetT delta;
+    for (const Pointer &ptr : update.delta)
+        delta.add(ptr);
+    worklist->propagated[cur->getID()].add(delta);
+
+    for (const auto &it : update.additions) {
+        // the collapsed nodes are not processed, they got
+        // the pointers of their representant
+        if (it.first->addPointsTo(it.second) &&
+            getRepresentant(it.first) == it.first)
+            schedule(it.first);
+    }
+
+    for (PSNode *user : update.deferred)
+        propagate(cur, user, delta);
+}
+
+void PointerAnalysisFI::initWorklist() {
+    worklist.reset(new WorklistState());
+    // e.g., iterating over the shared sets changes the reference counts
+    // of the interned sets, they cannot be read concurrently
+    if (options.solverThreads > 1 &&
+        !isThreadSafe(getPG()->getPointsToSetKind()))
+        DBG(pta, "The points-to sets do not support more threads");
+    else if (options.solverThreads > 1)
+        worklist->pool.reset(new ThreadPool(options.solverThreads));
+    processed_nodes_num = 0;
+    reseeds_num = 0;
+    collapsed_nodes_num = 0;
+    collapsed_cycles_num = 0;
+    relevant_nodes_num = 0;
+    seeded_functions_num = 0;
+    seeding_components_num = 0;
+    seeding_levels_num = 0;
+    seed_pointers_num = 0;
+
+    preprocess();
+
+    // check that the current state of pointer analysis makes sense
+    sanityCheck();
+
+    processGlobals();
+
+    if (options.maxIterations > 0) {
+        DBG(pta, "The maximal number of iterations is set to "
+                         << options.maxIterations);
+    }
+}
+
+// stop the solver when the budget is exceeded: the nodes
+// that are still queued are over-approximated. If the graph has changed
+// in the last iteration, the new parts of the graph were not processed
+// at all, so all the nodes are over-approximated.
+void PointerAnalysisFI::overApproximateQueued(bool graphChanged) {
+    std::vector<PSNode *> pending;
+    if (graphChanged) {
+        for (const auto &nd : getPG()->getNodes()) {
+            if (nd)
+                pending.push_back(nd.get());
+        }
+    }
+
+    for (auto *q : {&worklist->queue, &worklist->next_queue}) {
+        for (PSNode *cur : *q) {
+            worklist->queued[cur->getID()] = false;
+            worklist->reevaluate[cur->getID()] = false;
+            pending.push_back(getRepresentant(cur));
+        }
+        q->clear();
+    }
+
+    overApproximate(pending);
+}
+
+void PointerAnalysisFI::collapseMemory(const std::vector<PSNode *> &objects) {
+    for (auto &mo : memory_objects)
+        collapseObject(mo.get(), objects);
+
+    for (auto &it : return_seeds) {
+        auto &returns = it.second;
+        for (Pointer &ptr : returns) {
+            if (isCollapsedObject(ptr.target))
+                ptr.offset = Offset::UNKNOWN;
+        }
+        std::sort(returns.begin(), returns.end());
+        returns.erase(std::unique(returns.begin(), returns.end()),
+                      returns.end());
+    }
+}
+
+// collapse the objects that exceeded the limit on offsets
+// and queue the nodes that pointed to them
+void PointerAnalysisFI::collapseQueued() {
+    size_t first = collapsed_objects.size();
+    std::vector<PSNode *> changed;
+    if (!collapseObjects(changed))
+        return;
+
+    auto isReachable = [this](PSNode *n) {
+        auto id = n->getID();
+        return id < worklist->reachable.size() && worklist->reachable[id];
+    };
+
+    // the users get the pointers with unknown offsets
+    for (PSNode *n : changed) {
+        if (isReachable(n))
+            schedule(n);
+    }
+
+    // the pointers in the collapsed objects were moved,
+    // so the readers must read them again
+    for (size_t i = first; i < collapsed_objects.size(); ++i) {
+        auto *mo = collapsed_objects[i]->getData<MemoryObject>();
+        auto it = worklist->readers.find(mo);
+        if (it == worklist->readers.end())
+            continue;
+
+        for (PSNode *reader : it->second) {
+            if (isReachable(reader))
+                schedule(reader, /* reevaluate = */ true);
+        }
+    }
+}
+
+// process the queued nodes until the fixpoint is reached
+bool PointerAnalysisFI::solveWorklist() {
+    // one iteration is processing all nodes that were
+    // queued in the previous iteration
+    size_t n = 0;
+    while (!worklist->next_queue.empty()) {
+        if (checkBudget()) {
+            DBG(pta, "Exceeded the budget after " << n << " iterations");
+            overApproximateQueued(/* graphChanged = */ false);
+            return true;
+        }
+
+        if (options.maxIterations > 0 && n > options.maxIterations) {
+            DBG(pta, "Reached the maximum number of iterations: " << n);
+            for (PSNode *cur : worklist->next_queue)
+                worklist->queued[cur->getID()] = false;
+            setToEmpty(worklist->next_queue);
+            return false;
+        }
+        ++n;
+
+        if (profile)
+            profile->startIteration();
+
+        worklist->queue.swap(worklist->next_queue);
+        bool graphChanged = worklist->pool ? processQueueParallel()
+                                           : processQueue();
+        if (budget_exceeded) {
+            if (profile)
+                profile->endIteration();
+            overApproximateQueued(graphChanged);
+            return true;
+        }
+        worklist->queue.clear();
+
+        if (profile)
+            profile->endIteration();
+
+        // the graph has changed, process all the nodes
+        // that are now reachable (new edges were added)
+        if (graphChanged)
+            seedWorklist();
+
+        if (options.maxObjectOffsets > 0)
+            collapseQueued();
+    }
+
+    DBG(pta, "Reached fixpoint after " << n << " iterations, processed "
+                                       << processed_nodes_num << " nodes");
+    return true;
+}
+
+bool PointerAnalysisFI::runWorklist() {
+    DBG_SECTION_BEGIN(pta, "Running pointer analysis (worklist solver)");
+
+    // the new points-to sets use the pointer IDs of the graph
+    PointerIDLookupTable::Scope scope(&getPG()->getPointerIDs());
+
+    initWorklist();
+    if (options.isSeededSolver())
+        computeSeeds();
+    seedWorklist();
+    bool ret = solveWorklist();
+
+    DBG(pta, "Collapsed " << collapsed_nodes_num << " nodes in "
+                          << collapsed_cycles_num << " cycles");
+
+    finishCollapsed();
+
+    // the state is not needed anymore
+    worklist.reset();
+
+    sanityCheck();
+
+    DBG_SECTION_END(pta, "Running pointer analysis (worklist solver) done");
+
+    return ret;
+}
+
+///
+// Demand-driven mode.
+//
+// Only the nodes that are relevant for the queried nodes are processed
+// (they are marked as 'reachable' in the worklist state, so the solver
+// ignores the other nodes). A node is relevant if it is queried,
+// if it is an operand of a relevant node, or if it is a store (memcpy)
+// that may write to memory read by a relevant load (memcpy).
+// To find these stores without knowing the points-to sets
+// of their addresses, we look up the allocation sites from which
+// the addresses are derived by copying pointers (the origins). If an address
+// may come from memory (or a call), we solve the address first and the store
+// becomes relevant only if it writes to the memory that is read.
+// Calls via function pointers (and forks and joins) are always relevant,
+// because they change the graph. The state is kept between the queries,
+// so every node is solved at most once.
+
+bool PointerAnalysisFI::runDemandDriven() {
+    DBG_SECTION_BEGIN(pta, "Preparing demand-driven pointer analysis");
+
+    PointerIDLookupTable::Scope scope(&getPG()->getPointerIDs());
+
+    initWorklist();
+    seedWorklist();
+    bool ret = solveDemand();
+
+    DBG_SECTION_END(pta, "Preparing demand-driven pointer analysis done");
+
+    return ret;
+}
+
+// the node is solved already, or it is not in the program (e.g., it is
+// a global), so there is nothing to compute for it
+bool PointerAnalysisFI::isQueryAnswered(const PSNode *n) const {
+    auto id = n->getID();
+    return id >= worklist->inProgram.size() || !worklist->inProgram[id] ||
+           worklist->reachable[id];
+}
+
+bool PointerAnalysisFI::query(PSNode *n) {
+    assert(options.demandDriven && "Not in the demand-driven mode");
+    assert(worklist && "The analysis was not run");
+
+    if (isQueryAnswered(n))
+        return true;
+
+    PointerIDLookupTable::Scope scope(&getPG()->getPointerIDs());
+
+    std::vector<PSNode *> roots{n};
+    addRelevant(roots);
+    return solveDemand();
+}
+
+bool PointerAnalysisFI::query(const std::vector<PSNode *> &nodes) {
+    assert(options.demandDriven && "Not in the demand-driven mode");
+    assert(worklist && "The analysis was not run");
+
+    std::vector<PSNode *> roots;
+    for (PSNode *n : nodes) {
+        if (!isQueryAnswered(n))
+            roots.push_back(n);
+    }
+
+    if (roots.empty())
+        return true;
+
+    PointerIDLookupTable::Scope scope(&getPG()->getPointerIDs());
+
+    addRelevant(roots);
+    return solveDemand();
+}
+
+// solve the relevant nodes until no new nodes become relevant
+bool PointerAnalysisFI::solveDemand() {
+    do {
+        if (!solveWorklist())
+            return false;
+    } while (expandDemand());
+
+    return true;
+}
+
+void PointerAnalysisFI::seedDemand() {
+    resizeWorklistState();
+
+    std::vector<PSNode *> roots;
+    auto nodes = getPG()->getNodes(getPG()->getEntry()->getRoot());
+    for (PSNode *n : nodes) {
+        worklist->inProgram[n->getID()] = true;
+        if (canChangeGraph(n))
+            roots.push_back(n);
+
+        // the relevant nodes may have new operands now
+        if (worklist->reachable[n->getID()]) {
+            for (PSNode *op : n->getOperands())
+                roots.push_back(op);
+            schedule(n, /* reevaluate = */ true);
+        }
+    }
+
+    buildWritersIndex(nodes);
+    for (PSNode *object : worklist->readObjects)
+        addWriters(object, roots);
+
+    addRelevant(roots);
+
+    ++reseeds_num;
+}
+
+static PSNode *getWrittenAddress(PSNode *writer) {
+    if (writer->getType() == PSNodeType::STORE)
+        return writer->getOperand(1);
+    return PSNodeMemcpy::get(writer)->getDestination();
+}
+
+static PSNode *getReadAddress(PSNode *reader) {
+    if (reader->getType() == PSNodeType::LOAD)
+        return reader->getOperand(0);
+    return PSNodeMemcpy::get(reader)->getSource();
+}
+
+void PointerAnalysisFI::buildWritersIndex(const std::vector<PSNode *> &nodes) {
+    worklist->writers.clear();
+    worklist->unknownWriters.clear();
+
+    std::set<PSNode *> origins;
+    for (PSNode *n : nodes) {
+        if (n->getType() != PSNodeType::STORE &&
+            n->getType() != PSNodeType::MEMCPY)
+            continue;
+        if (worklist->reachable[n->getID()] ||
+            worklist->pendingWriters.count(n) > 0)
+            continue;
+
+        origins.clear();
+        if (!getOrigins(getWrittenAddress(n), origins)) {
+            worklist->unknownWriters.push_back(n);
+            continue;
+        }
+
+        for (PSNode *object : origins)
+            worklist->writers[object].push_back(n);
+    }
+}
+
+///
+// Get the allocation sites that the pointers in 'addr' may point to
+// by following the nodes that copy pointers. Return false if the pointers
+// may come from memory or from a call (or if the search takes too long).
+// The origins are the same nodes as returned by getObjectNode().
+bool PointerAnalysisFI::getOrigins(PSNode *addr,
+                                   std::set<PSNode *> &origins) const {
+    // bound the work spent on a single address
+    static const size_t maxVisited = 1000;
+
+    std::set<PSNode *> visited;
+    std::vector<PSNode *> stack{addr};
+    while (!stack.empty()) {
+        PSNode *n = stack.back();
+        stack.pop_back();
+        if (!visited.insert(n).second)
+            continue;
+        if (visited.size() > maxVisited)
+            return false;
+
+        switch (n->getType()) {
+        case PSNodeType::ALLOC:
+            origins.insert(n);
+            break;
+        case PSNodeType::CONSTANT:
+            for (const Pointer &ptr : n->pointsTo) {
+                if (canBeDereferenced(ptr))
+                    origins.insert(getObjectNode(ptr));
+            }
+            break;
+        case PSNodeType::FUNCTION:
+        case PSNodeType::NULL_ADDR:
+        case PSNodeType::UNKNOWN_MEM:
+        case PSNodeType::INVALIDATED:
+            // nothing that could be written
+            break;
+        case PSNodeType::CAST:
+        case PSNodeType::GEP:
+        case PSNodeType::PHI:
+        case PSNodeType::RETURN:
+        case PSNodeType::CALL_RETURN:
+            for (PSNode *op : n->getOperands())
+                stack.push_back(op);
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void PointerAnalysisFI::addWriters(PSNode *object,
+                                   std::vector<PSNode *> &roots) const {
+    auto it = worklist->writers.find(object);
+    if (it != worklist->writers.end())
+        roots.insert(roots.end(), it->second.begin(), it->second.end());
+}
+
+// add the nodes that became relevant after solving the relevant nodes,
+// return true if there are any
+bool PointerAnalysisFI::expandDemand() {
+    std::vector<PSNode *> roots;
+    auto &readObjects = worklist->readObjects;
+
+    for (PSNode *reader : worklist->relevantReaders) {
+        for (const Pointer &ptr : getReadAddress(reader)->pointsTo) {
+            if (!canBeDereferenced(ptr))
+                continue;
+
+            PSNode *object = getObjectNode(ptr);
+            if (readObjects.insert(object).second)
+                addWriters(object, roots);
+        }
+    }
+
+    if (readObjects.empty())
+        return addRelevant(roots);
+
+    // we do not know where these writers write,
+    // find it out by solving their addresses
+    for (PSNode *writer : worklist->unknownWriters) {
+        worklist->pendingWriters.insert(writer);
+        roots.push_back(getWrittenAddress(writer));
+    }
+    worklist->unknownWriters.clear();
+
+    auto &pending = worklist->pendingWriters;
+    for (auto it = pending.begin(); it != pending.end();) {
+        bool writesReadMemory = false;
+        for (const Pointer &ptr : getWrittenAddress(*it)->pointsTo) {
+            if (canBeDereferenced(ptr) &&
+                readObjects.count(getObjectNode(ptr)) > 0) {
+                writesReadMemory = true;
+                break;
+            }
+        }
+
+        if (writesReadMemory) {
+            roots.push_back(*it);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return addRelevant(roots);
+}
+
+// mark the nodes 'roots' and their operands (transitively) as relevant
+// and queue them, return true if any node became relevant
+bool PointerAnalysisFI::addRelevant(std::vector<PSNode *> &roots) {
+    bool added = false;
+    while (!roots.empty()) {
+        PSNode *n = roots.back();
+        roots.pop_back();
+
+        auto id = n->getID();
+        if (id >= worklist->inProgram.size() || !worklist->inProgram[id] ||
+            worklist->reachable[id])
+            continue;
+
+        worklist->reachable[id] = true;
+        ++relevant_nodes_num;
+        added = true;
+
+        if (n->getType() == PSNodeType::LOAD ||
+            n->getType() == PSNodeType::MEMCPY)
+            worklist->relevantReaders.push_back(n);
+
+        schedule(n, /* reevaluate = */ true);
+        for (PSNode *op : n->getOperands())
+            roots.push_back(op);
+    }
+
+    return added;
+}
+
+///
+// Cycle collapsing.
+//
+// Nodes that only copy the pointers from their operands (casts, PHIs, GEPs
+// with zero offset, ...) and form a cycle always end up with the same
+// points-to set. We collapse such a cycle into one node (the representant)
+// -- the representant is the only node of the cycle that is processed
+// and the other nodes just copy its new pointers and pass them
+// to their users. The graph itself is not changed, the collapsing lives
+// only in the state of the solver. The copy edges change only when
+// the graph changes, so we look for the cycles whenever the worklist
+// is (re-)seeded.
+
+PSNode *PointerAnalysisFI::getRepresentant(PSNode *n) {
+    auto &representant = worklist->representant;
+    if (n->getID() >= representant.size())
+        return n;
+
+    PSNode *rep = representant[n->getID()];
+    if (!rep)
+        return n;
+
+    // a representant may have been collapsed later into another cycle
+    rep = getRepresentant(rep);
+    representant[n->getID()] = rep;
+    return rep;
+}
+
+PSNode *PointerAnalysisFI::findRepresentant(PSNode *n) const {
+    const auto &representant = worklist->representant;
+    while (n->getID() < representant.size() && representant[n->getID()])
+        n = representant[n->getID()];
+    return n;
+}
+
+bool PointerAnalysisFI::isCopyNode(PSNode *n) const {
+    switch (n->getType()) {
+    case PSNodeType::CAST:
+    case PSNodeType::PHI:
+    case PSNodeType::RETURN:
+        return true;
+    case PSNodeType::CALL_RETURN:
+        return !options.invalidateNodes;
+    case PSNodeType::GEP:
+        // GEP with zero offset is a cast
+        // (the same as in PSEquivalentNodesMerger)
+        return PSNodeGep::get(n)->getOffset().isZero();
+    default:
+        return false;
+    }
+}
+
+void PointerAnalysisFI::collapseCycles() {
+    // edges operand -> user between the copy nodes
+    // that are reachable and were not collapsed yet
+    struct CopyEdges {
+        PointerAnalysisFI *PTA;
+
+        void addUsers(PSNode *n, std::vector<PSNode *> &succs) const {
+            for (PSNode *user : n->getUsers()) {
+                auto id = user->getID();
+                if (id < PTA->worklist->reachable.size() &&
+                    PTA->worklist->reachable[id] && PTA->isCopyNode(user))
+                    succs.push_back(PTA->getRepresentant(user));
+            }
+        }
+
+        std::vector<PSNode *> operator()(PSNode *n) const {
+            std::vector<PSNode *> succs;
+            addUsers(n, succs);
+            if (const auto *members = PTA->getMembers(n)) {
+                for (PSNode *m : *members)
+                    addUsers(m, succs);
+            }
+            return succs;
+        }
+    };
+
+    SCC<PSNode, CopyEdges> scc(CopyEdges{this});
+    for (const auto &nd : getPG()->getNodes()) {
+        PSNode *n = nd.get();
+        if (!n || n->getID() >= worklist->reachable.size() ||
+            !worklist->reachable[n->getID()] || !isCopyNode(n) ||
+            getRepresentant(n) != n || scc.visited(n))
+            continue;
+
+        scc.compute(n);
+    }
+
+    for (const auto &component : scc.getSCC()) {
+        if (component.size() > 1)
+            collapse(component);
+    }
+}
+
+void PointerAnalysisFI::collapse(const std::vector<PSNode *> &component) {
+    PSNode *rep = *std::min_element(
+            component.begin(), component.end(),
+            [](PSNode *a, PSNode *b) { return a->getID() < b->getID(); });
+
+    auto &repMembers = worklist->members[rep];
+    for (PSNode *n : component) {
+        if (n == rep)
+            continue;
+
+        worklist->representant[n->getID()] = rep;
+        rep->addPointsTo(n->pointsTo);
+        // the node may have not been processed yet (e.g., it was just
+        // created), so take also the pointers from its operands
+        for (PSNode *op : n->getOperands())
+            rep->addPointsTo(getRepresentant(op)->pointsTo);
+        worklist->propagated[n->getID()].clear();
+        repMembers.push_back(n);
+        worklist->collapsed.push_back(n);
+        ++collapsed_nodes_num;
+
+        // the node may be a representant of a cycle collapsed before
+        auto it = worklist->members.find(n);
+        if (it != worklist->members.end()) {
+            repMembers.insert(repMembers.end(), it->second.begin(),
+                              it->second.end());
+            worklist->members.erase(it);
+        }
+    }
+
+    ++collapsed_cycles_num;
+
+    // the collapsed nodes and the users may not have
+    // all the pointers of 'rep', propagate all of them again
+    worklist->propagated[rep->getID()].clear();
+    schedule(rep, /* reevaluate = */ true);
+}
+
+const std::vector<PSNode *> *PointerAnalysisFI::getMembers(PSNode *rep) const {
+    auto it = worklist->members.find(rep);
+    return it == worklist->members.end() ? nullptr : &it->second;
+}
+
+// the nodes collapsed into 'rep' copy the pointers that were newly added
+// to 'rep', so that their users (and the graph builder) see the pointers
+// without reading them through the representant
+void PointerAnalysisFI::propagateToMembers(PSNode *rep,
+                                           const PointsToSetT &delta) {
+    const auto *members = getMembers(rep);
+    if (!members)
+        return;
+
+    for (PSNode *m : *members)
+        m->addPointsTo(delta);
+
+    for (PSNode *m : *members) {
+        for (PSNode *user : m->getUsers())
+            propagate(rep, user, delta);
+    }
+}
+
+// the collapsed nodes have the same points-to set as their representant
+// (the representant may have been over-approximated, see overApproximate())
+void PointerAnalysisFI::finishCollapsed() {
+    for (PSNode *n : worklist->collapsed)
+        n->addPointsTo(getRepresentant(n)->pointsTo);
+}
+
+} // namespace pta
+} // namespace dg
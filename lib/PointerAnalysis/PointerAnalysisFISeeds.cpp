@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/PointerAnalysis/PointerAnalysisFI.h"
+#include "dg/SCC.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace pta {
+
+///
+// Seeding the points-to sets.
+//
+// Before the worklist solver starts, we compute for every function
+// the pointers that its nodes get regardless of the callers and of
+// the memory: the pointers that flow from allocations, functions
+// and constants through casts, GEPs and PHIs, and the pointers returned
+// by the called functions. The functions are seeded in the order
+// of the strongly connected components of the call graph, callees first,
+// and the components whose callees are already seeded are processed
+// in parallel. The seeds are subsets of the results, so they are just
+// added to the points-to sets and the worklist solver then computes
+// the rest (the pointers that come from parameters, from memory
+// and from calls via pointers).
+//
+// These are not summaries of functions: the effects on memory
+// and the pointers that depend on the parameters are not computed
+// here and they are not instantiated per call site. The flow-insensitive
+// analysis models memory globally, so the whole program is still
+// solved by the worklist solver, the seeding only saves its work.
+
+struct PointerAnalysisFI::SeedingState {
+    struct Function {
+        PointerSubgraph *subgraph;
+        std::vector<PSNode *> nodes;
+        std::vector<Function *> callees;
+        unsigned scc_id{0};
+
+        Function(PointerSubgraph *s) : subgraph(s) {}
+
+        // the interface for SCC
+        void setSCCId(unsigned id) { scc_id = id; }
+        unsigned getSCCId() const { return scc_id; }
+        const std::vector<Function *> &successors() const { return callees; }
+    };
+
+    std::vector<std::unique_ptr<Function>> functions;
+    // the function of the node (indexed by IDs of nodes)
+    std::vector<Function *> functionOf;
+    // the components of the call graph, callees go first
+    SCC<Function>::SCC_t components;
+    // the length of the longest path from the component to a leaf
+    // in the condensed call graph
+    std::vector<unsigned> level;
+    // the seeds of nodes (indexed by IDs of nodes)
+    std::vector<std::vector<Pointer>> seeds;
+};
+
+static bool isSourceNode(const PSNode *n) {
+    switch (n->getType()) {
+    case PSNodeType::ALLOC:
+    case PSNodeType::FUNCTION:
+    case PSNodeType::CONSTANT:
+    case PSNodeType::NULL_ADDR:
+    case PSNodeType::UNKNOWN_MEM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+///
+// Compute the seeds of the functions in the component 'idx'.
+// The components on lower levels are already seeded and this
+// method writes only the seeds of the nodes in the component,
+// so it may run concurrently for the components on the same level.
+void PointerAnalysisFI::seedComponent(SeedingState &state,
+                                           size_t idx) const {
+    const auto &component = state.components[idx];
+    std::unordered_map<const PSNode *, std::set<Pointer>> local;
+
+    // call 'fn' for every pointer of the operand that is known
+    // without the callers and memory
+    auto forEachPointer = [&](const PSNode *op,
+                              const std::function<void(const Pointer &)> &fn) {
+        if (isSourceNode(op)) {
+            for (const Pointer &ptr : op->pointsTo)
+                fn(ptr);
+            return;
+        }
+
+        auto id = op->getID();
+        const auto *F = id < state.functionOf.size() ? state.functionOf[id]
+                                                     : nullptr;
+        if (!F) {
+            // a global node (already processed), or a node
+            // of a function that is not reachable (empty)
+            for (const Pointer &ptr : op->pointsTo)
+                fn(ptr);
+        } else if (F->scc_id == idx) {
+            auto it = local.find(op);
+            if (it != local.end()) {
+                for (const Pointer &ptr : it->second)
+                    fn(ptr);
+            }
+        } else if (state.level[F->scc_id] < state.level[idx]) {
+            for (const Pointer &ptr : state.seeds[id])
+                fn(ptr);
+        }
+        // else the node is in a caller, we do not know its pointers yet
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto *F : component) {
+            for (PSNode *n : F->nodes) {
+                switch (n->getType()) {
+                case PSNodeType::CAST:
+                case PSNodeType::PHI:
+                case PSNodeType::RETURN:
+                case PSNodeType::CALL_RETURN: {
+                    auto &pts = local[n];
+                    for (PSNode *op : n->getOperands()) {
+                        forEachPointer(op, [&](const Pointer &ptr) {
+                            changed |= pts.insert(ptr).second;
+                        });
+                    }
+                    break;
+                }
+                case PSNodeType::GEP: {
+                    auto &pts = local[n];
+                    const PSNodeGep *gep = PSNodeGep::get(n);
+                    assert(gep && "Non-GEP given");
+                    forEachPointer(gep->getSource(), [&](const Pointer &ptr) {
+                        changed |= pts.insert(getGepPointer(gep, ptr)).second;
+                    });
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const auto &it : local) {
+        auto &seeds = state.seeds[it.first->getID()];
+        seeds.assign(it.second.begin(), it.second.end());
+    }
+}
+
+void PointerAnalysisFI::computeSeeds() {
+    DBG_SECTION_BEGIN(pta, "Seeding points-to sets of functions");
+
+    SeedingState state;
+    auto size = getPG()->getNodes().size();
+    state.functionOf.resize(size, nullptr);
+    state.seeds.resize(size);
+
+    // the functions that are reachable from the entry (the others
+    // are not processed by the solver either)
+    std::vector<bool> reachable(size, false);
+    for (PSNode *n : getPG()->getNodes(getPG()->getEntry()->getRoot()))
+        reachable[n->getID()] = true;
+
+    std::unordered_map<const PointerSubgraph *, SeedingState::Function *>
+            subgraphs;
+    for (const auto &subg : getPG()->getSubgraphs()) {
+        if (!subg->root || !reachable[subg->root->getID()])
+            continue;
+
+        auto *F = new SeedingState::Function(subg.get());
+        state.functions.emplace_back(F);
+        subgraphs[subg.get()] = F;
+
+        // every node belongs to one function only, even if it is
+        // reachable also from another function (e.g., via fork)
+        for (PSNode *n : getPG()->getNodes(subg->root,
+                                           /* interprocedural = */ false)) {
+            if (!state.functionOf[n->getID()]) {
+                state.functionOf[n->getID()] = F;
+                F->nodes.push_back(n);
+            }
+        }
+    }
+
+    for (const auto &F : state.functions) {
+        for (PSNode *n : F->nodes) {
+            if (PSNodeCall *C = PSNodeCall::get(n)) {
+                for (PointerSubgraph *callee : C->getCallees()) {
+                    auto it = subgraphs.find(callee);
+                    if (it != subgraphs.end())
+                        F->callees.push_back(it->second);
+                }
+            }
+        }
+    }
+
+    SCC<SeedingState::Function> scc;
+    for (const auto &F : state.functions) {
+        if (!scc.visited(F.get()))
+            scc.compute(F.get());
+    }
+    state.components = scc.getSCC();
+
+    // the callees of a component are in components with lower indices
+    state.level.resize(state.components.size(), 0);
+    std::vector<std::vector<size_t>> levels;
+    for (size_t idx = 0; idx < state.components.size(); ++idx) {
+        unsigned lvl = 0;
+        for (const auto *F : state.components[idx]) {
+            for (const auto *callee : F->callees) {
+                if (callee->scc_id != idx)
+                    lvl = std::max(lvl, state.level[callee->scc_id] + 1);
+            }
+        }
+        state.level[idx] = lvl;
+        if (levels.size() <= lvl)
+            levels.resize(lvl + 1);
+        levels[lvl].push_back(idx);
+    }
+
+    for (const auto &components : levels) {
+        auto seed = [&](size_t i) {
+            seedComponent(state, components[i]);
+        };
+        if (worklist->pool)
+            worklist->pool->parallelFor(components.size(), seed,
+                                        /* chunk = */ 1);
+        else {
+            for (size_t i = 0; i < components.size(); ++i)
+                seed(i);
+        }
+    }
+
+    // use the seeds
+    for (const auto &F : state.functions) {
+        for (PSNode *n : F->nodes) {
+            for (const Pointer &ptr : state.seeds[n->getID()]) {
+                if (n->addPointsTo(ptr))
+                    ++seed_pointers_num;
+            }
+        }
+
+        auto &returns = return_seeds[F->subgraph];
+        returns.clear();
+        for (PSNode *ret : F->subgraph->returnNodes) {
+            const auto &seeds = state.seeds[ret->getID()];
+            returns.insert(returns.end(), seeds.begin(), seeds.end());
+        }
+        std::sort(returns.begin(), returns.end());
+        returns.erase(std::unique(returns.begin(), returns.end()),
+                      returns.end());
+    }
+
+    seeded_functions_num = state.functions.size();
+    seeding_components_num = state.components.size();
+    seeding_levels_num = levels.size();
+
+    DBG(pta, "Seeded " << seeded_functions_num << " functions in "
+                       << seeding_components_num << " components and "
+                       << seeding_levels_num << " levels, added "
+                       << seed_pointers_num << " pointers");
+    DBG_SECTION_END(pta, "Seeding points-to sets of functions done");
+}
+
+} // namespace pta
+} // namespace dg
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "dg/PointerAnalysis/PointerAnalysisProfile.h"
+#include "dg/PointerAnalysis/PointerGraph.h"
+
+namespace dg {
+namespace pta {
+
+void PointerAnalysisProfile::recordNode(const PSNode *node, bool count,
+                                        Clock::duration time) {
+    auto ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time)
+                    .count());
+    auto id = node->getID();
+    if (_nodes.size() <= id)
+        _nodes.resize(id + 1);
+    auto type = static_cast<size_t>(node->getType());
+    if (_types.size() <= type)
+        _types.resize(type + 1);
+
+    auto &stats = _nodes[id];
+    stats.time += ns;
+    _types[type].time += ns;
+    if (!count)
+        return;
+
+    ++stats.processed;
+    ++_types[type].processed;
+
+    // the points-to set may also shrink (e.g., when it is reset
+    // between the phases of an analysis)
+    size_t size = node->pointsTo.size();
+    size_t added = size > stats.lastSize ? size - stats.lastSize : 0;
+    stats.lastSize = size;
+
+    if (!_inIteration)
+        return;
+
+    auto &iteration = _iterations.back();
+    ++iteration.processed;
+    if (added > 0) {
+        ++iteration.changed;
+        iteration.pointers += added;
+    }
+}
+
+void PointerAnalysisProfile::startIteration() {
+    _iterations.emplace_back();
+    _iterationStart = Clock::now();
+    _inIteration = true;
+}
+
+void PointerAnalysisProfile::endIteration() {
+    assert(_inIteration && "Iteration was not started");
+    _inIteration = false;
+    // the time of the whole iteration, including the parts
+    // that are not attributed to any node
+    _iterations.back().time = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - _iterationStart)
+                    .count());
+}
+
+namespace {
+// the bucket of a histogram with power-of-two ranges:
+// [0], [1], [2, 3], [4, 7], ...
+unsigned bucket(uint64_t value) {
+    unsigned b = 0;
+    while (value > 0) {
+        value >>= 1;
+        ++b;
+    }
+    return b;
+}
+
+void dumpHistogram(std::ostream &os, const std::vector<uint64_t> &hist) {
+    os << "[";
+    bool first = true;
+    for (unsigned b = 0; b < hist.size(); ++b) {
+        if (hist[b] == 0)
+            continue;
+        uint64_t min = b == 0 ? 0 : (uint64_t{1} << (b - 1));
+        uint64_t max = b == 0 ? 0 : (uint64_t{1} << b) - 1;
+        os << (first ? "" : ",") << "\n    {\"min\": " << min
+           << ", \"max\": " << max << ", \"nodes\": " << hist[b] << "}";
+        first = false;
+    }
+    os << "\n  ]";
+}
+
+// the name of the type without the "PSNodeType::" prefix
+const char *typeName(PSNodeType type) {
+    const char *name = PSNodeTypeToCString(type);
+    const char *sep = strrchr(name, ':');
+    return sep ? sep + 1 : name;
+}
+
+void dumpString(std::ostream &os, const std::string &str) {
+    os << '"';
+    for (char c : str) {
+        switch (c) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                os << buf;
+            } else {
+                os << c;
+            }
+        }
+    }
+    os << '"';
+}
+} // anonymous namespace
+
+void PointerAnalysisProfile::dumpJSON(
+        std::ostream &os, const PointerGraph *PG,
+        const std::function<std::string(const PSNode *)> &describe,
+        unsigned top) const {
+    Stats total;
+    std::vector<uint64_t> reprocessing;
+    for (const auto &stats : _nodes) {
+        if (stats.processed == 0)
+            continue;
+        total.processed += stats.processed;
+        total.time += stats.time;
+
+        auto b = bucket(stats.processed);
+        if (reprocessing.size() <= b)
+            reprocessing.resize(b + 1);
+        ++reprocessing[b];
+    }
+
+    uint64_t processedNodes = 0;
+    for (auto num : reprocessing)
+        processedNodes += num;
+
+    std::vector<uint64_t> sizes;
+    for (const auto &nd : PG->getNodes()) {
+        if (!nd)
+            continue;
+        auto b = bucket(nd->pointsTo.size());
+        if (sizes.size() <= b)
+            sizes.resize(b + 1);
+        ++sizes[b];
+    }
+
+    os << "{\n";
+    os << "  \"iterations\": " << _iterations.size() << ",\n";
+    os << "  \"processed\": " << total.processed << ",\n";
+    os << "  \"processed_nodes\": " << processedNodes << ",\n";
+    os << "  \"reprocessed\": " << total.processed - processedNodes << ",\n";
+    os << "  \"time_ns\": " << total.time << ",\n";
+
+    os << "  \"types\": [";
+    bool first = true;
+    for (size_t type = 0; type < _types.size(); ++type) {
+        const auto &stats = _types[type];
+        if (stats.processed == 0 && stats.time == 0)
+            continue;
+        os << (first ? "" : ",") << "\n    {\"type\": \""
+           << typeName(static_cast<PSNodeType>(type))
+           << "\", \"processed\": " << stats.processed
+           << ", \"time_ns\": " << stats.time << "}";
+        first = false;
+    }
+    os << "\n  ],\n";
+
+    os << "  \"reprocessing_histogram\": ";
+    dumpHistogram(os, reprocessing);
+    os << ",\n";
+
+    os << "  \"points_to_size_histogram\": ";
+    dumpHistogram(os, sizes);
+    os << ",\n";
+
+    os << "  \"growth\": [";
+    for (size_t i = 0; i < _iterations.size(); ++i) {
+        const auto &it = _iterations[i];
+        os << (i == 0 ? "" : ",") << "\n    {\"iteration\": " << i + 1
+           << ", \"processed\": " << it.processed
+           << ", \"changed\": " << it.changed
+           << ", \"pointers\": " << it.pointers
+           << ", \"time_ns\": " << it.time << "}";
+    }
+    os << "\n  ],\n";
+
+    // the nodes that took the most time
+    std::vector<unsigned> hottest;
+    for (unsigned id = 0; id < _nodes.size(); ++id) {
+        if (_nodes[id].processed > 0 && id < PG->getNodes().size() &&
+            PG->getNodes()[id])
+            hottest.push_back(id);
+    }
+    auto hotter = [this](unsigned a, unsigned b) {
+        if (_nodes[a].time != _nodes[b].time)
+            return _nodes[a].time > _nodes[b].time;
+        return a < b;
+    };
+    if (hottest.size() > top) {
+        std::partial_sort(hottest.begin(), hottest.begin() + top,
+                          hottest.end(), hotter);
+        hottest.resize(top);
+    } else {
+        std::sort(hottest.begin(), hottest.end(), hotter);
+    }
+
+    os << "  \"hottest\": [";
+    for (size_t i = 0; i < hottest.size(); ++i) {
+        const PSNode *nd = PG->getNodes()[hottest[i]].get();
+        const auto &stats = _nodes[hottest[i]];
+        os << (i == 0 ? "" : ",") << "\n    {\"id\": " << nd->getID()
+           << ", \"type\": \"" << typeName(nd->getType())
+           << "\", \"processed\": " << stats.processed
+           << ", \"time_ns\": " << stats.time
+           << ", \"points_to_size\": " << nd->pointsTo.size();
+        if (describe) {
+            os << ", \"value\": ";
+            dumpString(os, describe(nd));
+        }
+        os << "}";
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+} // namespace pta
+} // namespace dg
@@ -0,0 +1,445 @@
+#include <algorithm>
+
+#include "dg/PointerAnalysis/PointerAnalysisSFS.h"
+#include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSet.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace pta {
+
+// iterate over successors in the interprocedural CFG. Like
+// PointerAnalysisFS, we let the memory flow also from the call
+// to its call-return node (the call may call also a function that
+// is not defined and thus has no subgraph)
+template <typename F>
+static void forEachSuccessor(PSNode *n, F func) {
+    if (PSNodeCall *C = PSNodeCall::get(n)) {
+        for (auto *subg : C->getCallees())
+            func(subg->getRoot());
+    } else if (PSNodeRet *R = PSNodeRet::get(n)) {
+        for (auto *ret : R->getReturnSites())
+            func(ret);
+    }
+
+    for (auto *s : n->successors())
+        func(s);
+}
+
+static void addTargets(std::vector<PSNode *> &targets,
+                       const PointsToSetT &pointers) {
+    for (const auto &ptr : pointers) {
+        if (PointerAnalysis::canBeDereferenced(ptr))
+            targets.push_back(ptr.target);
+    }
+}
+
+static void sortTargets(std::vector<PSNode *> &targets) {
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+}
+
+static bool hasTarget(const std::vector<PSNode *> &targets, PSNode *target) {
+    return std::binary_search(targets.begin(), targets.end(), target);
+}
+
+static bool isOnLoop(const PSNode *n) {
+    return n->getParent() ? (n->getParent()->getLoop(n) != nullptr) : false;
+}
+
+PointerAnalysisSFS::MemoryDef *
+PointerAnalysisSFS::getOrCreateDef(PSNode *node, PSNode *target,
+                                   bool *created) {
+    auto &defs = nodes_info[node->getID()].defs;
+    auto it = defs.find(target);
+    if (it != defs.end()) {
+        if (created)
+            *created = false;
+        return it->second;
+    }
+
+    auto *def = new MemoryDef(node, target);
+    memory_defs.emplace_back(def);
+    defs.emplace(target, def);
+    if (created)
+        *created = true;
+    return def;
+}
+
+PointerAnalysisSFS::MemoryDef *PointerAnalysisSFS::getGlobalDef(PSNode *target) {
+    auto &def = global_defs[target];
+    if (!def) {
+        def = new MemoryDef(nullptr, target);
+        memory_defs.emplace_back(def);
+    }
+    return def;
+}
+
+void PointerAnalysisSFS::addDefUseEdge(MemoryDef *from, MemoryDef *to) {
+    if (std::find(to->inputs.begin(), to->inputs.end(), from) !=
+        to->inputs.end())
+        return;
+
+    to->inputs.push_back(from);
+    from->successors.push_back(to);
+    ++def_use_edges_num;
+}
+
+///
+// Find out which memory objects are accessed by the nodes
+// according to the results of the flow-insensitive analysis
+// and count the predecessors of nodes in the interprocedural CFG.
+void PointerAnalysisSFS::computeAccesses(const std::vector<PSNode *> &nodes) {
+    for (PSNode *n : nodes) {
+        auto &info = nodes_info[n->getID()];
+        switch (n->getType()) {
+        case PSNodeType::STORE:
+            addTargets(info.writes, n->getOperand(1)->pointsTo);
+            break;
+        case PSNodeType::LOAD:
+            addTargets(info.reads, n->getOperand(0)->pointsTo);
+            break;
+        case PSNodeType::MEMCPY: {
+            PSNodeMemcpy *memcpy = PSNodeMemcpy::get(n);
+            addTargets(info.writes, memcpy->getDestination()->pointsTo);
+            addTargets(info.reads, memcpy->getSource()->pointsTo);
+            break;
+        }
+        default:
+            break;
+        }
+
+        sortTargets(info.writes);
+        sortTargets(info.reads);
+
+        forEachSuccessor(n, [this](PSNode *s) {
+            auto &sinfo = nodes_info[s->getID()];
+            if (sinfo.reachable)
+                ++sinfo.predecessors;
+        });
+    }
+}
+
+///
+// Clear the points-to sets that are computed from memory
+// (or from the nodes whose points-to sets are computed from memory).
+// The sets of allocations, constants, and calls are kept, as well as
+// the results of resolving calls via function pointers and forks.
+void PointerAnalysisSFS::resetPointsTo(const std::vector<PSNode *> &nodes) {
+    for (PSNode *n : nodes) {
+        switch (n->getType()) {
+        case PSNodeType::LOAD:
+        case PSNodeType::GEP:
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+        case PSNodeType::RETURN:
+        case PSNodeType::CALL_RETURN:
+            n->pointsTo.clear();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void PointerAnalysisSFS::buildDefUseChains(const std::vector<PSNode *> &nodes) {
+    std::map<PSNode *, std::vector<PSNode *>> writers;
+    for (PSNode *n : nodes) {
+        for (PSNode *target : nodes_info[n->getID()].writes)
+            writers[target].push_back(n);
+    }
+
+    // objects that are only initialized by globals
+    for (auto &it : global_defs)
+        writers[it.first];
+
+    for (auto &it : writers)
+        buildDefUseChains(it.first, it.second);
+
+    DBG(pta, "Built " << memory_defs.size() << " memory definitions ("
+                      << memory_phis_num << " merges) with "
+                      << def_use_edges_num << " def-use edges");
+}
+
+///
+// Build the def-use chains of the memory object 'target'.
+// Starting from every definition, we walk the interprocedural CFG until
+// we hit another definition of the object or a join point. The nodes
+// on the way that read the object use the definition we started from.
+// Join points get a definition that merges all definitions that reach
+// them, so every node (that is not a join point) is visited only once.
+void PointerAnalysisSFS::buildDefUseChains(
+        PSNode *target, const std::vector<PSNode *> &writers) {
+    PSNode *root = PG->getEntry()->getRoot();
+    std::vector<MemoryDef *> worklist;
+
+    // the entry of the program gets the state of memory set by globals
+    auto *rootDef = getOrCreateDef(root, target);
+    auto git = global_defs.find(target);
+    if (git != global_defs.end())
+        addDefUseEdge(git->second, rootDef);
+    worklist.push_back(rootDef);
+
+    for (PSNode *w : writers) {
+        bool created;
+        auto *def = getOrCreateDef(w, target, &created);
+        if (created)
+            worklist.push_back(def);
+    }
+
+    std::vector<PSNode *> stack;
+    auto push = [this, &stack](PSNode *s) {
+        if (nodes_info[s->getID()].reachable)
+            stack.push_back(s);
+    };
+    while (!worklist.empty()) {
+        auto *def = worklist.back();
+        worklist.pop_back();
+
+        assert(stack.empty());
+        forEachSuccessor(def->node, push);
+        while (!stack.empty()) {
+            PSNode *cur = stack.back();
+            stack.pop_back();
+
+            auto &info = nodes_info[cur->getID()];
+            if (cur == root || info.predecessors > 1 ||
+                hasTarget(info.writes, target)) {
+                bool created;
+                auto *next = getOrCreateDef(cur, target, &created);
+                if (created) {
+                    ++memory_phis_num;
+                    worklist.push_back(next);
+                }
+                addDefUseEdge(def, next);
+                continue;
+            }
+
+            if (hasTarget(info.reads, target)) {
+                info.uses[target] = def;
+                def->readers.push_back(cur);
+                ++def_use_edges_num;
+            }
+
+            forEachSuccessor(cur, push);
+        }
+    }
+}
+
+///
+// A store overwrites the memory if it stores to a single concrete
+// memory location (that is not allocated in a loop or on heap,
+// as then it may represent more locations)
+bool PointerAnalysisSFS::isStrongUpdate(PSNode *node, PSNode *target,
+                                        Offset &off) const {
+    if (node->getType() != PSNodeType::STORE)
+        return false;
+
+    const auto &pointers = node->getOperand(1)->pointsTo;
+    if (!pointers.isSingleton())
+        return false;
+
+    const Pointer ptr = *pointers.begin();
+    if (ptr.target != target || ptr.offset.isUnknown())
+        return false;
+
+    auto *alloc = PSNodeAlloc::get(target);
+    if (!alloc || alloc->isHeap() || isOnLoop(target))
+        return false;
+
+    off = ptr.offset;
+    return true;
+}
+
+bool PointerAnalysisSFS::mergeInputs(PSNode *node, MemoryDef *def) {
+    Offset killed = Offset::UNKNOWN;
+    bool strong = isStrongUpdate(node, def->object.node, killed);
+
+    bool changed = false;
+    for (MemoryDef *input : def->inputs) {
+        for (auto &it : input->object.pointsTo) {
+            if (strong && it.first == killed)
+                continue;
+            changed |= def->object.addPointsTo(it.first, it.second);
+        }
+    }
+
+    return changed;
+}
+
+void PointerAnalysisSFS::getMemoryObjects(
+        PSNode *where, const Pointer &pointer,
+        std::vector<MemoryObject *> &objects) {
+    if (!sparse) {
+        PointerAnalysisFI::getMemoryObjects(where, pointer, objects);
+        return;
+    }
+
+    if (processing_globals) {
+        objects.push_back(&getGlobalDef(pointer.target)->object);
+        return;
+    }
+
+    auto &info = nodes_info[where->getID()];
+    auto it = info.defs.find(pointer.target);
+    if (it != info.defs.end()) {
+        objects.push_back(&it->second->object);
+        return;
+    }
+
+    it = info.uses.find(pointer.target);
+    if (it != info.uses.end()) {
+        objects.push_back(&it->second->object);
+        return;
+    }
+
+    // memcpy needs some object to copy from
+    // (writes always have a definition)
+    if (where->getType() == PSNodeType::MEMCPY) {
+        assert(!hasTarget(info.writes, pointer.target));
+        objects.push_back(&undefined_memory);
+    }
+}
+
+void PointerAnalysisSFS::schedule(PSNode *n) {
+    // the nodes that are not reachable keep the results
+    // of the flow-insensitive analysis
+    auto &info = nodes_info[n->getID()];
+    if (info.reachable && !info.queued) {
+        info.queued = true;
+        queue.push_back(n);
+    }
+}
+
+void PointerAnalysisSFS::scheduleReaders(MemoryDef *def) {
+    for (PSNode *reader : def->readers)
+        schedule(reader);
+    for (MemoryDef *succ : def->successors)
+        schedule(succ->node);
+}
+
+void PointerAnalysisSFS::processSparse(PSNode *n) {
+    ++sparse_processed_nodes_num;
+    PointerAnalysisProfile::NodeScope prof(profile.get(), n);
+
+    auto &info = nodes_info[n->getID()];
+    for (auto &it : info.defs) {
+        if (mergeInputs(n, it.second))
+            scheduleReaders(it.second);
+    }
+
+    switch (n->getType()) {
+    case PSNodeType::CALL_FUNCPTR:
+    case PSNodeType::FORK:
+    case PSNodeType::JOIN:
+        // these were resolved by the flow-insensitive analysis
+        return;
+    default:
+        break;
+    }
+
+    if (!processNode(n))
+        return;
+
+    if (n->getType() == PSNodeType::STORE ||
+        n->getType() == PSNodeType::MEMCPY) {
+        for (auto &it : info.defs)
+            scheduleReaders(it.second);
+    } else {
+        for (PSNode *user : n->getUsers())
+            schedule(user);
+    }
+}
+
+void PointerAnalysisSFS::runSparse(const std::vector<PSNode *> &nodes) {
+    for (PSNode *n : nodes)
+        schedule(n);
+
+    std::vector<PSNode *> current;
+    while (!queue.empty()) {
+        if (checkBudget()) {
+            overApproximateSparse(current);
+            return;
+        }
+
+        if (profile)
+            profile->startIteration();
+
+        current.swap(queue);
+        for (size_t i = 0; i < current.size(); ++i) {
+            if (shouldCheckBudget() && checkBudget()) {
+                if (profile)
+                    profile->endIteration();
+                current.erase(current.begin(), current.begin() + i);
+                overApproximateSparse(current);
+                return;
+            }
+            nodes_info[current[i]->getID()].queued = false;
+            processSparse(current[i]);
+        }
+        current.clear();
+
+        if (profile)
+            profile->endIteration();
+    }
+}
+
+// the budget is exceeded: over-approximate the nodes that
+// were not processed. The def-use chains of memory may be incomplete
+// anywhere, so also all the loads are over-approximated.
+void PointerAnalysisSFS::overApproximateSparse(std::vector<PSNode *> &pending) {
+    for (PSNode *n : queue)
+        pending.push_back(n);
+    for (PSNode *n : pending)
+        nodes_info[n->getID()].queued = false;
+    queue.clear();
+
+    overApproximate(pending, /* flowSensitive = */ true);
+    pending.clear();
+}
+
+bool PointerAnalysisSFS::run() {
+    DBG_SECTION_BEGIN(pta, "Running sparse flow-sensitive pointer analysis");
+
+    // the pre-analysis, it also resolves calls via function pointers
+    sparse = false;
+    bool ret = PointerAnalysisFI::run();
+    if (exceededBudget()) {
+        // keep the over-approximated results of the pre-analysis
+        DBG_SECTION_END(pta, "Running sparse flow-sensitive pointer analysis "
+                             "stopped, exceeded the budget");
+        return ret;
+    }
+
+    PointerIDLookupTable::Scope scope(&PG->getPointerIDs());
+    sparse = true;
+
+    PG->computeLoops();
+
+    auto nodes = PG->getNodes(PG->getEntry()->getRoot());
+    nodes_info.resize(PG->getNodes().size());
+    for (PSNode *n : nodes)
+        nodes_info[n->getID()].reachable = true;
+
+    computeAccesses(nodes);
+    resetPointsTo(nodes);
+
+    processing_globals = true;
+    processGlobals();
+    processing_globals = false;
+
+    buildDefUseChains(nodes);
+    runSparse(nodes);
+
+    DBG(pta, "Processed " << sparse_processed_nodes_num << " nodes");
+
+    sanityCheck();
+
+    DBG_SECTION_END(pta, "Running sparse flow-sensitive pointer analysis done");
+
+    return ret;
+}
+
+} // namespace pta
+} // namespace dg
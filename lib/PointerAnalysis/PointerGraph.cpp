@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <mutex>
 
 #include "dg/PointerAnalysis/PSNode.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
@@ -43,8 +44,36 @@ void PointerGraph::remove(PSNode *nd) {
 }
 
 void PointerGraph::initStaticNodes() {
+    // the static nodes are shared by all graphs (that may be created
+    // in different threads), so set them only if they are not set yet
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (NULLPTR->pointsTo.isSingleton() &&
+        NULLPTR->pointsTo.has(Pointer(NULLPTR, 0)) &&
+        UNKNOWN_MEMORY->pointsTo.isSingleton() &&
+        UNKNOWN_MEMORY->pointsTo.has(UnknownPointer) &&
+        INVALIDATED->pointsTo.empty())
+        return;
+
+    // the static nodes outlive the graphs and the threads, so they must
+    // use neither the pointer IDs of the graph nor the default table
+    // of this thread. They have a few pointers, so the table is never
+    // released (the static nodes may be destroyed at exit after it).
+    // The sets are read by the analyses of all graphs (of any
+    // representation), so they use a representation that can be read
+    // by more threads.
+    static auto *staticIDs = [] {
+        auto *table = new PointerIDLookupTable();
+        table->setSetKind(PointsToSetKind::pointerId);
+        return table;
+    }();
+    PointerIDLookupTable::Scope scope(staticIDs);
+
+    // the cleared sets get the representation of the table
     NULLPTR->pointsTo.clear();
     UNKNOWN_MEMORY->pointsTo.clear();
+    INVALIDATED->pointsTo.clear();
     NULLPTR->pointsTo.add(Pointer(NULLPTR, 0));
     UNKNOWN_MEMORY->pointsTo.add(Pointer(UNKNOWN_MEMORY, Offset::UNKNOWN));
 }
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 #include "dg/PointerAnalysis/PointerGraphOptimizations.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
 
@@ -131,6 +135,244 @@ void PSEquivalentNodesMerger::merge(PSNode *node1, PSNode *node2) {
     ++merged_nodes_num;
 }
 
+namespace {
+// the value of a node for value numbering: the type of the node,
+// an additional value (an offset) and the value numbers of operands
+struct VNKey {
+    PSNodeType type;
+    uint64_t aux;
+    std::vector<unsigned> operands;
+
+    bool operator==(const VNKey &rhs) const {
+        return type == rhs.type && aux == rhs.aux && operands == rhs.operands;
+    }
+};
+
+struct VNKeyHash {
+    size_t operator()(const VNKey &key) const {
+        size_t hash = std::hash<unsigned>()(static_cast<unsigned>(key.type));
+        hash = hash * 31 + std::hash<uint64_t>()(key.aux);
+        for (unsigned op : key.operands)
+            hash = hash * 31 + op;
+        return hash;
+    }
+};
+} // anonymous namespace
+
+// the nodes that must not be removed: the global nodes (the analysis
+// keeps a list of them) and the arguments of functions, which get
+// new operands when a new call of the function is found.
+// The arguments are the PHI nodes that follow the root of a subgraph.
+static std::vector<bool> getFixedNodes(PointerGraph *G) {
+    std::vector<bool> fixed(G->getNodes().size(), false);
+    for (PSNode *glob : G->getGlobals())
+        fixed[glob->getID()] = true;
+
+    for (const auto &subg : G->getSubgraphs()) {
+        if (subg->vararg)
+            fixed[subg->vararg->getID()] = true;
+        if (!subg->root)
+            continue;
+
+        PSNode *cur = subg->root;
+        while (cur->successorsNum() == 1) {
+            cur = cur->getSingleSuccessor();
+            if (cur->getType() != PSNodeType::PHI || fixed[cur->getID()])
+                break;
+            fixed[cur->getID()] = true;
+        }
+    }
+
+    return fixed;
+}
+
+static bool isSubstitutable(const PSNode *nd) {
+    switch (nd->getType()) {
+    case PSNodeType::CAST:
+    case PSNodeType::GEP:
+    case PSNodeType::LOAD:
+    case PSNodeType::CONSTANT:
+        return true;
+    case PSNodeType::PHI:
+        return nd->getOperandsNum() > 0;
+    default:
+        return false;
+    }
+}
+
+unsigned PSVariableSubstitution::run() {
+    const auto size = G->getNodes().size();
+    auto fixed = getFixedNodes(G);
+
+    std::vector<bool> substitutable(size, false);
+    for (const auto &nd : G->getNodes()) {
+        if (nd && !fixed[nd->getID()] && isSubstitutable(nd.get()))
+            substitutable[nd->getID()] = true;
+    }
+
+    // The value numbers of nodes (0 is 'not numbered yet').
+    // The nodes that are not substitutable have unique value numbers
+    // (their IDs), value numbers of expressions start at 'size'.
+    std::vector<unsigned> number(size, 0);
+    // a node with the given value number
+    std::vector<PSNode *> representant(size, nullptr);
+    std::unordered_map<VNKey, unsigned, VNKeyHash> numbers;
+
+    auto getNumber = [&](PSNode *nd) -> unsigned {
+        auto id = nd->getID();
+        if (substitutable[id]) {
+            assert(number[id] != 0 && "Operand was not numbered yet");
+            return number[id];
+        }
+        representant[id] = nd;
+        return id;
+    };
+
+    auto getExprNumber = [&](VNKey &&key, PSNode *nd) -> unsigned {
+        auto it = numbers.find(key);
+        if (it != numbers.end())
+            return it->second;
+        unsigned num = representant.size();
+        representant.push_back(nd);
+        numbers.emplace(std::move(key), num);
+        return num;
+    };
+
+    auto computeNumber = [&](PSNode *nd) -> unsigned {
+        switch (nd->getType()) {
+        case PSNodeType::CAST:
+            return getNumber(nd->getOperand(0));
+        case PSNodeType::GEP: {
+            PSNodeGep *GEP = PSNodeGep::get(nd);
+            if (GEP->getOffset().isZero())
+                return getNumber(GEP->getSource());
+            return getExprNumber({PSNodeType::GEP, *GEP->getOffset(),
+                                  {getNumber(GEP->getSource())}},
+                                 nd);
+        }
+        case PSNodeType::LOAD:
+            return getExprNumber(
+                    {PSNodeType::LOAD, 0, {getNumber(nd->getOperand(0))}}, nd);
+        case PSNodeType::CONSTANT: {
+            // the target is not a value, do not use its value number
+            PSNodeConstant *C = PSNodeConstant::get(nd);
+            return getExprNumber({PSNodeType::CONSTANT, *C->getOffset(),
+                                  {C->getTarget()->getID()}},
+                                 nd);
+        }
+        case PSNodeType::PHI: {
+            std::vector<unsigned> ops;
+            ops.reserve(nd->getOperandsNum());
+            for (PSNode *op : nd->getOperands())
+                ops.push_back(getNumber(op));
+            std::sort(ops.begin(), ops.end());
+            ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+            if (ops.size() == 1)
+                return ops[0];
+            return getExprNumber({PSNodeType::PHI, 0, std::move(ops)}, nd);
+        }
+        default:
+            abort();
+        }
+    };
+
+    // Number the nodes in the topological order of operands edges:
+    // a node is numbered once all its substitutable operands are numbered.
+    // The nodes on cycles get unique value numbers.
+    std::vector<unsigned> pending(size, 0);
+    std::vector<PSNode *> ready;
+    for (const auto &nd : G->getNodes()) {
+        if (!nd || !substitutable[nd->getID()])
+            continue;
+        // the target of a constant is not an operand for value numbering
+        if (nd->getType() != PSNodeType::CONSTANT) {
+            std::vector<PSNode *> ops = nd->getOperands();
+            std::sort(ops.begin(), ops.end());
+            ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+            for (PSNode *op : ops) {
+                if (substitutable[op->getID()])
+                    ++pending[nd->getID()];
+            }
+        }
+        if (pending[nd->getID()] == 0)
+            ready.push_back(nd.get());
+    }
+
+    auto setNumber = [&](PSNode *nd, unsigned num) {
+        number[nd->getID()] = num;
+        for (PSNode *user : nd->getUsers()) {
+            auto id = user->getID();
+            if (substitutable[id] && number[id] == 0 &&
+                user->getType() != PSNodeType::CONSTANT &&
+                --pending[id] == 0)
+                ready.push_back(user);
+        }
+    };
+
+    size_t next = 0;
+    while (true) {
+        while (!ready.empty()) {
+            PSNode *nd = ready.back();
+            ready.pop_back();
+            setNumber(nd, computeNumber(nd));
+        }
+
+        // break a cycle, if there is any
+        while (next < size && (!substitutable[next] || number[next] != 0))
+            ++next;
+        if (next == size)
+            break;
+
+        PSNode *nd = G->getNodes()[next].get();
+        representant[next] = nd;
+        setNumber(nd, next);
+    }
+
+    // keep the first node with the value number of an expression
+    // (so that the result does not depend on the order of numbering)
+    std::fill(representant.begin() + size, representant.end(), nullptr);
+
+    for (const auto &nodeptr : G->getNodes()) {
+        if (!nodeptr || !substitutable[nodeptr->getID()])
+            continue;
+
+        PSNode *nd = nodeptr.get();
+        PSNode *&repr = representant[number[nd->getID()]];
+        if (!repr)
+            repr = nd;
+        else if (repr != nd)
+            merge(nd, repr);
+    }
+
+    return merged_nodes_num;
+}
+
+void PSVariableSubstitution::merge(PSNode *node, PSNode *repr) {
+    // do not remove duplicate operands in general
+    // (e.g., a store of a pointer to itself), only in PHI nodes
+    auto users = node->getUsers();
+    node->replaceAllUsesWith(repr, /* removeDupl = */ false);
+    for (PSNode *user : users) {
+        if (user->getType() != PSNodeType::PHI)
+            continue;
+
+        std::vector<PSNode *> ops;
+        for (PSNode *op : user->getOperands()) {
+            if (std::find(ops.begin(), ops.end(), op) == ops.end())
+                ops.push_back(op);
+        }
+        if (ops.size() != user->getOperandsNum()) {
+            user->removeAllOperands();
+            for (PSNode *op : ops)
+                user->addOperand(op);
+        }
+    }
+
+    removeNode(G, node);
+    mapping.add(node, repr);
+    ++merged_nodes_num;
+}
+
 unsigned PSNoopRemover::run() {
     unsigned removed = 0;
     for (const auto &nd : G->getNodes()) {
@@ -15,11 +15,31 @@ std::vector<PSNode *> SmallOffsetsPointsToSet::idVector;
 std::vector<PSNode *> AlignedSmallOffsetsPointsToSet::idVector;
 std::vector<Pointer> AlignedPointerIdPointsToSet::idVector;
 std::map<PSNode *, size_t> SeparateOffsetsPointsToSet::ids;
-dg::PointerIDLookupTable PointerIdPointsToSet::lookupTable;
 std::map<PSNode *, size_t> SmallOffsetsPointsToSet::ids;
 std::map<PSNode *, size_t> AlignedSmallOffsetsPointsToSet::ids;
 std::map<Pointer, size_t> AlignedPointerIdPointsToSet::ids;
 
+// create the storage on the first use, so that it is initialized
+// even when used during the initialization of other static objects.
+// It is never destroyed, so that the sets in static objects
+// can be safely destroyed at exit.
+SharedPointsToSet::Storage &SharedPointsToSet::storage() {
+    static auto *storage = new Storage();
+    return *storage;
+}
+
 } // namespace pta
 
+thread_local PointerIDLookupTable *PointerIDLookupTable::_current = nullptr;
+std::atomic<bool> PointerIDLookupTable::_otherSetKinds{false};
+
+PointerIDLookupTable &PointerIDLookupTable::getDefault() {
+    static thread_local PointerIDLookupTable table;
+    return table;
+}
+
+unsigned PointerIDLookupTable::getNodeID(const PSNode *node) {
+    return node->getID();
+}
+
 } // namespace dg
@@ -9,6 +9,7 @@
 #include <set>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <dg/util/SilenceLLVMWarnings.h>
 SILENCE_LLVM_WARNINGS_PUSH
@@ -1093,48 +1094,90 @@ void LLVMDependenceGraph::computeCriticalSections(
     }
 }
 
-void LLVMDependenceGraph::computeInterferenceDependentEdges(
-        const std::set<const llvm::Instruction *> &loads,
-        const std::set<const llvm::Instruction *> &stores) {
-    for (const auto &load : loads) {
-        auto *loadInst = const_cast<llvm::Instruction *>(load);
-        auto loadFunction = constructedFunctions.find(
-                const_cast<llvm::Function *>(load->getParent()->getParent()));
-        if (loadFunction == constructedFunctions.end())
-            continue;
-        auto loadNode = loadFunction->second->findNode(loadInst);
-        if (!loadNode)
-            continue;
+// find the node of the instruction in the constructed functions
+static LLVMNode *findConstructedNode(const llvm::Instruction *inst) {
+    auto it = constructedFunctions.find(
+            const_cast<llvm::Function *>(inst->getParent()->getParent()));
+    if (it == constructedFunctions.end())
+        return nullptr;
+    return it->second->findNode(const_cast<llvm::Instruction *>(inst));
+}
 
-        for (const auto &store : stores) {
-            auto *storeInst = const_cast<llvm::Instruction *>(store);
-            auto storeFunction =
-                    constructedFunctions.find(const_cast<llvm::Function *>(
-                            store->getParent()->getParent()));
-            if (storeFunction == constructedFunctions.end())
-                continue;
-            auto storeNode = storeFunction->second->findNode(storeInst);
-            if (!storeNode)
+template <typename PointsToSetT>
+static void addInterferenceDependences(
+        const std::vector<LLVMNode *> &loadNodes,
+        const std::vector<PointsToSetT> &loadPts,
+        const std::vector<LLVMNode *> &storeNodes,
+        const std::vector<PointsToSetT> &storePts) {
+    for (size_t l = 0; l < loadNodes.size(); ++l) {
+        for (size_t s = 0; s < storeNodes.size(); ++s) {
+            // handle the unknown pointer
+            if (loadPts[l].hasUnknown() || storePts[s].hasUnknown()) {
+                storeNodes[s]->addInterferenceDependence(loadNodes[l]);
                 continue;
+            }
 
-            auto loadPts = PTA->getLLVMPointsTo(load->getOperand(0));
-            auto storePts = PTA->getLLVMPointsTo(store->getOperand(1));
-            for (const auto &pointerLoad : loadPts) {
-                for (const auto &pointerStore : storePts) {
+            for (const auto &pointerLoad : loadPts[l]) {
+                for (const auto &pointerStore : storePts[s]) {
                     if (pointerLoad.value == pointerStore.value &&
                         (pointerLoad.offset.isUnknown() ||
                          pointerStore.offset.isUnknown() ||
                          pointerLoad.offset == pointerStore.offset)) {
-                        storeNode->addInterferenceDependence(loadNode);
+                        storeNodes[s]->addInterferenceDependence(
+                                loadNodes[l]);
                     }
                 }
             }
+        }
+    }
+}
 
-            // handle the unknown pointer
-            if (loadPts.hasUnknown() || storePts.hasUnknown())
-                storeNode->addInterferenceDependence(loadNode);
+void LLVMDependenceGraph::computeInterferenceDependentEdges(
+        const std::set<const llvm::Instruction *> &loads,
+        const std::set<const llvm::Instruction *> &stores) {
+    // look up the nodes and the pointers only once, not for every pair
+    std::vector<LLVMNode *> loadNodes;
+    std::vector<const llvm::Value *> loadPtrs;
+    for (const auto &load : loads) {
+        if (auto *loadNode = findConstructedNode(load)) {
+            loadNodes.push_back(loadNode);
+            loadPtrs.push_back(load->getOperand(0));
+        }
+    }
+
+    std::vector<LLVMNode *> storeNodes;
+    std::vector<const llvm::Value *> storePtrs;
+    for (const auto &store : stores) {
+        if (auto *storeNode = findConstructedNode(store)) {
+            storeNodes.push_back(storeNode);
+            storePtrs.push_back(store->getOperand(1));
         }
     }
+
+    if (loadNodes.empty() || storeNodes.empty())
+        return;
+
+    if (!PTA->getOptions().isSVF()) {
+        // DG's analysis can answer all the queries at once and
+        // without allocating the points-to sets
+        auto *DGPTA = static_cast<DGLLVMPointerAnalysis *>(PTA);
+        std::vector<LLVMPointsToView> loadPts(loadPtrs.size());
+        std::vector<LLVMPointsToView> storePts(storePtrs.size());
+        DGPTA->getLLVMPointsToViews(loadPtrs.data(), loadPtrs.size(),
+                                    loadPts.data());
+        DGPTA->getLLVMPointsToViews(storePtrs.data(), storePtrs.size(),
+                                    storePts.data());
+        addInterferenceDependences(loadNodes, loadPts, storeNodes, storePts);
+        return;
+    }
+
+    std::vector<LLVMPointsToSet> loadPts;
+    std::vector<LLVMPointsToSet> storePts;
+    for (const auto *ptr : loadPtrs)
+        loadPts.push_back(PTA->getLLVMPointsTo(ptr));
+    for (const auto *ptr : storePtrs)
+        storePts.push_back(PTA->getLLVMPointsTo(ptr));
+    addInterferenceDependences(loadNodes, loadPts, storeNodes, storePts);
 }
 
 std::set<const llvm::Instruction *> LLVMDependenceGraph::getLoadInstructions(
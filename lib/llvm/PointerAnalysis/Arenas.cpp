@@ -0,0 +1,212 @@
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <dg/util/SilenceLLVMWarnings.h>
+SILENCE_LLVM_WARNINGS_PUSH
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+SILENCE_LLVM_WARNINGS_POP
+
+#include "dg/PointerAnalysis/PointsToSet.h"
+#include "dg/llvm/PointerAnalysis/PointerGraph.h"
+
+#include "dg/util/ThreadPool.h"
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace pta {
+
+// the arena gets the options of the builder and its own copy
+// of the data layout, the rest is built from scratch
+LLVMPointerGraphBuilder::LLVMPointerGraphBuilder(
+        const LLVMPointerGraphBuilder *shared)
+        : M(shared->M), _options(shared->_options),
+          invalidate_nodes(shared->invalidate_nodes),
+          threads_(shared->threads_), _shared(shared),
+          _dataLayout(new llvm::DataLayout(shared->M->getDataLayout())) {
+    PS.setPointsToSetKind(_options.pointsToSet);
+}
+
+bool LLVMPointerGraphBuilder::canBuildInParallel() const {
+    // the subgraphs of spawned threads are built while building
+    // the call of pthread_create (see createForkNode()) and some
+    // representations of points-to sets use global tables without locking
+    return _options.buildThreads > 1 && !threads_ &&
+           isThreadSafe(PS.getPointsToSetKind());
+}
+
+PSNode *LLVMPointerGraphBuilder::getPlaceholder(const llvm::Value *val,
+                                                PSNode *special) {
+    assert(_shared && "Placeholders are only in arenas");
+    const void *key = val ? static_cast<const void *>(val) : special;
+    auto it = _placeholders.find(key);
+    if (it != _placeholders.end())
+        return it->second;
+
+    recordEvent(ArenaEvent::Kind::placeholder, val, val ? nullptr : special);
+    PSNode *nd = PS.create<PSNodeType::NOOP>();
+    _placeholders.emplace(key, nd);
+    return nd;
+}
+
+// Get the operand for the constant 'val' in an arena. The nodes of globals,
+// functions and constant expressions are shared by all functions, so they
+// are created in the graph when the placeholder is resolved.
+PSNode *LLVMPointerGraphBuilder::getArenaConstant(const llvm::Value *val) {
+    if (_shared->nodes_map.count(val) > 0 ||
+        llvm::isa<llvm::ConstantExpr>(val) || llvm::isa<llvm::Function>(val))
+        return getPlaceholder(val, nullptr);
+
+    // other constants are the special nodes, getConstant() creates nothing
+    PSNode *nd = getConstant(val);
+    return nd ? special(nd) : nullptr;
+}
+
+void LLVMPointerGraphBuilder::buildInArena(const llvm::Function &F,
+                                           ArenaFunction &fun) {
+    // some nodes get pointers outside of PointerGraph::create(),
+    // those must also use the pointer IDs of the arena
+    PointerIDLookupTable::Scope scope(&PS.getPointerIDs());
+
+    fun.arena = this;
+    fun.begin = PS.getNodes().size();
+    _events = &fun.events;
+    _placeholders.clear();
+
+    buildFunction(F);
+
+    _events = nullptr;
+    fun.end = PS.getNodes().size();
+}
+
+void LLVMPointerGraphBuilder::buildFunctionsInParallel(
+        const llvm::Function *entry) {
+    DBG_SECTION_BEGIN(pta, "building functions in "
+                                   << _options.buildThreads << " threads");
+
+    std::vector<std::unique_ptr<LLVMPointerGraphBuilder>> arenas;
+    arenas.reserve(_options.buildThreads);
+    for (unsigned i = 0; i < _options.buildThreads; ++i)
+        arenas.emplace_back(new LLVMPointerGraphBuilder(this));
+
+    // build the functions level by level, the functions called
+    // from one level are built in the next level
+    std::unordered_map<const llvm::Function *, ArenaFunction> functions;
+    std::vector<const llvm::Function *> level{entry};
+    functions[entry];
+
+    ThreadPool pool(_options.buildThreads);
+    while (!level.empty()) {
+        std::atomic<size_t> next{0};
+        pool.parallelFor(
+                arenas.size(),
+                [&](size_t i) {
+                    size_t idx;
+                    while ((idx = next++) < level.size()) {
+                        const llvm::Function *F = level[idx];
+                        arenas[i]->buildInArena(*F, functions.find(F)->second);
+                    }
+                },
+                /* chunk = */ 1);
+
+        std::vector<const llvm::Function *> called;
+        for (const llvm::Function *F : level) {
+            for (const auto &ev : functions[F].events) {
+                if (ev.kind == ArenaEvent::Kind::call &&
+                    functions.emplace(ev.function, ArenaFunction()).second)
+                    called.push_back(ev.function);
+            }
+        }
+        level.swap(called);
+    }
+
+    DBG(pta, "Built " << functions.size() << " functions");
+
+    // move the nodes into the graph, the subgraphs of called functions
+    // are moved in createOrGetSubgraph() like they are built serially
+    _arenaFunctions = &functions;
+    adoptFunction(*entry);
+    _arenaFunctions = nullptr;
+
+    DBG_SECTION_END(pta, "building functions in parallel done");
+}
+
+PointerSubgraph &
+LLVMPointerGraphBuilder::adoptFunction(const llvm::Function &F) {
+    assert(!getSubgraph(&F) && "We already built this function");
+    auto fit = _arenaFunctions->find(&F);
+    assert(fit != _arenaFunctions->end() && "Did not build the function");
+    ArenaFunction &fun = fit->second;
+    LLVMPointerGraphBuilder *arena = fun.arena;
+
+    PointerSubgraph *subg = PS.adopt(arena->PS, arena->getSubgraph(&F));
+    subgraphs_map[&F] = subg;
+
+    // the nodes that replaced the placeholders
+    std::unordered_map<PSNode *, PSNode *> resolved;
+    auto target = [&resolved](PSNode *nd) {
+        auto it = resolved.find(nd);
+        return it == resolved.end() ? nd : it->second;
+    };
+    // the new places of the sequences of nodes
+    std::unordered_map<const PSNodesSeq *, PSNodesSeq *> moved;
+
+    const auto &nodes = arena->PS.getNodes();
+    size_t next = fun.begin;
+    auto adoptUntil = [&](size_t end) {
+        for (; next < end; ++next)
+            PS.adopt(arena->PS, nodes[next].get(), target);
+    };
+
+    for (const auto &ev : fun.events) {
+        adoptUntil(ev.position);
+
+        switch (ev.kind) {
+        case ArenaEvent::Kind::placeholder: {
+            assert(next == ev.position);
+            PSNode *placeholder = nodes[next++].get();
+            // this creates the node for a constant if it was not
+            // created before, just like the serial building does
+            PSNode *nd = ev.value ? getOperand(ev.value) : ev.node;
+            placeholder->replaceAllUsesWith(nd, /* removeDupl = */ false);
+            resolved[placeholder] = nd;
+            break;
+        }
+        case ArenaEvent::Kind::mapped: {
+            auto it = arena->nodes_map.find(ev.value);
+            assert(it != arena->nodes_map.end());
+            auto res = nodes_map.emplace(ev.value, std::move(it->second));
+            assert(res.second && "Mapped a value twice");
+            moved[&it->second] = &res.first->second;
+            break;
+        }
+        case ArenaEvent::Kind::call:
+            getAndConnectSubgraph(ev.function,
+                                  llvm::cast<llvm::CallInst>(ev.value),
+                                  ev.node);
+            break;
+        }
+    }
+    adoptUntil(fun.end);
+
+    // the blocks refer to the sequences in nodes_map
+    auto &finfo = _funcInfo[&F];
+    finfo.llvmBlocks = std::move(arena->_funcInfo[&F].llvmBlocks);
+    for (auto &it : finfo.llvmBlocks) {
+        for (auto &seq : it.second) {
+            assert(moved.count(seq) > 0 && "Did not move a sequence");
+            seq = moved[seq];
+        }
+    }
+
+    return *subg;
+}
+
+} // namespace pta
+} // namespace dg
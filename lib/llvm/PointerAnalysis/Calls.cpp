@@ -99,6 +99,8 @@ PSNode *LLVMPointerGraphBuilder::createUnknownCall() {
     call->setPairedNode(call);
 
     // the only thing that the node will point at
+    // (with the pointer IDs of the graph, not of this thread)
+    PointerIDLookupTable::Scope scope(&PS.getPointerIDs());
     call->addPointsTo(UnknownPointer);
 
     return call;
@@ -134,11 +136,11 @@ LLVMPointerGraphBuilder::createMemSet(const llvm::Instruction *Inst) {
     PSNode *val;
     if (llvmutils::memsetIsZeroInitialization(
                 llvm::cast<llvm::IntrinsicInst>(Inst)))
-        val = NULLPTR;
+        val = special(NULLPTR);
     else
         // if the memset is not 0-initialized, it does some
         // garbage into the pointer
-        val = UNKNOWN_MEMORY;
+        val = special(UNKNOWN_MEMORY);
 
     PSNode *op = getOperand(Inst->getOperand(0)->stripInBoundsOffsets());
     // we need to make unknown offsets
@@ -249,8 +251,8 @@ LLVMPointerGraphBuilder::createAsm(const llvm::Instruction *Inst) {
         warned = true;
     }
 
-    PSNode *n =
-            PS.create<PSNodeType::CONSTANT>(UNKNOWN_MEMORY, Offset::UNKNOWN);
+    PSNode *n = PS.create<PSNodeType::CONSTANT>(special(UNKNOWN_MEMORY),
+                                                Offset::UNKNOWN);
     // it is call that returns pointer, so we'd like to have
     // a 'return' node that contains that pointer
     n->setPairedNode(n);
@@ -139,11 +139,11 @@ LLVMPointerGraphBuilder::handleConstantGep(const llvm::GetElementPtrInst *GEP) {
            "Constant node has more that 1 pointer");
     pointer = *(opNode->pointsTo.begin());
 
-    unsigned bitwidth = llvmutils::getPointerBitwidth(&M->getDataLayout(), op);
+    unsigned bitwidth = llvmutils::getPointerBitwidth(&getDataLayout(), op);
     APInt offset(bitwidth, 0);
 
     // get offset of this GEP
-    if (GEP->accumulateConstantOffset(M->getDataLayout(), offset)) {
+    if (GEP->accumulateConstantOffset(getDataLayout(), offset)) {
         if (offset.isIntN(bitwidth) && !pointer.offset.isUnknown())
             pointer.offset = offset.getZExtValue();
         else
@@ -222,8 +222,8 @@ LLVMPointerGraphBuilder::createUnknown(const llvm::Value *val) {
     // completely change the value of pointer...
 
     // FIXME: or there's enough unknown offset? Check it out!
-    PSNode *node =
-            PS.create<PSNodeType::CONSTANT>(UNKNOWN_MEMORY, Offset::UNKNOWN);
+    PSNode *node = PS.create<PSNodeType::CONSTANT>(special(UNKNOWN_MEMORY),
+                                                   Offset::UNKNOWN);
     assert(node);
 
     return addNode(val, node);
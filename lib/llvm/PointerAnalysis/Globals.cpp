@@ -37,7 +37,7 @@ void LLVMPointerGraphBuilder::handleGlobalVariableInitializer(
     } else if (C->getType()->isStructTy()) {
         uint64_t off = 0;
         auto STy = cast<StructType>(C->getType());
-        const StructLayout *SL = M->getDataLayout().getStructLayout(STy);
+        const StructLayout *SL = getDataLayout().getStructLayout(STy);
         int i = 0;
         for (auto I = C->op_begin(), E = C->op_end(); I != E; ++I, ++i) {
             const Constant *op = cast<Constant>(*I);
@@ -52,7 +52,7 @@ void LLVMPointerGraphBuilder::handleGlobalVariableInitializer(
             Type *Ty = op->getType();
             // recursively dive into the aggregate type
             handleGlobalVariableInitializer(op, node, offset + off);
-            off += M->getDataLayout().getTypeAllocSize(Ty);
+            off += getDataLayout().getTypeAllocSize(Ty);
         }
     } else if (C->getType()->isPointerTy()) {
         PSNode *op = getOperand(C);
@@ -105,7 +105,7 @@ void LLVMPointerGraphBuilder::buildGlobals() {
 
         // handle globals initialization
         if (const auto GV = llvm::dyn_cast<llvm::GlobalVariable>(&*I)) {
-            node->setSize(getAllocatedSize(GV, &M->getDataLayout()));
+            node->setSize(getAllocatedSize(GV, &getDataLayout()));
 
             if (GV->hasInitializer() && !GV->isExternallyInitialized()) {
                 const llvm::Constant *C = GV->getInitializer();
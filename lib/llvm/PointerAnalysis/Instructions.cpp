@@ -10,7 +10,7 @@ LLVMPointerGraphBuilder::createAlloc(const llvm::Instruction *Inst) {
 
     const llvm::AllocaInst *AI = llvm::dyn_cast<llvm::AllocaInst>(Inst);
     if (AI)
-        node->setSize(llvmutils::getAllocatedSize(AI, &M->getDataLayout()));
+        node->setSize(llvmutils::getAllocatedSize(AI, &getDataLayout()));
 
     return addNode(Inst, node);
 }
@@ -25,7 +25,7 @@ LLVMPointerGraphBuilder::createStore(const llvm::Instruction *Inst) {
         // we store the old value of AtomicRMW
         auto it = nodes_map.find(valOp);
         if (it == nodes_map.end()) {
-            op1 = UNKNOWN_MEMORY;
+            op1 = special(UNKNOWN_MEMORY);
         } else {
             op1 = it->second.getFirst();
             assert(op1->getType() == PSNodeType::LOAD &&
@@ -65,14 +65,14 @@ LLVMPointerGraphBuilder::createGEP(const llvm::Instruction *Inst) {
     const GetElementPtrInst *GEP = cast<GetElementPtrInst>(Inst);
     const Value *ptrOp = GEP->getPointerOperand();
     unsigned bitwidth =
-            llvmutils::getPointerBitwidth(&M->getDataLayout(), ptrOp);
+            llvmutils::getPointerBitwidth(&getDataLayout(), ptrOp);
     APInt offset(bitwidth, 0);
 
     PSNode *node = nullptr;
     PSNode *op = getOperand(ptrOp);
 
     if (*_options.fieldSensitivity > 0 &&
-        GEP->accumulateConstantOffset(M->getDataLayout(), offset)) {
+        GEP->accumulateConstantOffset(getDataLayout(), offset)) {
         // is offset in given bitwidth?
         if (offset.isIntN(bitwidth)) {
             // is 0 < offset < field_sensitivity ?
@@ -160,7 +160,7 @@ LLVMPointerGraphBuilder::createExtract(const llvm::Instruction *Inst) {
     // extract <agg> <idx> {<idx>, ...}
     PSNode *op1 = getOperand(EI->getAggregateOperand());
     PSNode *G = PS.create<PSNodeType::GEP>(
-            op1, accumulateEVOffsets(EI, M->getDataLayout()));
+            op1, accumulateEVOffsets(EI, getDataLayout()));
     PSNode *L = PS.create<PSNodeType::LOAD>(G);
 
     // FIXME: add this later with all edges
@@ -216,7 +216,7 @@ LLVMPointerGraphBuilder::createIntToPtr(const llvm::Instruction *Inst) {
                      << "\n";
         // if this is inttoptr with constant, just make the pointer
         // unknown
-        op1 = UNKNOWN_MEMORY;
+        op1 = special(UNKNOWN_MEMORY);
     } else
         op1 = getOperand(op);
 
@@ -323,7 +323,7 @@ LLVMPointerGraphBuilder::createReturn(const llvm::Instruction *Inst) {
                 llvm::errs()
                         << "WARN: Unsupported return of an aggregate type\n";
                 llvm::errs() << *Inst << "\n";
-                op1 = UNKNOWN_MEMORY;
+                op1 = special(UNKNOWN_MEMORY);
             }
         } else if (retVal->getType()->isVectorTy()) {
             op1 = getOperand(retVal);
@@ -333,14 +333,14 @@ LLVMPointerGraphBuilder::createReturn(const llvm::Instruction *Inst) {
             } else {
                 llvm::errs() << "WARN: Unsupported return of a vector\n";
                 llvm::errs() << *Inst << "\n";
-                op1 = UNKNOWN_MEMORY;
+                op1 = special(UNKNOWN_MEMORY);
             }
         }
 
         if (llvm::isa<llvm::ConstantPointerNull>(retVal) ||
             llvmutils::isConstantZero(retVal))
-            op1 = NULLPTR;
-        else if (llvmutils::typeCanBePointer(&M->getDataLayout(),
+            op1 = special(NULLPTR);
+        else if (llvmutils::typeCanBePointer(&getDataLayout(),
                                              retVal->getType()) &&
                  (!isInvalid(retVal->stripPointerCasts(), invalidate_nodes) ||
                   llvm::isa<llvm::ConstantExpr>(retVal) ||
@@ -398,9 +398,9 @@ LLVMPointerGraphBuilder::createInsertElement(const llvm::Instruction *Inst) {
 
     auto Ty = llvm::cast<llvm::InsertElementInst>(Inst)->getType();
     auto elemSize = llvmutils::getAllocatedSize(Ty->getContainedType(0),
-                                                &M->getDataLayout());
+                                                &getDataLayout());
     // also, set the size of the temporary allocation
-    tempAlloc->setSize(llvmutils::getAllocatedSize(Ty, &M->getDataLayout()));
+    tempAlloc->setSize(llvmutils::getAllocatedSize(Ty, &getDataLayout()));
 
     auto GEP = PS.create<PSNodeType::GEP>(tempAlloc, elemSize * idx);
     auto S = PS.create<PSNodeType::STORE>(ptr, GEP);
@@ -429,7 +429,7 @@ LLVMPointerGraphBuilder::createExtractElement(const llvm::Instruction *Inst) {
     auto Ty =
             llvm::cast<llvm::ExtractElementInst>(Inst)->getVectorOperandType();
     auto elemSize = llvmutils::getAllocatedSize(Ty->getContainedType(0),
-                                                &M->getDataLayout());
+                                                &getDataLayout());
 
     auto GEP = PS.create<PSNodeType::GEP>(op, elemSize * idx);
     auto L = PS.create<PSNodeType::LOAD>(GEP);
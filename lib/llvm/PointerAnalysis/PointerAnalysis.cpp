@@ -1,6 +1,10 @@
+#include <ostream>
+#include <string>
+
 #include <dg/util/SilenceLLVMWarnings.h>
 SILENCE_LLVM_WARNINGS_PUSH
 #include <llvm/IR/Instruction.h>
+#include <llvm/Support/raw_ostream.h>
 SILENCE_LLVM_WARNINGS_POP
 
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
@@ -113,4 +117,32 @@ LLVMPointerAnalysis::getAccessedMemory(const llvm::Instruction *I) {
     return {PTSet.hasUnknown(), regions};
 }
 
+// describe the node by the LLVM value that it was created for
+static std::string describeNode(const PSNode *node) {
+    const auto *val = node->getUserData<llvm::Value>();
+    if (!val)
+        return "";
+
+    std::string str;
+    llvm::raw_string_ostream ostr(str);
+    if (const auto *F = llvm::dyn_cast<llvm::Function>(val)) {
+        ostr << "fun '" << F->getName() << "'";
+    } else {
+        if (const auto *I = llvm::dyn_cast<llvm::Instruction>(val))
+            ostr << I->getParent()->getParent()->getName() << "::";
+        else if (const auto *A = llvm::dyn_cast<llvm::Argument>(val))
+            ostr << A->getParent()->getName() << "::";
+        ostr << *val;
+    }
+    return ostr.str();
+}
+
+bool DGLLVMPointerAnalysis::dumpProfile(std::ostream &os, unsigned top) const {
+    if (!PTA || !PTA->getProfile())
+        return false;
+
+    PTA->getProfile()->dumpJSON(os, PS, describeNode, top);
+    return true;
+}
+
 } // namespace dg
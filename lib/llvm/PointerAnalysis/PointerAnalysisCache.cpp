@@ -0,0 +1,325 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dg/util/SilenceLLVMWarnings.h>
+SILENCE_LLVM_WARNINGS_PUSH
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+SILENCE_LLVM_WARNINGS_POP
+
+#include "dg/PointerAnalysis/PointerAnalysis.h"
+#include "dg/PointerAnalysis/PointerGraph.h"
+#include "dg/llvm/PointerAnalysis/PointerAnalysisCache.h"
+#include "dg/llvm/PointerAnalysis/PointerGraph.h"
+
+namespace dg {
+namespace pta {
+
+///
+// The layout of the cache file (all numbers are in the native byte order):
+//
+//   CacheHeader
+//   CachedCall     calls[callsNum]
+//   uint64_t       offsets[nodesNum + 1]
+//   CachedPointer  pointers[pointersNum]
+//
+// The points-to set of the node with ID 'i' are the pointers
+// in the range [offsets[i], offsets[i + 1]).
+
+static const char cacheMagic[8] = {'D', 'G', 'P', 'T', 'A', 'C', 0, 0};
+// increment whenever the layout or the contents of the file change
+static const uint32_t cacheVersion = 1;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t moduleHash;
+    uint64_t optionsHash;
+    uint64_t nodesNum;
+    uint64_t callsNum;
+    uint64_t pointersNum;
+    // hash of everything that follows the header
+    uint64_t checksum;
+};
+
+struct CachedCall {
+    uint32_t callsite;
+    uint32_t called;
+};
+
+struct CachedPointer {
+    uint64_t target;
+    uint64_t offset;
+};
+
+static_assert(sizeof(CacheHeader) == 64, "Unexpected padding in the header");
+static_assert(sizeof(CachedCall) == 8, "Unexpected padding in the call");
+static_assert(sizeof(CachedPointer) == 16, "Unexpected padding in the pointer");
+
+// FNV-1a
+static const uint64_t hashInit = 14695981039346656037ULL;
+
+static uint64_t hashBytes(const void *data, size_t len,
+                          uint64_t hash = hashInit) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t hashString(const std::string &str) {
+    return hashBytes(str.data(), str.size());
+}
+
+static uint64_t hashModule(const llvm::Module *M) {
+    std::string str;
+    llvm::raw_string_ostream ostr(str);
+    M->print(ostr, nullptr);
+    return hashString(ostr.str());
+}
+
+// hash the options that may change the results of the analysis
+static uint64_t hashOptions(const LLVMPointerAnalysisOptions &opts) {
+    std::string str;
+    llvm::raw_string_ostream ostr(str);
+    ostr << cacheVersion << ";" << static_cast<int>(opts.analysisType) << ";"
+         << *opts.fieldSensitivity << ";" << opts.entryFunction << ";"
+         << opts.invalidateNodes << ";" << opts.preprocessGeps << ";"
+         << opts.maxIterations << ";" << opts.substituteVariables << ";"
+         << static_cast<int>(opts.pointsToSet) << ";"
+         << opts.maxObjectOffsets;
+    for (const auto &it : opts.allocationFunctions)
+        ostr << ";" << it.first << "=" << static_cast<int>(it.second);
+    return hashString(ostr.str());
+}
+
+LLVMPointerAnalysisCache::LLVMPointerAnalysisCache(
+        const std::string &dir, const llvm::Module *M,
+        const LLVMPointerAnalysisOptions &opts)
+        : _moduleHash(hashModule(M)), _optionsHash(hashOptions(opts)) {
+    char name[64];
+    snprintf(name, sizeof(name), "/%016llx-%016llx.ptacache",
+             static_cast<unsigned long long>(_moduleHash),
+             static_cast<unsigned long long>(_optionsHash));
+    _path = dir + name;
+}
+
+namespace {
+// read-only mapping of a file into memory
+class MappedFile {
+    void *_data{MAP_FAILED};
+    size_t _size{0};
+
+  public:
+    MappedFile(const std::string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            _size = st.st_size;
+            _data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (_data != MAP_FAILED)
+            munmap(_data, _size);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool valid() const { return _data != MAP_FAILED; }
+    const char *data() const { return static_cast<const char *>(_data); }
+    size_t size() const { return _size; }
+};
+} // anonymous namespace
+
+static PSNode *getTarget(const PointerGraph *PG, uint64_t id) {
+    switch (id) {
+    case PointerGraphReservedIDs::ID_UNKNOWN:
+        return UNKNOWN_MEMORY;
+    case PointerGraphReservedIDs::ID_NULL:
+        return NULLPTR;
+    case PointerGraphReservedIDs::ID_INVALIDATED:
+        return INVALIDATED;
+    default:
+        return id < PG->getNodes().size() ? PG->getNodes()[id].get() : nullptr;
+    }
+}
+
+// the graph does not correspond to the cached results even though
+// the hashes match, we cannot continue as the graph was already changed
+static void inconsistentCache(const std::string &path) {
+    llvm::errs() << "The cached results of pointer analysis " << path
+                 << " do not match the pointer graph, aborting\n";
+    abort();
+}
+
+bool LLVMPointerAnalysisCache::load(PointerAnalysis *PTA,
+                                    const LLVMPointerGraphBuilder *builder) {
+    MappedFile file(_path);
+    if (!file.valid() || file.size() < sizeof(CacheHeader))
+        return false;
+
+    CacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+        header.version != cacheVersion || header.moduleHash != _moduleHash ||
+        header.optionsHash != _optionsHash)
+        return false;
+
+    const char *calls = file.data() + sizeof(CacheHeader);
+    const char *offsets = calls + header.callsNum * sizeof(CachedCall);
+    const char *pointers = offsets + (header.nodesNum + 1) * sizeof(uint64_t);
+    if (header.nodesNum == 0 || header.nodesNum > UINT32_MAX ||
+        header.callsNum > file.size() || header.pointersNum > file.size() ||
+        pointers + header.pointersNum * sizeof(CachedPointer) !=
+                file.data() + file.size())
+        return false;
+
+    if (hashBytes(calls, file.size() - sizeof(CacheHeader)) != header.checksum)
+        return false;
+
+    PointerGraph *PG = PTA->getPG();
+    assert(PG->getNodes().size() <= header.nodesNum);
+    assert(builder->getInsertedFunctionCalls().empty() &&
+           "The graph was already changed by the analysis");
+    (void) builder;
+
+    // re-create the parts of the graph that were built
+    // during the analysis, in the same order
+    PTA->preprocess();
+    for (uint64_t i = 0; i < header.callsNum; ++i) {
+        CachedCall call;
+        memcpy(&call, calls + i * sizeof(CachedCall), sizeof(call));
+        PSNode *callsite = getTarget(PG, call.callsite);
+        PSNode *called = getTarget(PG, call.called);
+        if (!callsite || !called ||
+            callsite->getType() != PSNodeType::CALL_FUNCPTR ||
+            called->getType() != PSNodeType::FUNCTION)
+            inconsistentCache(_path);
+
+        PTA->functionPointerCall(callsite, called);
+    }
+
+    if (PG->getNodes().size() != header.nodesNum)
+        inconsistentCache(_path);
+
+    PointerIDLookupTable::Scope scope(&PG->getPointerIDs());
+
+    uint64_t begin;
+    memcpy(&begin, offsets, sizeof(begin));
+    for (uint64_t id = 0; id < header.nodesNum; ++id) {
+        uint64_t end;
+        memcpy(&end, offsets + (id + 1) * sizeof(uint64_t), sizeof(end));
+        if (end < begin || end > header.pointersNum)
+            inconsistentCache(_path);
+
+        PSNode *node = PG->getNodes()[id].get();
+        if (!node && begin != end)
+            inconsistentCache(_path);
+
+        for (uint64_t i = begin; i < end; ++i) {
+            CachedPointer ptr;
+            memcpy(&ptr, pointers + i * sizeof(CachedPointer), sizeof(ptr));
+            PSNode *target = getTarget(PG, ptr.target);
+            if (!target)
+                inconsistentCache(_path);
+            node->addPointsTo(target, Offset(ptr.offset));
+        }
+
+        begin = end;
+    }
+
+    return true;
+}
+
+bool LLVMPointerAnalysisCache::store(PointerAnalysis *PTA,
+                                     const LLVMPointerGraphBuilder *builder) {
+    PointerGraph *PG = PTA->getPG();
+    PointerIDLookupTable::Scope scope(&PG->getPointerIDs());
+
+    std::vector<CachedCall> calls;
+    for (const auto &it : builder->getInsertedFunctionCalls())
+        calls.push_back({it.first->getID(), it.second->getID()});
+
+    std::vector<uint64_t> offsets;
+    std::vector<CachedPointer> pointers;
+    offsets.reserve(PG->getNodes().size() + 1);
+    for (const auto &nd : PG->getNodes()) {
+        offsets.push_back(pointers.size());
+        if (!nd)
+            continue;
+
+        for (const Pointer &ptr : nd->pointsTo)
+            pointers.push_back({ptr.target->getID(), *ptr.offset});
+    }
+    offsets.push_back(pointers.size());
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.moduleHash = _moduleHash;
+    header.optionsHash = _optionsHash;
+    header.nodesNum = PG->getNodes().size();
+    header.callsNum = calls.size();
+    header.pointersNum = pointers.size();
+
+    uint64_t checksum = hashInit;
+    checksum = hashBytes(calls.data(), calls.size() * sizeof(CachedCall),
+                         checksum);
+    checksum = hashBytes(offsets.data(), offsets.size() * sizeof(uint64_t),
+                         checksum);
+    checksum = hashBytes(pointers.data(),
+                         pointers.size() * sizeof(CachedPointer), checksum);
+    header.checksum = checksum;
+
+    auto dir = _path.substr(0, _path.rfind('/'));
+    if (llvm::sys::fs::create_directories(dir))
+        return false;
+
+    // write to a temporary file and rename it, so that a concurrent
+    // run never sees a partially written file
+    auto tmpPath = _path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(calls.data()),
+                  calls.size() * sizeof(CachedCall));
+        out.write(reinterpret_cast<const char *>(offsets.data()),
+                  offsets.size() * sizeof(uint64_t));
+        out.write(reinterpret_cast<const char *>(pointers.data()),
+                  pointers.size() * sizeof(CachedPointer));
+        if (!out) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmpPath.c_str(), _path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace pta
+} // namespace dg
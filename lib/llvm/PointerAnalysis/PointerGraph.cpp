@@ -68,7 +68,7 @@ PSNode *LLVMPointerGraphBuilder::tryGetOperand(const llvm::Value *val) {
     // or some operand of intToPtr instruction (or related to that)
     if (!op) {
         if (llvm::isa<llvm::Constant>(val)) {
-            op = getConstant(val);
+            op = _shared ? getArenaConstant(val) : getConstant(val);
             if (!op) {
                 // unknown constant
                 llvm::errs() << "ERR: unhandled constant: " << *val << "\n";
@@ -96,7 +96,7 @@ PSNode *LLVMPointerGraphBuilder::getOperand(const llvm::Value *val) {
     PSNode *op = tryGetOperand(val);
     if (!op) {
         if (isInvalid(val, invalidate_nodes))
-            return UNKNOWN_MEMORY;
+            return special(UNKNOWN_MEMORY);
 
         llvm::errs() << "ERROR: missing value in graph: " << *val << "\n";
         abort();
@@ -131,7 +131,13 @@ LLVMPointerGraphBuilder::PSNodesSeq &
 LLVMPointerGraphBuilder::createCallToFunction(const llvm::CallInst *CInst,
                                               const llvm::Function *F) {
     PSNodeCall *callNode = PSNodeCall::get(PS.create<PSNodeType::CALL>());
-    auto &subg = getAndConnectSubgraph(F, CInst, callNode);
+    // arenas only record the call, the subgraph is connected
+    // when the nodes are moved into the graph
+    PointerSubgraph *subg = nullptr;
+    if (_shared)
+        recordEvent(ArenaEvent::Kind::call, CInst, callNode, F);
+    else
+        subg = &getAndConnectSubgraph(F, CInst, callNode);
 
     // the operands to the return node (which works as a phi node)
     // are going to be added when the subgraph is built
@@ -144,7 +150,7 @@ LLVMPointerGraphBuilder::createCallToFunction(const llvm::CallInst *CInst,
     // this must be after we created the CALL_RETURN node
     if (ad_hoc_building) {
         // add operands to arguments and return nodes
-        addInterproceduralOperands(F, subg, CInst, callNode);
+        addInterproceduralOperands(F, *subg, CInst, callNode);
     }
 
     PSNodesSeq seq({callNode, returnNode});
@@ -167,6 +173,8 @@ void LLVMPointerGraphBuilder::insertFunctionCall(PSNode *callsite,
     const llvm::CallInst *CI = callsite->getUserData<llvm::CallInst>();
     const llvm::Function *F = called->getUserData<llvm::Function>();
 
+    insertedCalls.emplace_back(callsite, called);
+
     if (F->isDeclaration()) {
         /// memory allocation (malloc, calloc, etc.)
         auto seq = createUndefFunctionCall(CI, F);
@@ -233,8 +241,9 @@ PointerSubgraph &
 LLVMPointerGraphBuilder::createOrGetSubgraph(const llvm::Function *F) {
     auto it = subgraphs_map.find(F);
     if (it == subgraphs_map.end()) {
-        // create a new subgraph
-        PointerSubgraph &subg = buildFunction(*F);
+        // create a new subgraph (or take it from an arena)
+        PointerSubgraph &subg =
+                _arenaFunctions ? adoptFunction(*F) : buildFunction(*F);
         assert(subg.root != nullptr);
 
         if (ad_hoc_building) {
@@ -397,7 +406,7 @@ LLVMPointerGraphBuilder::buildInstruction(const llvm::Instruction &Inst) {
         break;
     case Instruction::FPToUI:
     case Instruction::FPToSI:
-        if (llvmutils::typeCanBePointer(&M->getDataLayout(), Inst.getType()))
+        if (llvmutils::typeCanBePointer(&getDataLayout(), Inst.getType()))
             seq = &createCast(&Inst);
         else
             seq = &createUnknown(&Inst);
@@ -639,7 +648,12 @@ PointerGraph *LLVMPointerGraphBuilder::buildLLVMPointerGraph() {
     buildGlobals();
 
     // now we can build rest of the graph
-    PointerSubgraph &subg = buildFunction(*F);
+    if (canBuildInParallel())
+        buildFunctionsInParallel(F);
+    else
+        buildFunction(*F);
+
+    PointerSubgraph &subg = *getSubgraph(F);
     PSNode *root = subg.root;
     assert(root != nullptr);
     (void) root; // c++17 TODO: replace with [[maybe_unused]]
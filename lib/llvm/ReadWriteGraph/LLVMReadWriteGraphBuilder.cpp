@@ -50,15 +50,13 @@ llvm::raw_ostream &operator<<(llvm::raw_ostream &os, const ValInfo &vi) {
 }
 
 ///
-// Map pointers of 'val' to def-sites.
-// \param where  location in the program, for debugging
-// \param size is the number of bytes used from the memory
-std::vector<DefSite>
-LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
-                                       const llvm::Value *val, Offset size) {
+// Map pointers of 'val' (given in 'psn') to def-sites.
+template <typename PointsToSetT>
+std::vector<DefSite> LLVMReadWriteGraphBuilder::mapPointers(
+        const llvm::Value *where, const llvm::Value *val, Offset size,
+        const std::pair<bool, PointsToSetT> &psn) {
     std::vector<DefSite> result;
 
-    auto psn = PTA->getLLVMPointsToChecked(val);
     if (!psn.first) {
         result.push_back(DefSite(UNKNOWN_MEMORY));
 #ifndef NDEBUG
@@ -123,6 +121,23 @@ LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
     return result;
 }
 
+///
+// Map pointers of 'val' to def-sites.
+// \param where  location in the program, for debugging
+// \param size is the number of bytes used from the memory
+std::vector<DefSite>
+LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
+                                       const llvm::Value *val, Offset size) {
+    // DG's analysis gives the points-to set without allocating it
+    if (!PTA->getOptions().isSVF()) {
+        auto *dgpta = static_cast<DGLLVMPointerAnalysis *>(PTA);
+        return mapPointers(where, val, size,
+                           dgpta->getLLVMPointsToViewChecked(val));
+    }
+
+    return mapPointers(where, val, size, PTA->getLLVMPointsToChecked(val));
+}
+
 RWNode *LLVMReadWriteGraphBuilder::getOperand(const llvm::Value *val) {
     auto *op = getNode(val);
     if (!op) {
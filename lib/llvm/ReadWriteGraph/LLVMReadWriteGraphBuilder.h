@@ -65,6 +65,11 @@ class LLVMReadWriteGraphBuilder
 
     RWNode &create(RWNodeType t) { return graph.create(t); }
 
+    template <typename PointsToSetT>
+    std::vector<DefSite>
+    mapPointers(const llvm::Value *where, const llvm::Value *val, Offset size,
+                const std::pair<bool, PointsToSetT> &psn);
+
   public:
     LLVMReadWriteGraphBuilder(const llvm::Module *m, dg::LLVMPointerAnalysis *p,
                               const LLVMDataDependenceAnalysisOptions &opts)
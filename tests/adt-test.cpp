@@ -182,3 +182,163 @@ TEST_CASE("TSL Hopscotch collision test", "HashMap") {
     hashCollisionTest<dg::HopscotchHashMap<MyInt, int>>();
 }
 #endif
+
+#include "dg/ADT/OffsetMap.h"
+
+TEST_CASE("Offset map", "OffsetMap") {
+    dg::ADT::OffsetMap<int> M;
+    REQUIRE(M.empty());
+    REQUIRE(M.find(0) == M.end());
+    REQUIRE(M.getUnknown() == nullptr);
+
+    M[dg::Offset::UNKNOWN] = 10;
+    M[8] = 8;
+    M[0] = 1;
+    M[4] = 4;
+    REQUIRE(M.size() == 4);
+
+    // the entries are sorted and the unknown offset is the last one
+    std::vector<dg::Offset> offsets;
+    for (const auto &it : M)
+        offsets.push_back(it.first);
+    REQUIRE(offsets == std::vector<dg::Offset>{0, 4, 8, dg::Offset::UNKNOWN});
+
+    REQUIRE(M.find(4)->second == 4);
+    REQUIRE(M.find(5) == M.end());
+    REQUIRE(M.find(dg::Offset::UNKNOWN)->second == 10);
+    REQUIRE(M.getUnknown());
+    REQUIRE(*M.getUnknown() == 10);
+    REQUIRE(M.count(8) == 1);
+
+    M[4] = 5;
+    REQUIRE(M.size() == 4);
+    REQUIRE(M.find(4)->second == 5);
+
+    REQUIRE(M.erase(dg::Offset::UNKNOWN) == 1);
+    REQUIRE(M.getUnknown() == nullptr);
+    REQUIRE(M.find(dg::Offset::UNKNOWN) == M.end());
+    REQUIRE(M.find(8)->second == 8);
+    REQUIRE(M.erase(dg::Offset::UNKNOWN) == 0);
+    REQUIRE(M.size() == 3);
+
+    M.clear();
+    REQUIRE(M.empty());
+}
+
+TEST_CASE("Offset map merge", "OffsetMap") {
+    dg::ADT::OffsetMap<int> M;
+    M[4] = 4;
+    M[12] = 12;
+    M[dg::Offset::UNKNOWN] = 100;
+
+    auto add = [](int &to, int from) {
+        if (from == 0)
+            return false;
+        to += from;
+        return true;
+    };
+
+    // sorted, with repeated offsets
+    std::vector<std::pair<dg::Offset, int>> entries{
+            {0, 1}, {4, 1}, {8, 1}, {8, 2}, {dg::Offset::UNKNOWN, 1},
+            {dg::Offset::UNKNOWN, 1}};
+    REQUIRE(M.mergeSorted(entries.begin(), entries.end(), add));
+
+    std::vector<std::pair<dg::Offset, int>> expected{
+            {0, 1}, {4, 5}, {8, 3}, {12, 12}, {dg::Offset::UNKNOWN, 102}};
+    std::vector<std::pair<dg::Offset, int>> result(M.begin(), M.end());
+    REQUIRE(result == expected);
+
+    // the range of known offsets
+    REQUIRE(M.lowerBound(5)->first == 8);
+    REQUIRE(M.lowerBound(13) == M.knownEnd());
+    REQUIRE(M.lowerBound(dg::Offset::UNKNOWN) == M.knownEnd());
+    REQUIRE(M.knownEnd()->first.isUnknown());
+
+    std::vector<std::pair<dg::Offset, int>> nothing{{4, 0}};
+    REQUIRE(!M.mergeSorted(nothing.begin(), nothing.end(), add));
+    REQUIRE(M.size() == 5);
+}
+
+TEST_CASE("Offset map inline storage", "OffsetMap") {
+    // values that must be constructed and destroyed
+    using OffsetsT = std::vector<dg::Offset>;
+    dg::ADT::OffsetMap<std::vector<int>, 2> M;
+    M[8].push_back(8);
+    M[dg::Offset::UNKNOWN].push_back(100);
+    REQUIRE(M.size() == 2);
+
+    // moves the entries to the heap
+    M[0].push_back(0);
+    M[4].push_back(4);
+    OffsetsT offsets;
+    for (const auto &it : M)
+        offsets.push_back(it.first);
+    REQUIRE(offsets == OffsetsT{0, 4, 8, dg::Offset::UNKNOWN});
+    REQUIRE(M.getUnknown()->front() == 100);
+
+    auto C = M;
+    REQUIRE(C.size() == 4);
+    REQUIRE(C.find(4)->second.front() == 4);
+
+    // moves the entries back inline
+    REQUIRE(M.erase(0) == 1);
+    REQUIRE(M.erase(4) == 1);
+    REQUIRE(M.size() == 2);
+    REQUIRE(M.find(8)->second.front() == 8);
+    REQUIRE(M.getUnknown()->front() == 100);
+
+    // inserting inline before the other entries
+    M.erase(dg::Offset::UNKNOWN);
+    M[0].push_back(0);
+    offsets.clear();
+    for (const auto &it : M)
+        offsets.push_back(it.first);
+    REQUIRE(offsets == OffsetsT{0, 8});
+    REQUIRE(M.find(0)->second.front() == 0);
+    REQUIRE(M.find(8)->second.front() == 8);
+
+    M.swap(C);
+    REQUIRE(M.size() == 4);
+    REQUIRE(C.size() == 2);
+    auto D = std::move(C);
+    REQUIRE(C.empty());
+    REQUIRE(D.find(8)->second.front() == 8);
+}
+
+#include "dg/ADT/SmallSortedSet.h"
+
+TEST_CASE("Small sorted set", "SmallSortedSet") {
+    SmallSortedSet<int, 2> S;
+    REQUIRE(S.empty());
+    REQUIRE(S.insert(3).second);
+    REQUIRE(S.insert(1).second);
+    REQUIRE(!S.insert(3).second);
+    REQUIRE(S.size() == 2);
+
+    // moves the values to the heap
+    REQUIRE(S.insert(2).second);
+    REQUIRE(S.insert(0).second);
+    std::vector<int> values(S.begin(), S.end());
+    REQUIRE(values == std::vector<int>{0, 1, 2, 3});
+    REQUIRE(S.count(2) == 1);
+    REQUIRE(S.find(4) == S.end());
+
+    SmallSortedSet<int, 2> R{5, 1};
+    REQUIRE(R.insert(S));
+    REQUIRE(!R.insert(S));
+    values.assign(R.begin(), R.end());
+    REQUIRE(values == std::vector<int>{0, 1, 2, 3, 5});
+    REQUIRE(R != S);
+
+    SmallSortedSet<int, 2> T(values.begin(), values.end());
+    REQUIRE(T == R);
+    T.swap(S);
+    REQUIRE(S == R);
+    REQUIRE(T.size() == 4);
+
+    T.clear();
+    REQUIRE(T.empty());
+    REQUIRE(T.insert(7).second);
+    REQUIRE(*T.begin() == 7);
+}
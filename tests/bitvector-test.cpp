@@ -1,10 +1,14 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <iterator>
 #include <random>
 #include <set>
 
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/CompressedBitmap.h"
 
+using dg::ADT::CompressedBitmap;
 using dg::ADT::SparseBitvector;
 
 TEST_CASE("Querying empty set", "SparseBitvector") {
@@ -205,3 +209,138 @@ TEST_CASE("Merge random bitvectors (union)", "SparseBitvector") {
     //    B2.merge(B1);
     //    REQUIRE(B1 == B2);
 }
+
+static void checkBitmap(const CompressedBitmap &B,
+                        const std::set<uint64_t> &numbers) {
+    REQUIRE(B.size() == numbers.size());
+    REQUIRE(B.empty() == numbers.empty());
+    // the iteration goes in the ascending order
+    REQUIRE(std::equal(B.begin(), B.end(), numbers.begin()));
+    for (auto x : numbers)
+        REQUIRE(B.get(x));
+}
+
+// the numbers from a few chunks, so that the chunks
+// get sparse and dense containers
+static uint64_t clusteredNumber(std::default_random_engine &generator,
+                                unsigned density) {
+    std::uniform_int_distribution<uint64_t> chunk(0, 3);
+    std::uniform_int_distribution<uint64_t> low(0, density);
+    return (chunk(generator) << 16) * 1000 + low(generator);
+}
+
+TEST_CASE("Compressed bitmap set and unset", "CompressedBitmap") {
+    CompressedBitmap B;
+    std::set<uint64_t> numbers;
+
+    REQUIRE(B.set(~uint64_t{0}) == false);
+    REQUIRE(B.set(~uint64_t{0}) == true);
+    numbers.insert(~uint64_t{0});
+
+    // grow the array over the limit, so that it becomes a bitmap
+    for (uint64_t i = 0; i < 10000; i += 2) {
+        REQUIRE(B.set(i) == false);
+        numbers.insert(i);
+    }
+    checkBitmap(B, numbers);
+
+    // and back
+    for (uint64_t i = 0; i < 10000; i += 4) {
+        REQUIRE(B.unset(i) == true);
+        REQUIRE(B.unset(i) == false);
+        numbers.erase(i);
+    }
+    checkBitmap(B, numbers);
+
+    B.reset();
+    REQUIRE(B.empty());
+    REQUIRE(B.begin() == B.end());
+}
+
+TEST_CASE("Compressed bitmap runs", "CompressedBitmap") {
+    CompressedBitmap B;
+    std::set<uint64_t> numbers;
+    for (uint64_t i = 100; i < 70000; ++i) {
+        B.set(i);
+        numbers.insert(i);
+    }
+    B.runOptimize();
+    checkBitmap(B, numbers);
+
+    // split the run and join it again
+    REQUIRE(B.unset(5000) == true);
+    numbers.erase(5000);
+    REQUIRE(B.get(5000) == false);
+    checkBitmap(B, numbers);
+    REQUIRE(B.set(5000) == false);
+    numbers.insert(5000);
+    REQUIRE(B.set(99) == false);
+    numbers.insert(99);
+    checkBitmap(B, numbers);
+
+    CompressedBitmap R;
+    std::set<uint64_t> rnumbers;
+    for (uint64_t i = 60000; i < 140000; ++i) {
+        R.set(i);
+        rnumbers.insert(i);
+    }
+    R.runOptimize();
+    REQUIRE(B.set(R) == true);
+    REQUIRE(B.set(R) == false);
+    numbers.insert(rnumbers.begin(), rnumbers.end());
+    checkBitmap(B, numbers);
+}
+
+TEST_CASE("Compressed bitmap operations", "CompressedBitmap") {
+    std::default_random_engine generator;
+
+    for (unsigned round = 0; round < 40; ++round) {
+        CompressedBitmap B1, B2;
+        std::set<uint64_t> N1, N2;
+        // sparse and dense sets
+        unsigned density1 = round % 2 ? 10000 : 60000;
+        unsigned density2 = round % 3 ? 20000 : 65000;
+        for (int i = 0; i < 8000; ++i) {
+            auto x = clusteredNumber(generator, density1);
+            auto y = clusteredNumber(generator, density2);
+            B1.set(x);
+            N1.insert(x);
+            if (i % (round % 4 + 1) == 0) {
+                B2.set(y);
+                N2.insert(y);
+            }
+        }
+        if (round % 5 == 0)
+            B1.runOptimize();
+        if (round % 7 == 0)
+            B2.runOptimize();
+        checkBitmap(B1, N1);
+        checkBitmap(B2, N2);
+
+        std::set<uint64_t> expected;
+        std::set_union(N1.begin(), N1.end(), N2.begin(), N2.end(),
+                       std::inserter(expected, expected.end()));
+        auto U = B1;
+        REQUIRE(U.set(B2) == (expected.size() != N1.size()));
+        checkBitmap(U, expected);
+        REQUIRE(U.set(B2) == false);
+
+        expected.clear();
+        std::set_intersection(N1.begin(), N1.end(), N2.begin(), N2.end(),
+                              std::inserter(expected, expected.end()));
+        auto I = B1;
+        REQUIRE(I.intersect(B2) == (expected.size() != N1.size()));
+        checkBitmap(I, expected);
+
+        expected.clear();
+        std::set_difference(N1.begin(), N1.end(), N2.begin(), N2.end(),
+                            std::inserter(expected, expected.end()));
+        auto D = B1;
+        REQUIRE(D.subtract(B2) == (expected.size() != N1.size()));
+        checkBitmap(D, expected);
+
+        // (B1 - B2) + (B1 & B2) == B1
+        D.set(I);
+        REQUIRE(D == B1);
+    }
+}
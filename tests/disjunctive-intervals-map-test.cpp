@@ -7,10 +7,19 @@
 #undef NDEBUG
 
 #include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/FlatDisjunctiveIntervalMap.h"
 #include "dg/Offset.h"
 
 using namespace dg;
+
+#ifdef FLAT_INTERVAL_MAP
+// run the same tests on the flat implementation
+template <typename ValueT, typename IntervalValueT = Offset>
+using DisjunctiveIntervalMap =
+        dg::ADT::FlatDisjunctiveIntervalMap<ValueT, IntervalValueT>;
+#else
 using dg::ADT::DisjunctiveIntervalMap;
+#endif
 
 static std::ostream &
 operator<<(std::ostream &os, const std::vector<std::tuple<int, int, int>> &v) {
@@ -573,3 +582,103 @@ TEST_CASE("Uncovered - regression 1", "DisjunctiveIntervalMap") {
     ret = M.uncovered(0, 3);
     REQUIRE(ret.size() == 0);
 }
+
+#ifdef FLAT_INTERVAL_MAP
+template <typename FlatT, typename MapT>
+static bool sameMaps(const FlatT &F, const MapT &M) {
+    if (F.size() != M.size())
+        return false;
+    auto it = M.begin();
+    for (const auto &pair : F) {
+        if (pair.first != it->first)
+            return false;
+        if (!std::equal(pair.second.begin(), pair.second.end(),
+                        it->second.begin(), it->second.end()))
+            return false;
+        ++it;
+    }
+    return true;
+}
+
+TEST_CASE("Flat map agrees with std::map", "FlatDisjunctiveIntervalMap") {
+    dg::ADT::FlatDisjunctiveIntervalMap<int, int> F, F2;
+    dg::ADT::DisjunctiveIntervalMap<int, int> M, M2;
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> bounds(5, 100);
+    std::uniform_int_distribution<int> values(0, 5);
+
+    for (int i = 0; i < 2000; ++i) {
+        auto start = bounds(generator);
+        auto end = bounds(generator);
+        if (end < start)
+            std::swap(end, start);
+        auto val = values(generator);
+
+        if (i % 3 == 0) {
+            REQUIRE(F.update(start, end, val) == M.update(start, end, val));
+        } else {
+            REQUIRE(F.add(start, end, val) == M.add(start, end, val));
+        }
+        REQUIRE(sameMaps(F, M));
+
+        // DisjunctiveIntervalMap::overlaps() misses intervals that start
+        // before the queried one, so check it against uncovered()
+        using IntT = decltype(F)::IntervalT;
+        REQUIRE(F.overlaps(end, end + 3) ==
+                (M.uncovered(end, end + 3) !=
+                 std::vector<IntT>{IntT(end, end + 3)}));
+        REQUIRE(F.overlapsFull(start - 1, end) ==
+                M.overlapsFull(start - 1, end));
+        // DisjunctiveIntervalMap::uncovered() may return gaps that reach
+        // behind the queried interval, so compute the expected gaps by bytes
+        std::vector<IntT> gaps;
+        for (int b = start - 5; b <= end + 5; ++b) {
+            if (!M.gather(b, b).empty())
+                continue;
+            if (!gaps.empty() && gaps.back().end == b - 1)
+                gaps.back().end = b;
+            else
+                gaps.emplace_back(b, b);
+        }
+        REQUIRE(F.uncovered(start - 5, end + 5) == gaps);
+        REQUIRE(F.gather(start, end) == M.gather(start, end));
+
+        // bulk adding of a whole map
+        if (i % 50 == 0) {
+            F2.add(F);
+            for (const auto &pair : M)
+                M2.add(pair.first, pair.second);
+            REQUIRE(sameMaps(F2, M2));
+            F = {};
+            M = {};
+        }
+    }
+
+    // adding a container of values at once
+    std::set<int> vals{1, 2, 3};
+    REQUIRE(F2.add(0, 200, vals));
+    REQUIRE(!F2.add(0, 200, vals));
+    REQUIRE(F2.gather(0, 200).size() == 6);
+    REQUIRE(F2.update(0, 200, vals));
+    REQUIRE(F2.gather(0, 200) == vals);
+    REQUIRE(F2.gather(0, 0) == vals);
+}
+
+TEST_CASE("Flat map intersection", "FlatDisjunctiveIntervalMap") {
+    dg::ADT::FlatDisjunctiveIntervalMap<int, int> A, B;
+    A.add(0, 10, 1);
+    A.add(5, 20, 2);
+    B.add(3, 6, 2);
+    B.add(8, 30, 1);
+
+    /*
+     * A: [0,4] -> 1, [5,10] -> 1 2, [11,20] -> 2
+     * B: [3,6] -> 2, [8,30] -> 1
+     * and the intersection is [5,6] -> 2, [8,10] -> 1
+     */
+    auto I = A.intersection(B);
+    REQUIRE_THAT(I, HasStructure({std::make_tuple(5, 6, 2),
+                                  std::make_tuple(8, 10, 1)}));
+}
+#endif // FLAT_INTERVAL_MAP
@@ -0,0 +1,55 @@
+#undef NDEBUG
+
+#include <cassert>
+#include <cstdint>
+#include <set>
+
+#ifdef DUMP
+#include <cstdio>
+#endif
+
+#include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/FlatDisjunctiveIntervalMap.h"
+
+// Check that the flat map maps every byte to the same values
+// as DisjunctiveIntervalMap
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    dg::ADT::FlatDisjunctiveIntervalMap<int, int> F;
+    dg::ADT::DisjunctiveIntervalMap<int, int> M;
+
+    // use small numbers so that the intervals overlap often,
+    // the lowest bit of the value says whether to update
+    for (unsigned i = 0; i + 2 < size; i += 3) {
+        int a = data[i], b = data[i + 1];
+        int val = data[i + 2] >> 1;
+        bool update = data[i + 2] & 1;
+        if (a > b)
+            std::swap(a, b);
+        assert(a <= b);
+#ifdef DUMP
+        printf("%s [%d, %d] -> %d\n", update ? "Updating" : "Adding", a, b,
+               val);
+        fflush(stdout);
+#endif
+        if (update) {
+            F.update(a, b, val);
+            M.update(a, b, val);
+        } else {
+            F.add(a, b, val);
+            M.add(a, b, val);
+        }
+    }
+
+    if (M.empty()) {
+        assert(F.empty());
+        return 0;
+    }
+
+    for (int b = 0; b <= UINT8_MAX; ++b) {
+        assert(F.gather(b, b) == M.gather(b, b));
+        assert(F.overlapsFull(b, b) == !F.gather(b, b).empty());
+        assert(F.uncovered(b, b).empty() == F.overlapsFull(b, b));
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../tools/include/dg/tools/TimeMeasure.h"
+#include "dg/MemorySSA/MemorySSA.h"
+
+using namespace dg::dda;
+using dg::Offset;
+
+// Build a graph with one huge block of stores to and loads from
+// 'objects' memory objects, as it is in generated straight-line code.
+static void build(ReadWriteGraph &G, std::vector<RWNode *> &loads,
+                  size_t size, size_t objects) {
+    auto &subg = G.createSubgraph();
+    auto &block = subg.createBBlock();
+    G.setEntry(&subg);
+
+    std::vector<RWNode *> allocs;
+    for (size_t i = 0; i < objects; ++i) {
+        allocs.push_back(&G.create(RWNodeType::ALLOC));
+        block.append(allocs.back());
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        auto *mem = allocs[(i / 2 * 7) % objects];
+        if (i % 2 == 0) {
+            auto &S = G.create(RWNodeType::STORE);
+            Offset off = (i / 2) % 2 * 4;
+            if (i % 6 == 0)
+                S.addDef(mem, off, 4); // weak update
+            else
+                S.addOverwrites(mem, off, 4);
+            block.append(&S);
+        } else {
+            auto &L = G.create(RWNodeType::LOAD);
+            L.addUse(mem, 0, 8);
+            block.append(&L);
+            loads.push_back(&L);
+        }
+    }
+}
+
+static void run(size_t size, size_t objects) {
+    ReadWriteGraph G;
+    std::vector<RWNode *> loads;
+    build(G, loads, size, objects);
+
+    MemorySSATransformation ssa(std::move(G));
+    ssa.run();
+
+    std::cout << "Block of " << size << " nodes, " << objects
+              << " objects\n";
+    dg::debug::TimeMeasure tm;
+    tm.start();
+    size_t defs = 0;
+    for (auto *L : loads)
+        defs += ssa.getDefinitions(L).size();
+    tm.stop();
+    tm.report(" -- querying the loads took");
+
+    // on-demand queries that insert new uses into the block
+    tm.start();
+    for (size_t i = 0; i < loads.size(); i += 10)
+        defs += ssa.getDefinitions(loads[i], loads[i]->getUses().begin()->target,
+                                   0, 4)
+                        .size();
+    tm.stop();
+    tm.report(" -- querying at the loads took");
+    std::cout << " -- found " << defs << " definitions\n";
+}
+
+int main(int argc, char *argv[]) {
+    size_t size = argc > 1 ? std::stoul(argv[1]) : 20000;
+
+    for (size_t objects : {10, 1000}) {
+        run(size / 4, objects);
+        run(size / 2, objects);
+        run(size, objects);
+    }
+
+    return 0;
+}
@@ -253,6 +253,9 @@ TEST_CASE("Querying empty set", "PointsToSet") {
     queryingEmptySet<SmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedSmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedPointerIdPointsToSet>();
+    queryingEmptySet<CompressedPointsToSet>();
+    queryingEmptySet<SelectablePointsToSet>();
+    queryingEmptySet<SharedPointsToSet>();
 }
 
 TEST_CASE("Add an element", "PointsToSet") {
@@ -263,6 +266,9 @@ TEST_CASE("Add an element", "PointsToSet") {
     addAnElement<SmallOffsetsPointsToSet>();
     addAnElement<AlignedSmallOffsetsPointsToSet>();
     addAnElement<AlignedPointerIdPointsToSet>();
+    addAnElement<CompressedPointsToSet>();
+    addAnElement<SelectablePointsToSet>();
+    addAnElement<SharedPointsToSet>();
 }
 
 TEST_CASE("Add few elements", "PointsToSet") {
@@ -273,6 +279,9 @@ TEST_CASE("Add few elements", "PointsToSet") {
     addFewElements<SmallOffsetsPointsToSet>();
     addFewElements<AlignedSmallOffsetsPointsToSet>();
     addFewElements<AlignedPointerIdPointsToSet>();
+    addFewElements<CompressedPointsToSet>();
+    addFewElements<SelectablePointsToSet>();
+    addFewElements<SharedPointsToSet>();
 }
 
 TEST_CASE("Add few elements 2", "PointsToSet") {
@@ -283,6 +292,9 @@ TEST_CASE("Add few elements 2", "PointsToSet") {
     addFewElements2<SmallOffsetsPointsToSet>();
     addFewElements2<AlignedSmallOffsetsPointsToSet>();
     addFewElements2<AlignedPointerIdPointsToSet>();
+    addFewElements2<CompressedPointsToSet>();
+    addFewElements2<SelectablePointsToSet>();
+    addFewElements2<SharedPointsToSet>();
 }
 
 TEST_CASE("Merge points-to sets", "PointsToSet") {
@@ -293,6 +305,9 @@ TEST_CASE("Merge points-to sets", "PointsToSet") {
     mergePointsToSets<SmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedSmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedPointerIdPointsToSet>();
+    mergePointsToSets<CompressedPointsToSet>();
+    mergePointsToSets<SelectablePointsToSet>();
+    mergePointsToSets<SharedPointsToSet>();
 }
 
 TEST_CASE("Remove element",
@@ -304,6 +319,9 @@ TEST_CASE("Remove element",
     removeElement<SmallOffsetsPointsToSet>();
     removeElement<AlignedSmallOffsetsPointsToSet>();
     removeElement<AlignedPointerIdPointsToSet>();
+    removeElement<CompressedPointsToSet>();
+    removeElement<SelectablePointsToSet>();
+    removeElement<SharedPointsToSet>();
 }
 
 TEST_CASE("Remove few elements",
@@ -315,6 +333,9 @@ TEST_CASE("Remove few elements",
     removeFewElements<SmallOffsetsPointsToSet>();
     removeFewElements<AlignedSmallOffsetsPointsToSet>();
     removeFewElements<AlignedPointerIdPointsToSet>();
+    removeFewElements<CompressedPointsToSet>();
+    removeFewElements<SelectablePointsToSet>();
+    removeFewElements<SharedPointsToSet>();
 }
 
 TEST_CASE("Remove all elements pointing to a target",
@@ -326,6 +347,9 @@ TEST_CASE("Remove all elements pointing to a target",
     removeAnyTest<SmallOffsetsPointsToSet>();
     removeAnyTest<AlignedSmallOffsetsPointsToSet>();
     removeAnyTest<AlignedPointerIdPointsToSet>();
+    removeAnyTest<CompressedPointsToSet>();
+    removeAnyTest<SelectablePointsToSet>();
+    removeAnyTest<SharedPointsToSet>();
 }
 
 TEST_CASE("Test various points-to functions", "PointsToSet") {
@@ -336,6 +360,111 @@ TEST_CASE("Test various points-to functions", "PointsToSet") {
     pointsToTest<SmallOffsetsPointsToSet>();
     pointsToTest<AlignedSmallOffsetsPointsToSet>();
     pointsToTest<AlignedPointerIdPointsToSet>();
+    pointsToTest<CompressedPointsToSet>();
+    pointsToTest<SelectablePointsToSet>();
+    pointsToTest<SharedPointsToSet>();
+}
+
+TEST_CASE("Shared points-to sets", "PointsToSet") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+
+    SharedPointsToSet S1, S2, S3;
+    S1.add(A, 0);
+    S1.add(B, 4);
+    // the same set created in a different order
+    S2.add(B, 4);
+    S2.add(A, 0);
+    REQUIRE(S1.getSetID() == S2.getSetID());
+
+    S3.add(A, 8);
+    REQUIRE(S3.getSetID() != S1.getSetID());
+
+    // unions
+    auto cached = SharedPointsToSet::getNumOfCachedUnions();
+    SharedPointsToSet U1(S1), U2(S3);
+    REQUIRE(U1.add(S3) == true);
+    REQUIRE(U2.add(S2) == true);
+    REQUIRE(U1.getSetID() == U2.getSetID());
+    REQUIRE(U1.size() == 3);
+    REQUIRE(SharedPointsToSet::getNumOfCachedUnions() == cached + 1);
+    REQUIRE(U1.add(S1) == false);
+
+    // changing a set does not change the sets that share the storage
+    REQUIRE(S2.remove(Pointer(A, 0)) == true);
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S2.size() == 1);
+    REQUIRE(S1.getSetID() != S2.getSetID());
+}
+
+TEST_CASE("Selectable points-to sets", "PointsToSet") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+
+    // every representation behaves the same (with a single offset,
+    // because SeparateOffsetsPointsToSet stores a product of targets
+    // and offsets)
+    for (auto kind : allPointsToSetKinds) {
+        SelectablePointsToSet S(kind);
+        REQUIRE(S.getKind() == kind);
+        REQUIRE(S.empty());
+        REQUIRE(S.add(A, 0) == true);
+        REQUIRE(S.add(B, 0) == true);
+        REQUIRE(S.add(A, 0) == false);
+        REQUIRE(S.size() == 2);
+        REQUIRE(S.pointsTo(Pointer(B, 0)));
+        size_t n = 0;
+        for (auto it = S.begin(), et = S.end(); it != et; ++it) {
+            auto copy = it;
+            REQUIRE(*copy == *it);
+            ++n;
+        }
+        REQUIRE(n == 2);
+        // SeparateOffsetsPointsToSet does not support removing
+        if (kind == PointsToSetKind::separateOffsets)
+            continue;
+        REQUIRE(S.removeAny(A) == true);
+        REQUIRE(S.size() == 1);
+        REQUIRE(*S.begin() == Pointer(B, 0));
+    }
+
+    // sets of different representations can be mixed
+    SelectablePointsToSet S1(PointsToSetKind::compressed);
+    SelectablePointsToSet S2(PointsToSetKind::simple);
+    S1.add(A, 0);
+    S2.add(B, 4);
+    REQUIRE(S1.add(S2) == true);
+    REQUIRE(S1.add(S2) == false);
+    REQUIRE(S1.getKind() == PointsToSetKind::compressed);
+    REQUIRE(S1.size() == 2);
+
+    S1.swap(S2);
+    REQUIRE(S1.getKind() == PointsToSetKind::simple);
+    REQUIRE(S2.getKind() == PointsToSetKind::compressed);
+    REQUIRE(S1.size() == 1);
+    REQUIRE(S2.size() == 2);
+
+    SelectablePointsToSet S3(PointsToSetKind::smallOffsets);
+    S3 = S2;
+    REQUIRE(S3.getKind() == PointsToSetKind::compressed);
+    REQUIRE(S3.has(Pointer(A, 0)));
+    REQUIRE(S3.has(Pointer(B, 4)));
+
+    SelectablePointsToSet S4(std::move(S3));
+    REQUIRE(S4.size() == 2);
+
+    // the representation of the graph is used by the sets of its nodes
+    PointerGraph G;
+    G.setPointsToSetKind(PointsToSetKind::separateOffsets);
+    PSNode *C = G.create<PSNodeType::ALLOC>();
+    REQUIRE(C->pointsTo.getKind() == PointsToSetKind::separateOffsets);
+    // ... and not by the sets of other graphs or outside of graphs
+    REQUIRE(PS.create<PSNodeType::ALLOC>()->pointsTo.getKind() ==
+            defaultPointsToSetKind);
+    SelectablePointsToSet S5;
+    REQUIRE(S5.getKind() == defaultPointsToSetKind);
 }
 
 TEST_CASE("Test small overflow set behavior", "PointsToSet") {
@@ -1,8 +1,14 @@
 #include <catch2/catch.hpp>
 
+#include <chrono>
+#include <sstream>
+#include <thread>
+
 #include "dg/PointerAnalysis/PointerAnalysisFI.h"
 #include "dg/PointerAnalysis/PointerAnalysisFS.h"
+#include "dg/PointerAnalysis/PointerAnalysisSFS.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
+#include "dg/PointerAnalysis/PointerGraphOptimizations.h"
 
 using namespace dg::pta;
 using dg::Offset;
@@ -868,6 +874,105 @@ void memcpy_test8() {
     REQUIRE(L3->doesPointsTo(NULLPTR));
 }
 
+// copy a range from the middle of an object with many fields
+template <typename PTStoT>
+void memcpy_test9() {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::ALLOC>();
+    PSNode *SRC = PS.create<PSNodeType::ALLOC>();
+    SRC->setSize(32);
+    PSNode *DEST = PS.create<PSNodeType::ALLOC>();
+    DEST->setSize(16);
+
+    /* SRC = {A, B, C, A} */
+    PSNode *GS1 = PS.create<PSNodeType::GEP>(SRC, 8);
+    PSNode *GS2 = PS.create<PSNodeType::GEP>(SRC, 16);
+    PSNode *GS3 = PS.create<PSNodeType::GEP>(SRC, 24);
+    PSNode *S0 = PS.create<PSNodeType::STORE>(A, SRC);
+    PSNode *S1 = PS.create<PSNodeType::STORE>(B, GS1);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(C, GS2);
+    PSNode *S3 = PS.create<PSNodeType::STORE>(A, GS3);
+
+    /* memcpy(DEST, SRC + 8, 16) */
+    PSNode *CPY = PS.create<PSNodeType::MEMCPY>(GS1, DEST, 16);
+
+    PSNode *GD = PS.create<PSNodeType::GEP>(DEST, 8);
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(DEST);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(GD);
+
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(SRC);
+    SRC->addSuccessor(DEST);
+    DEST->addSuccessor(GS1);
+    GS1->addSuccessor(GS2);
+    GS2->addSuccessor(GS3);
+    GS3->addSuccessor(S0);
+    S0->addSuccessor(S1);
+    S1->addSuccessor(S2);
+    S2->addSuccessor(S3);
+    S3->addSuccessor(CPY);
+    CPY->addSuccessor(GD);
+    GD->addSuccessor(L1);
+    L1->addSuccessor(L2);
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS);
+    PA.run();
+
+    REQUIRE(L1->doesPointsTo(B));
+    REQUIRE(!L1->doesPointsTo(A));
+    REQUIRE(!L1->doesPointsTo(C));
+    REQUIRE(L2->doesPointsTo(C));
+    REQUIRE(!L2->doesPointsTo(A));
+    REQUIRE(!L2->doesPointsTo(B));
+}
+
+// the source of memcpy changes after it was copied (in a loop),
+// the memcpy must copy it again
+template <typename PTStoT>
+void memcpy_test10() {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *SRC = PS.create<PSNodeType::ALLOC>();
+    SRC->setSize(16);
+    PSNode *DEST = PS.create<PSNodeType::ALLOC>();
+    DEST->setSize(16);
+
+    PSNode *GS = PS.create<PSNodeType::GEP>(SRC, 8);
+    PSNode *S0 = PS.create<PSNodeType::STORE>(A, SRC);
+    PSNode *CPY = PS.create<PSNodeType::MEMCPY>(SRC, DEST, 16);
+    PSNode *S1 = PS.create<PSNodeType::STORE>(B, GS);
+    // copy inside DEST: DEST[8] = DEST[0]
+    PSNode *GD = PS.create<PSNodeType::GEP>(DEST, 8);
+    PSNode *CPY2 = PS.create<PSNodeType::MEMCPY>(DEST, GD, 8);
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(GD);
+
+    A->addSuccessor(B);
+    B->addSuccessor(SRC);
+    SRC->addSuccessor(DEST);
+    DEST->addSuccessor(GS);
+    GS->addSuccessor(S0);
+    S0->addSuccessor(CPY);
+    CPY->addSuccessor(S1);
+    S1->addSuccessor(GD);
+    GD->addSuccessor(CPY2);
+    CPY2->addSuccessor(L1);
+    L1->addSuccessor(CPY);
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS);
+    PA.run();
+
+    REQUIRE(L1->doesPointsTo(A));
+    REQUIRE(L1->doesPointsTo(B));
+}
+
 TEST_CASE("Flow insensitive", "FI") {
     store_load<dg::pta::PointerAnalysisFI>();
     store_load2<dg::pta::PointerAnalysisFI>();
@@ -893,6 +998,803 @@ TEST_CASE("Flow insensitive", "FI") {
     memcpy_test6<dg::pta::PointerAnalysisFI>();
     memcpy_test7<dg::pta::PointerAnalysisFI>();
     memcpy_test8<dg::pta::PointerAnalysisFI>();
+    memcpy_test9<dg::pta::PointerAnalysisFI>();
+    memcpy_test10<dg::pta::PointerAnalysisFI>();
+}
+
+// flow-insensitive analysis with the worklist (difference propagation) solver
+class PointerAnalysisFIWorklist : public dg::pta::PointerAnalysisFI {
+  public:
+    PointerAnalysisFIWorklist(PointerGraph *PS)
+            : PointerAnalysisFI(PS, dg::PointerAnalysisOptions().setSolver(
+                                            dg::PointerAnalysisOptions::
+                                                    Solver::worklist)) {}
+};
+
+TEST_CASE("Flow insensitive (worklist)", "FI") {
+    store_load<PointerAnalysisFIWorklist>();
+    store_load2<PointerAnalysisFIWorklist>();
+    store_load3<PointerAnalysisFIWorklist>();
+    store_load4<PointerAnalysisFIWorklist>();
+    store_load5<PointerAnalysisFIWorklist>();
+    gep1<PointerAnalysisFIWorklist>();
+    gep2<PointerAnalysisFIWorklist>();
+    gep3<PointerAnalysisFIWorklist>();
+    gep4<PointerAnalysisFIWorklist>();
+    gep5<PointerAnalysisFIWorklist>();
+    nulltest<PointerAnalysisFIWorklist>();
+    constant_store<PointerAnalysisFIWorklist>();
+    load_from_zeroed<PointerAnalysisFIWorklist>();
+    load_from_unknown_offset<PointerAnalysisFIWorklist>();
+    load_from_unknown_offset2<PointerAnalysisFIWorklist>();
+    load_from_unknown_offset3<PointerAnalysisFIWorklist>();
+    memcpy_test<PointerAnalysisFIWorklist>();
+    memcpy_test2<PointerAnalysisFIWorklist>();
+    memcpy_test3<PointerAnalysisFIWorklist>();
+    memcpy_test4<PointerAnalysisFIWorklist>();
+    memcpy_test5<PointerAnalysisFIWorklist>();
+    memcpy_test6<PointerAnalysisFIWorklist>();
+    memcpy_test7<PointerAnalysisFIWorklist>();
+    memcpy_test8<PointerAnalysisFIWorklist>();
+    memcpy_test9<PointerAnalysisFIWorklist>();
+    memcpy_test10<PointerAnalysisFIWorklist>();
+}
+
+// the worklist solver running in more threads
+class PointerAnalysisFIParallel : public dg::pta::PointerAnalysisFI {
+  public:
+    PointerAnalysisFIParallel(PointerGraph *PS)
+            : PointerAnalysisFI(
+                      PS, dg::PointerAnalysisOptions()
+                                  .setSolver(dg::PointerAnalysisOptions::
+                                                     Solver::worklist)
+                                  .setSolverThreads(4)) {}
+};
+
+TEST_CASE("Flow insensitive (parallel worklist)", "FI") {
+    store_load<PointerAnalysisFIParallel>();
+    store_load2<PointerAnalysisFIParallel>();
+    store_load3<PointerAnalysisFIParallel>();
+    store_load4<PointerAnalysisFIParallel>();
+    store_load5<PointerAnalysisFIParallel>();
+    gep1<PointerAnalysisFIParallel>();
+    gep2<PointerAnalysisFIParallel>();
+    gep3<PointerAnalysisFIParallel>();
+    gep4<PointerAnalysisFIParallel>();
+    gep5<PointerAnalysisFIParallel>();
+    nulltest<PointerAnalysisFIParallel>();
+    constant_store<PointerAnalysisFIParallel>();
+    load_from_zeroed<PointerAnalysisFIParallel>();
+    load_from_unknown_offset<PointerAnalysisFIParallel>();
+    load_from_unknown_offset2<PointerAnalysisFIParallel>();
+    load_from_unknown_offset3<PointerAnalysisFIParallel>();
+    memcpy_test<PointerAnalysisFIParallel>();
+    memcpy_test2<PointerAnalysisFIParallel>();
+    memcpy_test3<PointerAnalysisFIParallel>();
+    memcpy_test4<PointerAnalysisFIParallel>();
+    memcpy_test5<PointerAnalysisFIParallel>();
+    memcpy_test6<PointerAnalysisFIParallel>();
+    memcpy_test7<PointerAnalysisFIParallel>();
+    memcpy_test8<PointerAnalysisFIParallel>();
+    memcpy_test9<PointerAnalysisFIParallel>();
+    memcpy_test10<PointerAnalysisFIParallel>();
+}
+
+// the worklist solver after seeding the points-to sets in more threads
+class PointerAnalysisFISeeded : public dg::pta::PointerAnalysisFI {
+  public:
+    PointerAnalysisFISeeded(PointerGraph *PS)
+            : PointerAnalysisFI(
+                      PS, dg::PointerAnalysisOptions()
+                                  .setSolver(dg::PointerAnalysisOptions::
+                                                     Solver::seeded)
+                                  .setSolverThreads(4)) {}
+};
+
+TEST_CASE("Flow insensitive (seeded)", "FI") {
+    store_load<PointerAnalysisFISeeded>();
+    store_load2<PointerAnalysisFISeeded>();
+    store_load3<PointerAnalysisFISeeded>();
+    store_load4<PointerAnalysisFISeeded>();
+    store_load5<PointerAnalysisFISeeded>();
+    gep1<PointerAnalysisFISeeded>();
+    gep2<PointerAnalysisFISeeded>();
+    gep3<PointerAnalysisFISeeded>();
+    gep4<PointerAnalysisFISeeded>();
+    gep5<PointerAnalysisFISeeded>();
+    nulltest<PointerAnalysisFISeeded>();
+    constant_store<PointerAnalysisFISeeded>();
+    load_from_zeroed<PointerAnalysisFISeeded>();
+    load_from_unknown_offset<PointerAnalysisFISeeded>();
+    load_from_unknown_offset2<PointerAnalysisFISeeded>();
+    load_from_unknown_offset3<PointerAnalysisFISeeded>();
+    memcpy_test<PointerAnalysisFISeeded>();
+    memcpy_test2<PointerAnalysisFISeeded>();
+    memcpy_test3<PointerAnalysisFISeeded>();
+    memcpy_test4<PointerAnalysisFISeeded>();
+    memcpy_test5<PointerAnalysisFISeeded>();
+    memcpy_test6<PointerAnalysisFISeeded>();
+    memcpy_test7<PointerAnalysisFISeeded>();
+    memcpy_test8<PointerAnalysisFISeeded>();
+    memcpy_test9<PointerAnalysisFISeeded>();
+    memcpy_test10<PointerAnalysisFISeeded>();
+}
+
+// the demand-driven mode, every node is queried separately
+class PointerAnalysisFIDemand : public dg::pta::PointerAnalysisFI {
+  public:
+    PointerAnalysisFIDemand(PointerGraph *PS)
+            : PointerAnalysisFI(
+                      PS, dg::PointerAnalysisOptions()
+                                  .setSolver(dg::PointerAnalysisOptions::
+                                                     Solver::worklist)
+                                  .setDemandDriven(true)) {}
+
+    bool run() override {
+        bool ret = PointerAnalysisFI::run();
+        for (const auto &nd : getPG()->getNodes()) {
+            if (nd)
+                ret &= query(nd.get());
+        }
+        return ret;
+    }
+};
+
+TEST_CASE("Flow insensitive (demand-driven)", "FI") {
+    store_load<PointerAnalysisFIDemand>();
+    store_load2<PointerAnalysisFIDemand>();
+    store_load3<PointerAnalysisFIDemand>();
+    store_load4<PointerAnalysisFIDemand>();
+    store_load5<PointerAnalysisFIDemand>();
+    gep1<PointerAnalysisFIDemand>();
+    gep2<PointerAnalysisFIDemand>();
+    gep3<PointerAnalysisFIDemand>();
+    gep4<PointerAnalysisFIDemand>();
+    gep5<PointerAnalysisFIDemand>();
+    nulltest<PointerAnalysisFIDemand>();
+    constant_store<PointerAnalysisFIDemand>();
+    load_from_zeroed<PointerAnalysisFIDemand>();
+    load_from_unknown_offset<PointerAnalysisFIDemand>();
+    load_from_unknown_offset2<PointerAnalysisFIDemand>();
+    load_from_unknown_offset3<PointerAnalysisFIDemand>();
+    memcpy_test<PointerAnalysisFIDemand>();
+    memcpy_test2<PointerAnalysisFIDemand>();
+    memcpy_test3<PointerAnalysisFIDemand>();
+    memcpy_test4<PointerAnalysisFIDemand>();
+    memcpy_test5<PointerAnalysisFIDemand>();
+    memcpy_test6<PointerAnalysisFIDemand>();
+    memcpy_test7<PointerAnalysisFIDemand>();
+    memcpy_test8<PointerAnalysisFIDemand>();
+    memcpy_test9<PointerAnalysisFIDemand>();
+    memcpy_test10<PointerAnalysisFIDemand>();
+}
+
+TEST_CASE("Demand-driven queries", "FI") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *X = PS.create<PSNodeType::ALLOC>();
+    PSNode *P = PS.create<PSNodeType::ALLOC>();
+    PSNode *Q = PS.create<PSNodeType::ALLOC>();
+    PSNode *R = PS.create<PSNodeType::ALLOC>();
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, P);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(B, Q);
+    // store to P via a pointer loaded from R
+    PSNode *S3 = PS.create<PSNodeType::STORE>(P, R);
+    PSNode *LR = PS.create<PSNodeType::LOAD>(R);
+    PSNode *S4 = PS.create<PSNodeType::STORE>(X, LR);
+    PSNode *LP = PS.create<PSNodeType::LOAD>(P);
+    PSNode *LQ = PS.create<PSNodeType::LOAD>(Q);
+
+    A->addSuccessor(B);
+    B->addSuccessor(X);
+    X->addSuccessor(P);
+    P->addSuccessor(Q);
+    Q->addSuccessor(R);
+    R->addSuccessor(S1);
+    S1->addSuccessor(S2);
+    S2->addSuccessor(S3);
+    S3->addSuccessor(LR);
+    LR->addSuccessor(S4);
+    S4->addSuccessor(LP);
+    LP->addSuccessor(LQ);
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PointerAnalysisFIDemand PA(&PS);
+    PA.PointerAnalysisFI::run();
+    REQUIRE(PA.getNumOfRelevantNodes() == 0);
+
+    REQUIRE(PA.query(LP));
+    REQUIRE(LP->pointsTo.size() == 2);
+    REQUIRE(LP->doesPointsTo(A));
+    REQUIRE(LP->doesPointsTo(X));
+    // the memory of Q is not read by the query
+    REQUIRE(LQ->pointsTo.empty());
+
+    // the results are kept
+    auto relevant = PA.getNumOfRelevantNodes();
+    REQUIRE(PA.query(LP));
+    REQUIRE(PA.getNumOfRelevantNodes() == relevant);
+
+    REQUIRE(PA.query(LQ));
+    REQUIRE(LQ->pointsTo.size() == 1);
+    REQUIRE(LQ->doesPointsTo(B));
+    REQUIRE(PA.getNumOfRelevantNodes() > relevant);
+}
+
+TEST_CASE("Batched demand-driven queries", "FI") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *P = PS.create<PSNodeType::ALLOC>();
+    PSNode *Q = PS.create<PSNodeType::ALLOC>();
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, P);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(B, Q);
+    PSNode *LP = PS.create<PSNodeType::LOAD>(P);
+    PSNode *LQ = PS.create<PSNodeType::LOAD>(Q);
+    PSNode *C = PS.create<PSNodeType::CAST>(LP);
+
+    A->addSuccessor(B);
+    B->addSuccessor(P);
+    P->addSuccessor(Q);
+    Q->addSuccessor(S1);
+    S1->addSuccessor(S2);
+    S2->addSuccessor(LP);
+    LP->addSuccessor(LQ);
+    LQ->addSuccessor(C);
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PointerAnalysisFIDemand PA(&PS);
+    PA.PointerAnalysisFI::run();
+
+    // one query for all the nodes, a node may be there repeatedly
+    REQUIRE(PA.query(std::vector<PSNode *>{LP, LQ, LP}));
+    REQUIRE(LP->pointsTo.size() == 1);
+    REQUIRE(LP->doesPointsTo(A));
+    REQUIRE(LQ->pointsTo.size() == 1);
+    REQUIRE(LQ->doesPointsTo(B));
+    REQUIRE(C->pointsTo.empty());
+
+    // the solved nodes are not processed again
+    auto relevant = PA.getNumOfRelevantNodes();
+    REQUIRE(PA.query(std::vector<PSNode *>{LQ, LP}));
+    REQUIRE(PA.getNumOfRelevantNodes() == relevant);
+}
+
+TEST_CASE("Profile of the analysis", "FI") {
+    for (auto solver : {dg::PointerAnalysisOptions::Solver::iterative,
+                        dg::PointerAnalysisOptions::Solver::worklist}) {
+        PointerGraph PS;
+        PSNode *A = PS.create<PSNodeType::ALLOC>();
+        PSNode *B = PS.create<PSNodeType::ALLOC>();
+        PSNode *S = PS.create<PSNodeType::STORE>(A, B);
+        PSNode *L = PS.create<PSNodeType::LOAD>(B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(S);
+        S->addSuccessor(L);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        PointerAnalysisFI PA(&PS, dg::PointerAnalysisOptions()
+                                          .setSolver(solver)
+                                          .setProfile(true));
+        PA.run();
+        REQUIRE(L->doesPointsTo(A));
+
+        const auto *profile = PA.getProfile();
+        REQUIRE(profile);
+        REQUIRE(!profile->getIterations().empty());
+        // the load and its pointer are found in the first iteration
+        REQUIRE(profile->getIterations()[0].changed >= 1);
+        REQUIRE(profile->getNodeStats()[L->getID()].processed >= 1);
+        auto type = static_cast<size_t>(PSNodeType::LOAD);
+        REQUIRE(profile->getTypeStats()[type].processed >=
+                profile->getNodeStats()[L->getID()].processed);
+
+        std::ostringstream out;
+        profile->dumpJSON(out, &PS,
+                          [](const PSNode *) { return std::string("n\"1"); });
+        REQUIRE(out.str().find("\"hottest\"") != std::string::npos);
+        REQUIRE(out.str().find("\"n\\\"1\"") != std::string::npos);
+    }
+
+    // the profile is not collected by default
+    PointerGraph PS;
+    PointerAnalysisFI PA(&PS);
+    REQUIRE(PA.getProfile() == nullptr);
+}
+
+// the analysis that runs out of time while processing the first node
+class SlowPointerAnalysisFI : public PointerAnalysisFI {
+    bool slept{false};
+
+  public:
+    using PointerAnalysisFI::PointerAnalysisFI;
+
+    bool beforeProcessed(PSNode *) override {
+        if (!slept) {
+            slept = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+};
+
+TEST_CASE("Exceeded time limit", "FI") {
+    for (auto solver : {dg::PointerAnalysisOptions::Solver::iterative,
+                        dg::PointerAnalysisOptions::Solver::worklist}) {
+        PointerGraph PS;
+        PSNode *A = PS.create<PSNodeType::ALLOC>();
+        PSNode *B = PS.create<PSNodeType::ALLOC>();
+        PSNode *C = PS.create<PSNodeType::ALLOC>();
+        PSNode *S1 = PS.create<PSNodeType::STORE>(A, B);
+        PSNode *S2 = PS.create<PSNodeType::STORE>(B, C);
+        PSNode *L1 = PS.create<PSNodeType::LOAD>(C);
+        PSNode *L2 = PS.create<PSNodeType::LOAD>(L1);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(L1);
+        L1->addSuccessor(L2);
+
+        // the budget is checked only once in a while, so make sure
+        // that the analysis has enough nodes to process
+        PSNode *last = L2;
+        for (unsigned i = 0; i < 1000; ++i) {
+            PSNode *cast = PS.create<PSNodeType::CAST>(last);
+            last->addSuccessor(cast);
+            last = cast;
+        }
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        SlowPointerAnalysisFI PA(&PS, dg::PointerAnalysisOptions()
+                                              .setSolver(solver)
+                                              .setTimeLimit(1));
+        PA.run();
+        REQUIRE(PA.exceededBudget());
+
+        // the results are over-approximated, but still sound
+        REQUIRE(last->pointsTo.hasUnknown());
+        REQUIRE((L1->doesPointsTo(B) || L1->pointsTo.hasUnknown()));
+        REQUIRE((L2->doesPointsTo(A) || L2->pointsTo.hasUnknown()));
+        // the allocations do not change
+        REQUIRE(!A->pointsTo.hasUnknown());
+        REQUIRE(A->doesPointsTo(A));
+    }
+
+    // without the limit, the analysis finishes
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *L = PS.create<PSNodeType::LOAD>(A);
+    A->addSuccessor(L);
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    SlowPointerAnalysisFI PA(&PS);
+    PA.run();
+    REQUIRE(!PA.exceededBudget());
+    REQUIRE(!L->pointsTo.hasUnknown());
+}
+
+// a graph with many stores and loads: a ring of objects
+// where every object points to the next one, loaded via PHIs and GEPs
+static std::vector<std::set<std::pair<unsigned, uint64_t>>>
+runRing(unsigned threads, bool collapse) {
+    const unsigned N = 100;
+    PointerGraph PS;
+    std::vector<PSNode *> objects;
+    for (unsigned i = 0; i < N; ++i) {
+        objects.push_back(PS.create<PSNodeType::ALLOC>());
+        objects.back()->setSize(16);
+    }
+
+    std::vector<PSNode *> nodes(objects);
+    PSNode *last = nullptr;
+    auto append = [&](PSNode *n) {
+        if (last)
+            last->addSuccessor(n);
+        last = n;
+        nodes.push_back(n);
+    };
+    for (PSNode *o : objects)
+        append(o);
+
+    for (unsigned i = 0; i < N; ++i) {
+        PSNode *next = objects[(i + 1) % N];
+        append(PS.create<PSNodeType::STORE>(next, objects[i]));
+        PSNode *gep = PS.create<PSNodeType::GEP>(next, 8);
+        append(gep);
+        append(PS.create<PSNodeType::STORE>(objects[i], gep));
+    }
+
+    // walk the ring from every object via loads in a loop
+    for (unsigned i = 0; i < N; ++i) {
+        PSNode *phi = PS.create<PSNodeType::PHI>(objects[i]);
+        append(phi);
+        PSNode *L = PS.create<PSNodeType::LOAD>(phi);
+        append(L);
+        PSNode *C = PS.create<PSNodeType::CAST>(L);
+        append(C);
+        phi->addOperand(C);
+        PSNode *G = PS.create<PSNodeType::GEP>(C, 8);
+        append(G);
+        append(PS.create<PSNodeType::LOAD>(G));
+    }
+
+    auto subg = PS.createSubgraph(objects[0]);
+    PS.setEntry(subg);
+    PointerAnalysisFI PA(&PS,
+                         dg::PointerAnalysisOptions()
+                                 .setSolver(dg::PointerAnalysisOptions::
+                                                    Solver::worklist)
+                                 .setCollapseCycles(collapse)
+                                 .setSolverThreads(threads));
+    PA.run();
+
+    std::vector<std::set<std::pair<unsigned, uint64_t>>> result;
+    for (PSNode *n : nodes) {
+        result.emplace_back();
+        for (const auto &ptr : n->pointsTo)
+            result.back().emplace(ptr.target->getID(), *ptr.offset);
+    }
+    return result;
+}
+
+TEST_CASE("Parallel worklist solver gives the same results", "FI") {
+    for (bool collapse : {false, true}) {
+        auto expected = runRing(1, collapse);
+        // the walks reach every object
+        size_t reached = 0;
+        for (const auto &pts : expected)
+            reached = std::max(reached, pts.size());
+        REQUIRE(reached == 100);
+        REQUIRE(runRing(2, collapse) == expected);
+        REQUIRE(runRing(4, collapse) == expected);
+        REQUIRE(runRing(4, collapse) == expected);
+    }
+}
+
+TEST_CASE("Collapsing cycles of copy nodes", "FI") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *P = PS.create<PSNodeType::ALLOC>();
+    PSNode *PHI1 = PS.create<PSNodeType::PHI>(A);
+    PSNode *PHI2 = PS.create<PSNodeType::PHI>(B);
+    PSNode *C = PS.create<PSNodeType::CAST>(PHI2);
+    PSNode *GEP = PS.create<PSNodeType::GEP>(C, 0);
+    PSNode *S = PS.create<PSNodeType::STORE>(PHI1, P);
+    PSNode *L = PS.create<PSNodeType::LOAD>(P);
+
+    // PHI1 -> PHI2 -> C -> GEP -> PHI1 is a cycle of copy nodes
+    PHI1->addOperand(GEP);
+    PHI2->addOperand(PHI1);
+
+    A->addSuccessor(B);
+    B->addSuccessor(P);
+    P->addSuccessor(PHI1);
+    PHI1->addSuccessor(PHI2);
+    PHI2->addSuccessor(C);
+    C->addSuccessor(GEP);
+    GEP->addSuccessor(S);
+    S->addSuccessor(L);
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PointerAnalysisFI PA(&PS,
+                         dg::PointerAnalysisOptions()
+                                 .setSolver(dg::PointerAnalysisOptions::
+                                                    Solver::worklist)
+                                 .setCollapseCycles(true));
+    PA.run();
+
+    REQUIRE(PA.getNumOfCollapsedCycles() == 1);
+    REQUIRE(PA.getNumOfCollapsedNodes() == 3);
+
+    // the graph is not changed by collapsing
+    REQUIRE(PHI1->getOperand(1) == GEP);
+    REQUIRE(PHI2->getOperand(1) == PHI1);
+    REQUIRE(C->getOperand(0) == PHI2);
+    REQUIRE(GEP->getOperand(0) == C);
+    REQUIRE(S->getOperand(0) == PHI1);
+
+    for (PSNode *n : {PHI1, PHI2, C, GEP}) {
+        REQUIRE(n->pointsTo.size() == 2);
+        REQUIRE(n->doesPointsTo(A));
+        REQUIRE(n->doesPointsTo(B));
+    }
+
+    REQUIRE(L->doesPointsTo(A));
+    REQUIRE(L->doesPointsTo(B));
+}
+
+// GEPs yield four offsets into ARRAY (so it is collapsed with
+// the limit 2) and one offset into P (which stays field-sensitive)
+template <typename PTStoT>
+static void collapseObjects(dg::PointerAnalysisOptions opts, bool collapse) {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *ARRAY = PS.create<PSNodeType::ALLOC>();
+    ARRAY->setSize(32);
+    PSNode *P = PS.create<PSNodeType::ALLOC>();
+    P->setSize(16);
+    PSNode *G0 = PS.create<PSNodeType::GEP>(ARRAY, 0);
+    PSNode *G8 = PS.create<PSNodeType::GEP>(ARRAY, 8);
+    PSNode *G16 = PS.create<PSNodeType::GEP>(ARRAY, 16);
+    PSNode *G24 = PS.create<PSNodeType::GEP>(ARRAY, 24);
+    PSNode *GP = PS.create<PSNodeType::GEP>(P, 8);
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, G0);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(B, G16);
+    PSNode *S3 = PS.create<PSNodeType::STORE>(A, GP);
+    PSNode *S4 = PS.create<PSNodeType::STORE>(G16, P);
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(G0);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(G24);
+    PSNode *L3 = PS.create<PSNodeType::LOAD>(GP);
+    PSNode *L4 = PS.create<PSNodeType::LOAD>(P);
+
+    PSNode *last = nullptr;
+    for (PSNode *n : {A, B, ARRAY, P, G0, G8, G16, G24, GP, S1, S2, S3, S4, L1,
+                      L2, L3, L4}) {
+        if (last)
+            last->addSuccessor(n);
+        last = n;
+    }
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS, opts.setMaxObjectOffsets(collapse ? 2 : 0));
+    PA.run();
+
+    REQUIRE(GP->pointsTo.size() == 1);
+    REQUIRE(GP->doesPointsTo(P, 8));
+    REQUIRE(L3->pointsTo.size() == 1);
+    REQUIRE(L3->doesPointsTo(A));
+
+    if (!collapse) {
+        REQUIRE(PA.getCollapsedObjects().empty());
+        REQUIRE(G24->doesPointsTo(ARRAY, 24));
+        REQUIRE(L1->pointsTo.size() == 1);
+        REQUIRE(L1->doesPointsTo(A));
+        REQUIRE(L4->doesPointsTo(ARRAY, 16));
+        return;
+    }
+
+    REQUIRE(PA.getCollapsedObjects() == std::vector<PSNode *>{ARRAY});
+    // the pointer to the beginning is kept
+    REQUIRE(G0->pointsTo.size() == 1);
+    REQUIRE(G0->doesPointsTo(ARRAY, 0));
+    for (PSNode *gep : {G8, G16, G24}) {
+        REQUIRE(gep->pointsTo.size() == 1);
+        REQUIRE(gep->doesPointsTo(ARRAY, Offset::UNKNOWN));
+    }
+    // the elements are not distinguished anymore
+    for (PSNode *load : {L1, L2}) {
+        REQUIRE(load->doesPointsTo(A));
+        REQUIRE(load->doesPointsTo(B));
+    }
+    // the pointer stored in memory is collapsed too
+    REQUIRE(L4->pointsTo.size() == 1);
+    REQUIRE(L4->doesPointsTo(ARRAY, Offset::UNKNOWN));
+    // the stores into the collapsed object (also via the pointer
+    // to its beginning) do not create entries on concrete offsets
+    std::vector<MemoryObject *> objects;
+    PA.getMemoryObjects(L2, Pointer(ARRAY, 0), objects);
+    REQUIRE(!objects.empty());
+    for (const MemoryObject *mo : objects) {
+        REQUIRE(mo->pointsTo.size() == 1);
+        REQUIRE(mo->getUnknownPointsTo() != nullptr);
+    }
+}
+
+TEST_CASE("Collapsing objects with many offsets", "PTA") {
+    using Solver = dg::PointerAnalysisOptions::Solver;
+    for (bool collapse : {false, true}) {
+        collapseObjects<PointerAnalysisFI>({}, collapse);
+        collapseObjects<PointerAnalysisFI>(
+                dg::PointerAnalysisOptions().setSolver(Solver::worklist),
+                collapse);
+        collapseObjects<PointerAnalysisFI>(dg::PointerAnalysisOptions()
+                                                   .setSolver(Solver::worklist)
+                                                   .setSolverThreads(4),
+                                           collapse);
+        collapseObjects<PointerAnalysisFS>({}, collapse);
+        collapseObjects<PointerAnalysisSFS>({}, collapse);
+    }
+}
+
+// the memcpy copies into DEST that gets collapsed (four offsets with
+// the limit 2) and then the source changes, so it copies again
+template <typename PTStoT>
+static void memcpyCollapsed(dg::PointerAnalysisOptions opts) {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *SRC = PS.create<PSNodeType::ALLOC>();
+    SRC->setSize(16);
+    PSNode *DEST = PS.create<PSNodeType::ALLOC>();
+    DEST->setSize(32);
+    PSNode *GS = PS.create<PSNodeType::GEP>(SRC, 8);
+    PSNode *G0 = PS.create<PSNodeType::GEP>(DEST, 0);
+    PSNode *G8 = PS.create<PSNodeType::GEP>(DEST, 8);
+    PSNode *G16 = PS.create<PSNodeType::GEP>(DEST, 16);
+    PSNode *G24 = PS.create<PSNodeType::GEP>(DEST, 24);
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, GS);
+    PSNode *CPY = PS.create<PSNodeType::MEMCPY>(SRC, DEST, 16);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(B, GS);
+    PSNode *L = PS.create<PSNodeType::LOAD>(G8);
+
+    PSNode *last = nullptr;
+    for (PSNode *n :
+         {A, B, SRC, DEST, GS, G0, G8, G16, G24, S1, CPY, S2, L}) {
+        if (last)
+            last->addSuccessor(n);
+        last = n;
+    }
+    L->addSuccessor(CPY);
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS, opts.setMaxObjectOffsets(2));
+    PA.run();
+
+    REQUIRE(PA.getCollapsedObjects() == std::vector<PSNode *>{DEST});
+    REQUIRE(L->doesPointsTo(A));
+    REQUIRE(L->doesPointsTo(B));
+    // nothing was copied to concrete offsets of the collapsed object
+    std::vector<MemoryObject *> objects;
+    PA.getMemoryObjects(L, Pointer(DEST, 0), objects);
+    REQUIRE(!objects.empty());
+    for (const MemoryObject *mo : objects) {
+        REQUIRE(mo->pointsTo.size() == 1);
+        REQUIRE(mo->getUnknownPointsTo() != nullptr);
+    }
+}
+
+TEST_CASE("Memcpy into a collapsed object", "PTA") {
+    using Solver = dg::PointerAnalysisOptions::Solver;
+    memcpyCollapsed<PointerAnalysisFI>({});
+    memcpyCollapsed<PointerAnalysisFI>(
+            dg::PointerAnalysisOptions().setSolver(Solver::worklist));
+    memcpyCollapsed<PointerAnalysisFI>(dg::PointerAnalysisOptions()
+                                               .setSolver(Solver::worklist)
+                                               .setSolverThreads(4));
+    memcpyCollapsed<PointerAnalysisFS>({});
+    memcpyCollapsed<PointerAnalysisSFS>({});
+}
+
+// a call of the function 'subg' from 'callsite' that returns to 'callret'
+static void connectCall(PSNode *callsite, PSNode *callret,
+                        PointerSubgraph *subg, PSNode *ret) {
+    PSNodeCall::get(callsite)->addCallee(subg);
+    PSNodeCall::get(callsite)->setCallReturn(callret);
+    PSNodeCallRet::get(callret)->setCall(callsite);
+    PSNodeCallRet::get(callret)->addReturn(ret);
+    PSNodeRet::get(ret)->addReturnSite(callret);
+    callsite->addSuccessor(callret);
+}
+
+static void buildCalls(PointerGraph &PS, std::vector<PSNode *> &nodes) {
+    // wrap() { A = alloc; return (cast) A; }
+    PSNode *WE = PS.create<PSNodeType::ENTRY>();
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::CAST>(A);
+    PSNode *WR = PS.create<PSNodeType::RETURN>(C);
+    WE->addSuccessor(A);
+    A->addSuccessor(C);
+    C->addSuccessor(WR);
+    auto *wrap = PS.createSubgraph(WE);
+    wrap->returnNodes.insert(WR);
+
+    // f() { B = alloc; if (...) B = g(); return B; }
+    // g() { return f(); }
+    PSNode *FE = PS.create<PSNodeType::ENTRY>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *FC = PS.create<PSNodeType::CALL>();
+    PSNode *FCR = PS.create<PSNodeType::CALL_RETURN>();
+    PSNode *PHI = PS.create<PSNodeType::PHI>(B, FCR);
+    PSNode *FR = PS.create<PSNodeType::RETURN>(PHI);
+    FE->addSuccessor(B);
+    B->addSuccessor(FC);
+    B->addSuccessor(PHI);
+    FCR->addSuccessor(PHI);
+    PHI->addSuccessor(FR);
+    auto *f = PS.createSubgraph(FE);
+    f->returnNodes.insert(FR);
+
+    PSNode *GE = PS.create<PSNodeType::ENTRY>();
+    PSNode *GC = PS.create<PSNodeType::CALL>();
+    PSNode *GCR = PS.create<PSNodeType::CALL_RETURN>(FR);
+    PSNode *GR = PS.create<PSNodeType::RETURN>(GCR);
+    GE->addSuccessor(GC);
+    GCR->addSuccessor(GR);
+    auto *g = PS.createSubgraph(GE);
+    g->returnNodes.insert(GR);
+
+    FCR->addOperand(GR);
+    connectCall(FC, FCR, g, GR);
+    connectCall(GC, GCR, f, FR);
+
+    // main() { P = alloc; *P = wrap(); L = *P; X = f(); }
+    PSNode *ME = PS.create<PSNodeType::ENTRY>();
+    PSNode *P = PS.create<PSNodeType::ALLOC>();
+    PSNode *MC1 = PS.create<PSNodeType::CALL>();
+    PSNode *MCR1 = PS.create<PSNodeType::CALL_RETURN>(WR);
+    PSNode *S = PS.create<PSNodeType::STORE>(MCR1, P);
+    PSNode *L = PS.create<PSNodeType::LOAD>(P);
+    PSNode *MC2 = PS.create<PSNodeType::CALL>();
+    PSNode *MCR2 = PS.create<PSNodeType::CALL_RETURN>(FR);
+    ME->addSuccessor(P);
+    P->addSuccessor(MC1);
+    MCR1->addSuccessor(S);
+    S->addSuccessor(L);
+    L->addSuccessor(MC2);
+    connectCall(MC1, MCR1, wrap, WR);
+    connectCall(MC2, MCR2, f, FR);
+    PS.setEntry(PS.createSubgraph(ME));
+
+    nodes = {A, C, WR, B, FCR, PHI, FR, GCR, GR, P, MCR1, L, MCR2};
+}
+
+TEST_CASE("Seeding points-to sets of functions", "FI") {
+    std::vector<std::set<std::pair<unsigned, uint64_t>>> expected;
+    for (auto solver : {dg::PointerAnalysisOptions::Solver::worklist,
+                        dg::PointerAnalysisOptions::Solver::seeded}) {
+        for (unsigned threads : {1, 4}) {
+            PointerGraph PS;
+            std::vector<PSNode *> nodes;
+            buildCalls(PS, nodes);
+            PointerAnalysisFI PA(&PS, dg::PointerAnalysisOptions()
+                                              .setSolver(solver)
+                                              .setSolverThreads(threads));
+            PA.run();
+
+            std::vector<std::set<std::pair<unsigned, uint64_t>>> result;
+            for (PSNode *n : nodes) {
+                result.emplace_back();
+                for (const auto &ptr : n->pointsTo)
+                    result.back().emplace(ptr.target->getID(), *ptr.offset);
+            }
+
+            if (expected.empty()) {
+                expected = result;
+                continue;
+            }
+            REQUIRE(result == expected);
+
+            PSNode *A = nodes[0];
+            PSNode *B = nodes[3];
+            PSNode *L = nodes[11];
+            REQUIRE(L->doesPointsTo(A));
+            REQUIRE(nodes[12]->doesPointsTo(B));
+
+            if (solver != dg::PointerAnalysisOptions::Solver::seeded)
+                continue;
+
+            // wrap, f, g and main, f and g are in one component
+            REQUIRE(PA.getNumOfSeededFunctions() == 4);
+            REQUIRE(PA.getNumOfSeedingComponents() == 3);
+            REQUIRE(PA.getNumOfSeedingLevels() == 2);
+            // everything but the allocations and the load
+            // is known from the seeding
+            REQUIRE(PA.getNumOfSeedPointers() == 9);
+
+            const auto *wrapRet =
+                    PA.getReturnSeeds(PS.getSubgraphs()[0].get());
+            REQUIRE(wrapRet);
+            REQUIRE(wrapRet->size() == 1);
+            REQUIRE((*wrapRet)[0].target == A);
+            const auto *fRet = PA.getReturnSeeds(PS.getSubgraphs()[1].get());
+            REQUIRE(fRet);
+            REQUIRE(fRet->size() == 1);
+            REQUIRE((*fRet)[0].target == B);
+        }
+    }
 }
 
 TEST_CASE("Flow sensitive", "FS") {
@@ -920,6 +1822,204 @@ TEST_CASE("Flow sensitive", "FS") {
     memcpy_test6<dg::pta::PointerAnalysisFS>();
     memcpy_test7<dg::pta::PointerAnalysisFS>();
     memcpy_test8<dg::pta::PointerAnalysisFS>();
+    memcpy_test9<dg::pta::PointerAnalysisFS>();
+    memcpy_test10<dg::pta::PointerAnalysisFS>();
+}
+
+TEST_CASE("Flow sensitive copy-on-write memory", "FS") {
+    using namespace dg::pta;
+
+    for (bool cow : {true, false}) {
+        PointerGraph PS;
+        PSNode *A = PS.create<PSNodeType::ALLOC>();
+        PSNode *B = PS.create<PSNodeType::ALLOC>();
+        PSNode *C = PS.create<PSNodeType::ALLOC>();
+        PSNode *D = PS.create<PSNodeType::ALLOC>();
+        PSNode *S1 = PS.create<PSNodeType::STORE>(A, C);
+        PSNode *S2 = PS.create<PSNodeType::STORE>(B, D);
+        PSNode *L1 = PS.create<PSNodeType::LOAD>(C);
+        PSNode *L2 = PS.create<PSNodeType::LOAD>(D);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(D);
+        D->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(L1);
+        L1->addSuccessor(L2);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        dg::PointerAnalysisOptions opts;
+        PointerAnalysisFS PA(&PS, opts.setCopyOnWriteMemory(cow));
+        PA.run();
+
+        REQUIRE(L1->pointsTo.size() == 1);
+        REQUIRE(L1->doesPointsTo(A));
+        REQUIRE(L2->pointsTo.size() == 1);
+        REQUIRE(L2->doesPointsTo(B));
+
+        auto stats = PA.getMemoryStats();
+        if (cow) {
+            // S2 shares the object C with S1
+            REQUIRE(stats.objects < stats.entries);
+        } else {
+            REQUIRE(stats.objects == stats.entries);
+        }
+    }
+}
+
+TEST_CASE("Sparse flow sensitive", "SFS") {
+    store_load<dg::pta::PointerAnalysisSFS>();
+    store_load2<dg::pta::PointerAnalysisSFS>();
+    store_load3<dg::pta::PointerAnalysisSFS>();
+    store_load4<dg::pta::PointerAnalysisSFS>();
+    store_load5<dg::pta::PointerAnalysisSFS>();
+    gep1<dg::pta::PointerAnalysisSFS>();
+    gep2<dg::pta::PointerAnalysisSFS>();
+    gep3<dg::pta::PointerAnalysisSFS>();
+    gep4<dg::pta::PointerAnalysisSFS>();
+    gep5<dg::pta::PointerAnalysisSFS>();
+    nulltest<dg::pta::PointerAnalysisSFS>();
+    constant_store<dg::pta::PointerAnalysisSFS>();
+    load_from_zeroed<dg::pta::PointerAnalysisSFS>();
+    load_from_unknown_offset<dg::pta::PointerAnalysisSFS>();
+    load_from_unknown_offset2<dg::pta::PointerAnalysisSFS>();
+    load_from_unknown_offset3<dg::pta::PointerAnalysisSFS>();
+    memcpy_test<dg::pta::PointerAnalysisSFS>();
+    memcpy_test2<dg::pta::PointerAnalysisSFS>();
+    memcpy_test3<dg::pta::PointerAnalysisSFS>();
+    memcpy_test4<dg::pta::PointerAnalysisSFS>();
+    memcpy_test5<dg::pta::PointerAnalysisSFS>();
+    memcpy_test6<dg::pta::PointerAnalysisSFS>();
+    memcpy_test7<dg::pta::PointerAnalysisSFS>();
+    memcpy_test8<dg::pta::PointerAnalysisSFS>();
+    memcpy_test9<dg::pta::PointerAnalysisSFS>();
+    memcpy_test10<dg::pta::PointerAnalysisSFS>();
+}
+
+TEST_CASE("Sparse flow sensitive strong update", "SFS") {
+    using namespace dg::pta;
+
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::ALLOC>();
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, C);
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(C);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(B, C);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(C);
+
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(S1);
+    S1->addSuccessor(L1);
+    L1->addSuccessor(S2);
+    S2->addSuccessor(L2);
+
+    auto subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PointerAnalysisSFS PA(&PS);
+    PA.run();
+
+    REQUIRE(L1->pointsTo.size() == 1);
+    REQUIRE(L1->doesPointsTo(A));
+    // S2 overwrites the pointer stored by S1
+    REQUIRE(L2->pointsTo.size() == 1);
+    REQUIRE(L2->doesPointsTo(B));
+
+    // definitions in S1, S2 and the (empty) definition at the entry
+    REQUIRE(PA.getNumOfMemoryDefs() == 3);
+    REQUIRE(PA.getNumOfMemoryPhis() == 0);
+}
+
+static std::vector<PSNode *> buildSubstitutionGraph(PointerGraph &PS) {
+    PSNode *E = PS.create<PSNodeType::ENTRY>();
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    // the arguments of the function
+    PSNode *ARG1 = PS.create<PSNodeType::PHI>(A);
+    PSNode *ARG2 = PS.create<PSNodeType::PHI>(A);
+    PSNode *P = PS.create<PSNodeType::ALLOC>();
+    PSNode *S = PS.create<PSNodeType::STORE>(A, P);
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(P);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(P);
+    PSNode *G1 = PS.create<PSNodeType::GEP>(L1, 8);
+    PSNode *C = PS.create<PSNodeType::CAST>(L2);
+    PSNode *G2 = PS.create<PSNodeType::GEP>(C, 8);
+    PSNode *PHI = PS.create<PSNodeType::PHI>(G1, G2);
+    PSNode *G3 = PS.create<PSNodeType::GEP>(ARG1, 4);
+    PSNode *G4 = PS.create<PSNodeType::GEP>(ARG2, 4);
+    // store of the pointer to the memory it points to
+    PSNode *S2 = PS.create<PSNodeType::STORE>(L2, L1);
+    PSNode *L3 = PS.create<PSNodeType::LOAD>(L1);
+
+    E->addSuccessor(ARG1);
+    ARG1->addSuccessor(ARG2);
+    ARG2->addSuccessor(A);
+    A->addSuccessor(P);
+    P->addSuccessor(S);
+    S->addSuccessor(L1);
+    L1->addSuccessor(L2);
+    L2->addSuccessor(G1);
+    G1->addSuccessor(C);
+    C->addSuccessor(G2);
+    G2->addSuccessor(PHI);
+    PHI->addSuccessor(G3);
+    G3->addSuccessor(G4);
+    G4->addSuccessor(S2);
+    S2->addSuccessor(L3);
+
+    auto subg = PS.createSubgraph(E);
+    PS.setEntry(subg);
+
+    return {A, ARG1, ARG2, P, L1, L2, G1, C, G2, PHI, G3, G4, S2, L3};
+}
+
+TEST_CASE("Variable substitution", "FI") {
+    PointerGraph PS;
+    auto nodes = buildSubstitutionGraph(PS);
+    PSNode *L1 = nodes[4], *L2 = nodes[5], *G1 = nodes[6], *C = nodes[7],
+           *G2 = nodes[8], *PHI = nodes[9], *ARG2 = nodes[2], *G4 = nodes[11],
+           *S2 = nodes[12];
+
+    PointerGraphOptimizer optimizer(&PS);
+    optimizer.substituteVariables();
+
+    // L2, C, G2 and PHI
+    REQUIRE(optimizer.getNumOfRemovedNodes() == 4);
+    const auto &mapping = optimizer.getMapping();
+    REQUIRE(mapping.get(L2) == L1);
+    REQUIRE(mapping.get(C) == L1);
+    REQUIRE(mapping.get(G2) == G1);
+    REQUIRE(mapping.get(PHI) == G1);
+    // the arguments may get different operands later
+    REQUIRE(mapping.get(ARG2) == nullptr);
+    REQUIRE(mapping.get(G4) == nullptr);
+    REQUIRE(S2->getOperandsNum() == 2);
+    REQUIRE(S2->getOperand(0) == L1);
+    REQUIRE(S2->getOperand(1) == L1);
+
+    PointerAnalysisFI PA(&PS);
+    PA.run();
+
+    // the same results as without the substitution
+    PointerGraph PS2;
+    auto nodes2 = buildSubstitutionGraph(PS2);
+    PointerAnalysisFI PA2(&PS2);
+    PA2.run();
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        PSNode *nd = nodes[i];
+        if (PSNode *repr = mapping.get(nd))
+            nd = repr;
+
+        std::set<std::pair<unsigned, uint64_t>> pts, pts2;
+        for (const auto &ptr : nd->pointsTo)
+            pts.emplace(ptr.target->getID(), *ptr.offset);
+        for (const auto &ptr : nodes2[i]->pointsTo)
+            pts2.emplace(ptr.target->getID(), *ptr.offset);
+        REQUIRE(pts == pts2);
+    }
 }
 
 TEST_CASE("PSNode test", "PSNode") {
@@ -936,3 +2036,69 @@ TEST_CASE("PSNode test", "PSNode") {
     REQUIRE(N2->pointsTo.size() == 1);
     REQUIRE(N2->addPointsTo(N1, 3) == false);
 }
+
+TEST_CASE("Pointer IDs owned by graphs", "PointerIDs") {
+    using namespace dg::pta;
+
+    auto &defaultIDs = dg::PointerIDLookupTable::getDefault();
+    auto defaultSize = defaultIDs.size();
+
+    PointerGraph PS1, PS2;
+    for (auto *PS : {&PS1, &PS2}) {
+        PSNode *A = PS->create<PSNodeType::ALLOC>();
+        PSNode *B = PS->create<PSNodeType::ALLOC>();
+        PSNode *S = PS->create<PSNodeType::STORE>(A, B);
+        PSNode *L = PS->create<PSNodeType::LOAD>(B);
+        S->addSuccessor(L);
+
+        auto *sg = PS->createSubgraph(S);
+        PS->setEntry(sg);
+
+        PointerAnalysisFI PA(PS);
+        PA.run();
+
+        REQUIRE(L->doesPointsTo(A));
+    }
+
+#ifndef DG_SHARED_POINTS_TO_SETS
+    // each analysis used the table of its graph
+    // (shared points-to sets have their own table)
+    REQUIRE(PS1.getPointerIDs().size() > 0);
+    REQUIRE(PS1.getPointerIDs().size() == PS2.getPointerIDs().size());
+#endif
+    REQUIRE(defaultIDs.size() == defaultSize);
+
+    // every thread has its own default table
+    bool distinct = false;
+    std::thread([&] {
+        distinct = &dg::PointerIDLookupTable::getDefault() != &defaultIDs;
+    }).join();
+    REQUIRE(distinct);
+}
+
+TEST_CASE("Adopting nodes of another graph", "PointerGraph") {
+    using namespace dg::pta;
+
+    PointerGraph PS, arena;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+
+    PSNode *B = arena.create<PSNodeType::ALLOC>();
+    PSNode *P = arena.create<PSNodeType::NOOP>(); // stands for A
+    PSNode *C = arena.create<PSNodeType::CONSTANT>(P, 4);
+    PSNode *S = arena.create<PSNodeType::STORE>(C, B);
+
+    auto target = [P, A](PSNode *nd) { return nd == P ? A : nd; };
+    PS.adopt(arena, B, target);
+    PS.adopt(arena, C, target);
+    PS.adopt(arena, S, target);
+    P->replaceAllUsesWith(A, false);
+
+    REQUIRE(B->getID() == A->getID() + 1);
+    REQUIRE(C->getID() == A->getID() + 2);
+    REQUIRE(S->getID() == A->getID() + 3);
+    REQUIRE(PS.getNodes()[S->getID()].get() == S);
+    REQUIRE(C->pointsTo.size() == 1);
+    REQUIRE(C->doesPointsTo(A, 4));
+    REQUIRE(B->doesPointsTo(B, 0));
+    REQUIRE(S->getOperand(0) == C);
+}
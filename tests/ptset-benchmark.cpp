@@ -17,14 +17,29 @@ std::uniform_int_distribution<uint64_t> distribution(0,
         dg::debug::TimeMeasure tm;                                             \
         tm.start();                                                            \
         for (int i = 0; i < times; ++i)                                        \
-            func<PointsToSetT>();                                              \
+            func<PointerIdPointsToSet>();                                      \
         tm.stop();                                                             \
         tm.report(" -- PointsToSet bitvector took");                           \
         tm.start();                                                            \
+        for (int i = 0; i < times; ++i)                                        \
+            func<PointsToSetT>();                                              \
+        tm.stop();                                                             \
+        tm.report(" -- PointsToSet selectable took");                          \
+        tm.start();                                                            \
         for (int i = 0; i < times; ++i)                                        \
             func<SimplePointsToSet>();                                         \
         tm.stop();                                                             \
         tm.report(" -- PointsToSet std::set took");                            \
+        tm.start();                                                            \
+        for (int i = 0; i < times; ++i)                                        \
+            func<SharedPointsToSet>();                                         \
+        tm.stop();                                                             \
+        tm.report(" -- PointsToSet shared took");                              \
+        tm.start();                                                            \
+        for (int i = 0; i < times; ++i)                                        \
+            func<CompressedPointsToSet>();                                     \
+        tm.stop();                                                             \
+        tm.report(" -- PointsToSet compressed took");                          \
     } while (0);
 
 template <typename PTSetT>
@@ -84,6 +99,39 @@ void test5() {
     }
 }
 
+// merge sets in a way the pointer analysis does: many nodes
+// have the same sets and the same sets are merged repeatedly
+template <typename PTSetT>
+void test6() {
+    std::vector<PTSetT> sets(100);
+    for (int i = 0; i < 100; ++i) {
+        sets[i].add(reinterpret_cast<PSNode *>(i % 10 + 1), i % 3);
+        sets[i].add(reinterpret_cast<PSNode *>(i % 7 + 1), 0);
+    }
+
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 1; i < 100; ++i)
+            sets[i].add(sets[i - 1]);
+    }
+}
+
+// merge big sets of many pointers, as the points-to sets
+// of the nodes in big strongly connected components are
+template <typename PTSetT>
+void test7() {
+    std::vector<PTSetT> sets(20);
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < 5000; ++j)
+            sets[i].add(reinterpret_cast<PSNode *>(i * 2000 + j + 1), 0);
+    }
+
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 1; i < 20; ++i)
+            sets[i].add(sets[i - 1]);
+        sets[0].add(sets[19]);
+    }
+}
+
 int main() {
     int times;
     times = 100000;
@@ -100,4 +148,10 @@ int main() {
 
     times = 10000;
     run(test5, "Adding 1000 different pointers");
+
+    times = 1000;
+    run(test6, "Merging 100 sets 10 times");
+
+    times = 10;
+    run(test7, "Merging 20 sets of 5000 pointers 5 times");
 }
@@ -1,5 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dg/MemorySSA/MemorySSA.h"
 #include "dg/ReadWriteGraph/ReadWriteGraph.h"
 
 using namespace dg::dda;
@@ -89,3 +94,420 @@ TEST_CASE("split around in middle", "[RWBBlock]") {
     CHECK(blks.first->getSingleSuccessor() == blks.second.get());
     CHECK(blks.second->getSingleSuccessor() == &succ);
 }
+
+// LVN from the beginning of the block up to 'to'
+static Definitions lvnUpTo(RWBBlock &block, RWNode *to) {
+    Definitions D;
+    for (auto *node : block.getNodes()) {
+        if (node == to)
+            break;
+        D.update(node);
+    }
+    return D;
+}
+
+static void checkIndex(DefinitionsIndex &index, RWBBlock &block,
+                       const std::vector<RWNode *> &targets, size_t step) {
+    size_t i = 0;
+    for (auto *node : block.getNodes()) {
+        if (i++ % step != 0)
+            continue;
+
+        auto D = index.get(node);
+        auto expected = lvnUpTo(block, node);
+        for (auto *target : targets) {
+            for (unsigned off : {0u, 2u, 4u}) {
+                DefSite ds{target, off, 4};
+                REQUIRE(D.get(ds) == expected.get(ds));
+                REQUIRE(D.kills.get(ds) == expected.kills.get(ds));
+            }
+        }
+        REQUIRE(D.unknownWrites == expected.unknownWrites);
+        REQUIRE(D.unknownReads == expected.unknownReads);
+    }
+}
+
+TEST_CASE("definitions index", "[MemorySSA]") {
+    std::vector<std::unique_ptr<RWNode>> nodes;
+    auto create = [&nodes](RWNodeType type) {
+        nodes.emplace_back(new RWNode(type));
+        return nodes.back().get();
+    };
+
+    auto *A = create(RWNodeType::ALLOC);
+    auto *B = create(RWNodeType::ALLOC);
+    auto *C = create(RWNodeType::ALLOC);
+    std::vector<RWNode *> targets{A, B, C};
+
+    RWBBlock block;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 97 == 0) {
+            auto *S = create(RWNodeType::STORE);
+            S->addDef(UNKNOWN_MEMORY);
+            block.append(S);
+        } else if (i % 7 == 0) {
+            auto *S = create(RWNodeType::STORE);
+            S->addDef(A, i % 4, 4);
+            block.append(S);
+        } else if (i % 5 == 0) {
+            auto *S = create(RWNodeType::STORE);
+            S->addOverwrites(B, 0, 8);
+            block.append(S);
+        } else if (i % 3 == 0) {
+            auto *S = create(RWNodeType::STORE);
+            S->addOverwrites(A, i % 2 * 4, 4);
+            block.append(S);
+        } else {
+            auto *L = create(RWNodeType::LOAD);
+            L->addUse(i % 2 ? A : B, 0, 4);
+            block.append(L);
+        }
+    }
+
+    DefinitionsIndex index;
+    checkIndex(index, block, targets, 7);
+
+    SECTION("Querying backwards") {
+        std::vector<RWNode *> reversed(block.getNodes().rbegin(),
+                                       block.getNodes().rend());
+        for (size_t i = 0; i < reversed.size(); i += 13) {
+            auto D = index.get(reversed[i]);
+            auto expected = lvnUpTo(block, reversed[i]);
+            REQUIRE(D.get({A, 0, 4}) == expected.get({A, 0, 4}));
+            REQUIRE(D.get({B, 0, 4}) == expected.get({B, 0, 4}));
+        }
+    }
+
+    SECTION("Inserting nodes") {
+        auto nodesVec = std::vector<RWNode *>(block.getNodes().begin(),
+                                              block.getNodes().end());
+        // a node that does not change definitions
+        auto *use = create(RWNodeType::MU);
+        use->addUse(A, 0, 4);
+        block.insertBefore(use, nodesVec[500]);
+        index.inserted(use, nodesVec[500]);
+        checkIndex(index, block, targets, 11);
+
+        // a definition in the middle
+        auto *S = create(RWNodeType::STORE);
+        S->addOverwrites(C, 0, 8);
+        block.insertBefore(S, nodesVec[300]);
+        index.inserted(S, nodesVec[300]);
+        checkIndex(index, block, targets, 11);
+
+        // a definition at the beginning and at the end
+        auto *phi = create(RWNodeType::PHI);
+        phi->addOverwrites(A, 0, 8);
+        auto *first = block.getFirst();
+        block.prepend(phi);
+        index.inserted(phi, first);
+        auto *last = create(RWNodeType::STORE);
+        last->addDef(B, 0, 4);
+        block.append(last);
+        index.inserted(last, nullptr);
+        checkIndex(index, block, targets, 11);
+
+        // many nodes at the same place
+        for (int i = 0; i < 40; ++i) {
+            auto *T = create(RWNodeType::STORE);
+            T->addDef(C, i % 8, 1);
+            block.insertBefore(T, nodesVec[700]);
+            index.inserted(T, nodesVec[700]);
+        }
+        checkIndex(index, block, targets, 5);
+    }
+
+    SECTION("Missed changes") {
+        auto *S = create(RWNodeType::STORE);
+        S->addOverwrites(C, 0, 8);
+        block.prepend(S);
+        checkIndex(index, block, targets, 17);
+    }
+}
+
+TEST_CASE("MemorySSA in a long block", "[MemorySSA]") {
+    ReadWriteGraph G;
+    auto &subg = G.createSubgraph();
+    auto &block = subg.createBBlock();
+    G.setEntry(&subg);
+
+    auto &A = G.create(RWNodeType::ALLOC);
+    auto &B = G.create(RWNodeType::ALLOC);
+    block.append(&A);
+    block.append(&B);
+
+    std::vector<RWNode *> loads;
+    std::vector<RWNode *> expected;
+    RWNode *lastA = nullptr;
+    for (int i = 0; i < 500; ++i) {
+        auto &S = G.create(RWNodeType::STORE);
+        S.addOverwrites(i % 3 == 2 ? &B : &A, 0, 4);
+        block.append(&S);
+        if (i % 3 != 2)
+            lastA = &S;
+
+        auto &L = G.create(RWNodeType::LOAD);
+        L.addUse(&A, 0, 4);
+        block.append(&L);
+        loads.push_back(&L);
+        expected.push_back(lastA);
+    }
+
+    MemorySSATransformation ssa(std::move(G));
+    ssa.run();
+
+    // query from the end, so that the later queries use the checkpoints
+    for (size_t i = loads.size(); i > 0; --i) {
+        auto defs = ssa.getDefinitions(loads[i - 1]);
+        REQUIRE(defs.size() == 1);
+        REQUIRE(defs[0] == expected[i - 1]);
+
+        // this inserts a new use into the block
+        defs = ssa.getDefinitions(loads[i - 1], &A, 0, 4);
+        REQUIRE(defs.size() == 1);
+        REQUIRE(defs[0] == expected[i - 1]);
+    }
+}
+
+// main() stores to a local and a global, calls foo() that stores to the
+// global and then loads both in a diamond. Returns the loads.
+static std::vector<RWNode *> buildCallsGraph(ReadWriteGraph &G) {
+    auto &main = G.createSubgraph();
+    auto &foo = G.createSubgraph();
+    G.setEntry(&main);
+
+    auto &glob = G.create(RWNodeType::GLOBAL);
+    auto &A = G.create(RWNodeType::ALLOC);
+
+    auto &f0 = foo.createBBlock();
+    auto &FS = G.create(RWNodeType::STORE);
+    FS.addOverwrites(&glob, 0, 4);
+    f0.append(&FS);
+    f0.append(&G.create(RWNodeType::RETURN));
+
+    auto &b0 = main.createBBlock();
+    auto &b1 = main.createBBlock();
+    auto &b2 = main.createBBlock();
+    auto &b3 = main.createBBlock();
+    auto &b4 = main.createBBlock();
+    b0.addSuccessor(&b1);
+    b1.addSuccessor(&b2);
+    b1.addSuccessor(&b3);
+    b2.addSuccessor(&b4);
+    b3.addSuccessor(&b4);
+
+    b0.append(&A);
+    auto &S1 = G.create(RWNodeType::STORE);
+    S1.addOverwrites(&A, 0, 8);
+    b0.append(&S1);
+    auto &S2 = G.create(RWNodeType::STORE);
+    S2.addOverwrites(&glob, 0, 4);
+    b0.append(&S2);
+
+    auto *C = RWNodeCall::get(&G.create(RWNodeType::CALL));
+    C->addCallee(&foo);
+    b1.append(C);
+
+    auto &S3 = G.create(RWNodeType::STORE);
+    S3.addOverwrites(&A, 0, 4);
+    b2.append(&S3);
+
+    std::vector<RWNode *> loads;
+    auto &L1 = G.create(RWNodeType::LOAD);
+    L1.addUse(&A, 0, 8);
+    b4.append(&L1);
+    loads.push_back(&L1);
+    auto &L2 = G.create(RWNodeType::LOAD);
+    L2.addUse(&glob, 0, 4);
+    b4.append(&L2);
+    loads.push_back(&L2);
+    auto &L3 = G.create(RWNodeType::LOAD);
+    L3.addUse(&A, 4, 4);
+    b3.append(&L3);
+    loads.push_back(&L3);
+
+    return loads;
+}
+
+static std::vector<unsigned> definitionIDs(MemorySSATransformation &ssa,
+                                           RWNode *use) {
+    std::vector<unsigned> ids;
+    for (auto *d : ssa.getDefinitions(use))
+        ids.push_back(d->getID());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+TEST_CASE("Computing all definitions in parallel", "[MemorySSA]") {
+    ReadWriteGraph G1, G2;
+    auto loads1 = buildCallsGraph(G1);
+    auto loads2 = buildCallsGraph(G2);
+
+    MemorySSATransformation serial(std::move(G1));
+    serial.run();
+    serial.computeAllDefinitions();
+
+    dg::DataDependenceAnalysisOptions opts;
+    opts.definitionsThreads = 4;
+    MemorySSATransformation parallel(std::move(G2), opts);
+    parallel.run();
+    parallel.computeAllDefinitions();
+
+    REQUIRE(loads1.size() == loads2.size());
+    for (size_t i = 0; i < loads1.size(); ++i) {
+        auto ids = definitionIDs(serial, loads1[i]);
+        REQUIRE(!ids.empty());
+        REQUIRE(ids == definitionIDs(parallel, loads2[i]));
+    }
+
+    // the local object is defined by the stores in main(),
+    // the global is overwritten in foo()
+    REQUIRE(definitionIDs(parallel, loads2[0]).size() == 2);
+    REQUIRE(definitionIDs(parallel, loads2[1]).size() == 1);
+    REQUIRE(definitionIDs(parallel, loads2[2]).size() == 1);
+}
+
+TEST_CASE("Definitions of phis in loops", "[MemorySSA]") {
+    ReadWriteGraph G;
+    auto &subg = G.createSubgraph();
+    G.setEntry(&subg);
+
+    // b0 -> b1 -> b2 -> b3 -> b1, b2 -> b2
+    auto &b0 = subg.createBBlock();
+    auto &b1 = subg.createBBlock();
+    auto &b2 = subg.createBBlock();
+    auto &b3 = subg.createBBlock();
+    b0.addSuccessor(&b1);
+    b1.addSuccessor(&b2);
+    b2.addSuccessor(&b2);
+    b2.addSuccessor(&b3);
+    b3.addSuccessor(&b1);
+
+    auto &A = G.create(RWNodeType::ALLOC);
+    auto &B = G.create(RWNodeType::ALLOC);
+    b0.append(&A);
+    b0.append(&B);
+    auto &S0 = G.create(RWNodeType::STORE);
+    S0.addOverwrites(&A, 0, 4);
+    b0.append(&S0);
+    auto &SB = G.create(RWNodeType::STORE);
+    SB.addOverwrites(&B, 0, 4);
+    b0.append(&SB);
+
+    auto &L1 = G.create(RWNodeType::LOAD);
+    L1.addUse(&A, 0, 4);
+    b1.append(&L1);
+    auto &L2 = G.create(RWNodeType::LOAD);
+    L2.addUse(&A, 0, 4);
+    b2.append(&L2);
+    auto &S2 = G.create(RWNodeType::STORE);
+    S2.addOverwrites(&A, 0, 4);
+    b2.append(&S2);
+    auto &L3 = G.create(RWNodeType::LOAD);
+    L3.addUse(&A, 0, 4);
+    b3.append(&L3);
+
+    MemorySSATransformation ssa(std::move(G));
+    ssa.run();
+
+    auto both = std::vector<RWNode *>{&S0, &S2};
+    std::sort(both.begin(), both.end());
+    auto sorted = [](std::vector<RWNode *> v) {
+        std::sort(v.begin(), v.end());
+        return v;
+    };
+
+    // the phis in b1 and b2 form a cycle
+    REQUIRE(sorted(ssa.getDefinitions(&L2)) == both);
+    REQUIRE(sorted(ssa.getDefinitions(&L1)) == both);
+    REQUIRE(ssa.getDefinitions(&L3) == std::vector<RWNode *>{&S2});
+
+    // these create new phis for B in the loop
+    REQUIRE(ssa.getDefinitions(&L2, &B, 0, 4) == std::vector<RWNode *>{&SB});
+    REQUIRE(ssa.getDefinitions(&L3, &B, 0, 4) == std::vector<RWNode *>{&SB});
+
+    // the queries again (from the cached definitions of phis)
+    REQUIRE(sorted(ssa.getDefinitions(&L1)) == both);
+    REQUIRE(sorted(ssa.getDefinitions(&L2)) == both);
+    REQUIRE(sorted(ssa.getDefinitions(&L1, &A, 0, 4)) == both);
+}
+
+TEST_CASE("Dense-ID definitions map", "[MemorySSA]") {
+    ReadWriteGraph G;
+    auto &X = G.create(RWNodeType::ALLOC);
+    auto &Y = G.create(RWNodeType::ALLOC);
+    auto &Z = G.create(RWNodeType::ALLOC);
+    auto &S1 = G.create(RWNodeType::STORE);
+    auto &S2 = G.create(RWNodeType::STORE);
+
+    for (auto kind : {DefinitionsMapKind::hashed, DefinitionsMapKind::denseId}) {
+        DefinitionsMap<RWNode> M(kind), R(kind);
+        M.add({&Z, 0, 4}, &S1);
+        M.add({&X, 0, 8}, &S1);
+
+        std::vector<RWNode *> targets;
+        for (auto &it : M)
+            targets.push_back(it.first);
+        if (kind == DefinitionsMapKind::denseId)
+            REQUIRE(targets == std::vector<RWNode *>{&X, &Z});
+        else
+            REQUIRE(targets == std::vector<RWNode *>{&Z, &X});
+
+        // the bytes 0-3 of Z are defined in M, 4-7 are not
+        R.add({&Z, 0, 8}, &S2);
+        R.add({&Y, 0, 4}, &S2);
+        auto J = M;
+        J.addUncovered(R);
+        REQUIRE(J.size() == 3);
+        REQUIRE(J.get({&Z, 0, 4}) == std::set<RWNode *>{&S1});
+        REQUIRE(J.get({&Z, 4, 4}) == std::set<RWNode *>{&S2});
+        REQUIRE(J.get({&Y, 0, 4}) == std::set<RWNode *>{&S2});
+        REQUIRE(J.get({&X, 0, 8}) == std::set<RWNode *>{&S1});
+
+        auto F = M;
+        F.addUncovered(R, [&Y](const RWNode *t) { return t != &Y; });
+        REQUIRE(!F.definesTarget(&Y));
+
+        auto U = M;
+        REQUIRE(U.add(R));
+        REQUIRE(!U.add(R));
+        REQUIRE(U.get({&Z, 0, 4}) == std::set<RWNode *>{&S1, &S2});
+
+        auto I = M.intersect(U);
+        REQUIRE(I.size() == 2);
+        REQUIRE(I.get({&Z, 0, 4}) == std::set<RWNode *>{&S1});
+        REQUIRE(I.get({&Z, 4, 4}).empty());
+
+        // maps of different kinds
+        DefinitionsMap<RWNode> H(DefinitionsMapKind::hashed);
+        H.add(M);
+        REQUIRE(H == M);
+        REQUIRE(M == H);
+        H.addUncovered(R);
+        REQUIRE(H == J);
+    }
+}
+
+TEST_CASE("MemorySSA with dense-ID definitions maps", "[MemorySSA]") {
+    ReadWriteGraph G1, G2;
+    auto loads1 = buildCallsGraph(G1);
+    auto loads2 = buildCallsGraph(G2);
+
+    MemorySSATransformation hashed(std::move(G1));
+    hashed.run();
+
+    dg::DataDependenceAnalysisOptions opts;
+    opts.definitionsMap = DefinitionsMapKind::denseId;
+    MemorySSATransformation dense(std::move(G2), opts);
+    dense.run();
+    dense.computeAllDefinitions();
+
+    REQUIRE(loads1.size() == loads2.size());
+    for (size_t i = 0; i < loads1.size(); ++i) {
+        auto ids = definitionIDs(hashed, loads1[i]);
+        REQUIRE(!ids.empty());
+        REQUIRE(ids == definitionIDs(dense, loads2[i]));
+    }
+
+    DefinitionsMap<RWNode>::setDefaultKind(DefinitionsMapKind::hashed);
+}
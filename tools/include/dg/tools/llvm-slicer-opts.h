@@ -40,6 +40,9 @@ struct SlicerOptions {
 
     std::string inputFile{};
     std::string outputFile{};
+
+    // where to dump the profile of pointer analysis (as JSON)
+    std::string ptaProfileFile{};
 };
 
 ///
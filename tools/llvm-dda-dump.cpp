@@ -687,8 +687,15 @@ static void dumpDefs(LLVMDataDependenceAnalysis *DDA, bool todot) {
     if (DDA->getOptions().isSSA()) {
         auto SSA = static_cast<MemorySSATransformation *>(
                 DDA->getDDA()->getImpl());
-        if (!graph_only)
+        if (!graph_only) {
+            debug::TimeMeasure tm;
+            tm.start();
             SSA->computeAllDefinitions();
+            tm.stop();
+            tm.report("INFO: Computing all definitions in " +
+                      std::to_string(DDA->getOptions().definitionsThreads) +
+                      " threads took");
+        }
 
         if (quiet)
             return;
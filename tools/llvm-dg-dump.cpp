@@ -155,8 +155,11 @@ int main(int argc, char *argv[]) {
     } else if (strcmp(pts, "inv") == 0) {
         options.PTAOptions.analysisType =
                 LLVMPointerAnalysisOptions::AnalysisType::inv;
+    } else if (strcmp(pts, "sfs") == 0) {
+        options.PTAOptions.analysisType =
+                LLVMPointerAnalysisOptions::AnalysisType::sfs;
     } else {
-        llvm::errs() << "Unknown points to analysis, try: fs, fi, inv\n";
+        llvm::errs() << "Unknown points to analysis, try: fs, fi, inv, sfs\n";
         abort();
     }
 
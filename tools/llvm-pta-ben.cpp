@@ -2,6 +2,7 @@
 #error "This code needs LLVM enabled"
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
@@ -10,6 +11,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <dg/util/SilenceLLVMWarnings.h>
@@ -45,6 +47,7 @@ enum PTType {
     FLOW_SENSITIVE = 1,
     FLOW_INSENSITIVE,
     WITH_INVALIDATE,
+    SPARSE_FLOW_SENSITIVE,
 };
 
 static std::string getInstName(const llvm::Value *val) {
@@ -383,6 +386,76 @@ static void evalPTA(DGLLVMPointerAnalysis *pta) {
     }
 }
 
+// describe the pointers from 'node' in a way that does not depend
+// on the particular instance of the pointer graph
+static std::set<std::pair<const llvm::Value *, uint64_t>>
+getPointers(PSNode *node) {
+    std::set<std::pair<const llvm::Value *, uint64_t>> ret;
+    for (const Pointer &ptr : node->pointsTo) {
+        ret.emplace(ptr.target->getUserData<llvm::Value>(),
+                    *ptr.offset);
+    }
+    return ret;
+}
+
+static void reportSolverStats(DGLLVMPointerAnalysis *pta) {
+    const auto *fi = static_cast<const PointerAnalysisFI *>(pta->getPTA());
+    llvm::outs() << "INFO: Processed nodes: " << fi->getNumOfProcessedNodes()
+                 << ", collapsed nodes: " << fi->getNumOfCollapsedNodes()
+                 << " (in " << fi->getNumOfCollapsedCycles()
+                 << " cycles)\n";
+    if (pta->getOptions().isSeededSolver())
+        llvm::outs() << "INFO: Seeded functions: "
+                     << fi->getNumOfSeededFunctions() << " (in "
+                     << fi->getNumOfSeedingComponents() << " components, "
+                     << fi->getNumOfSeedingLevels()
+                     << " levels), seed pointers: "
+                     << fi->getNumOfSeedPointers() << "\n";
+}
+
+static void reportMemoryStats(DGLLVMPointerAnalysis *pta) {
+    const auto *fs = static_cast<const PointerAnalysisFS *>(pta->getPTA());
+    auto stats = fs->getMemoryStats();
+    llvm::outs() << "INFO: Memory maps: " << stats.maps
+                 << ", entries: " << stats.entries
+                 << ", memory objects: " << stats.objects
+                 << ", stored pointers: " << stats.pointers << "\n";
+}
+
+// compare the results of two pointer analyses, return
+// the number of values that have different points-to sets
+static unsigned compareResults(llvm::Module *M, DGLLVMPointerAnalysis *pta1,
+                               DGLLVMPointerAnalysis *pta2) {
+    unsigned diffs = 0;
+    for (auto &F : *M) {
+        for (auto &B : F) {
+            for (auto &I : B) {
+                PSNode *n1 = pta1->getPointsToNode(&I);
+                PSNode *n2 = pta2->getPointsToNode(&I);
+                if (!n1 && !n2)
+                    continue;
+
+                if (!n1 || !n2 || getPointers(n1) != getPointers(n2)) {
+                    errs() << "DIFFERENT: " << getInstName(&I) << "\n";
+                    ++diffs;
+                }
+            }
+        }
+    }
+
+    return diffs;
+}
+
+// the representations that do not over-approximate the stored pointers
+// (e.g., by merging unaligned or big offsets into the unknown offset)
+static bool isExactPointsToSet(PointsToSetKind kind) {
+    return kind == PointsToSetKind::pointerId ||
+           kind == PointsToSetKind::compressed ||
+           kind == PointsToSetKind::shared ||
+           kind == PointsToSetKind::simple ||
+           kind == PointsToSetKind::offsetsSet;
+}
+
 int main(int argc, char *argv[]) {
     llvm::Module *M;
     llvm::LLVMContext context;
@@ -391,6 +464,14 @@ int main(int argc, char *argv[]) {
     const char *entry_func = "main";
     PTType type = FLOW_INSENSITIVE;
     uint64_t field_sensitivity = Offset::UNKNOWN;
+    auto solver = PointerAnalysisOptions::Solver::iterative;
+    bool compare_solvers = false;
+    bool compare_cow = false;
+    bool collapse_cycles = false;
+    unsigned solver_threads = 1;
+    bool compare_threads = false;
+    auto points_to_set = defaultPointsToSetKind;
+    bool compare_sets = false;
 
     // parse options
     for (int i = 1; i < argc; ++i) {
@@ -400,8 +481,35 @@ int main(int argc, char *argv[]) {
                 type = FLOW_SENSITIVE;
             else if (strcmp(argv[i + 1], "inv") == 0)
                 type = WITH_INVALIDATE;
+            else if (strcmp(argv[i + 1], "sfs") == 0)
+                type = SPARSE_FLOW_SENSITIVE;
         } else if (strcmp(argv[i], "-pta-field-sensitive") == 0) {
             field_sensitivity = static_cast<uint64_t>(atoll(argv[i + 1]));
+        } else if (strcmp(argv[i], "-pta-solver") == 0) {
+            if (strcmp(argv[i + 1], "worklist") == 0)
+                solver = PointerAnalysisOptions::Solver::worklist;
+            else if (strcmp(argv[i + 1], "seeded") == 0)
+                solver = PointerAnalysisOptions::Solver::seeded;
+        } else if (strcmp(argv[i], "-pta-collapse-cycles") == 0) {
+            collapse_cycles = true;
+        } else if (strcmp(argv[i], "-pta-threads") == 0) {
+            solver_threads = static_cast<unsigned>(atoi(argv[i + 1]));
+            if (solver_threads == 0)
+                solver_threads = std::thread::hardware_concurrency();
+        } else if (strcmp(argv[i], "-pta-set") == 0) {
+            if (!getPointsToSetKindByName(argv[i + 1], points_to_set)) {
+                errs() << "Unknown points-to set: " << argv[i + 1] << "\n";
+                return 1;
+            }
+            ++i;
+        } else if (strcmp(argv[i], "-compare-sets") == 0) {
+            compare_sets = true;
+        } else if (strcmp(argv[i], "-compare-threads") == 0) {
+            compare_threads = true;
+        } else if (strcmp(argv[i], "-compare-solvers") == 0) {
+            compare_solvers = true;
+        } else if (strcmp(argv[i], "-compare-cow") == 0) {
+            compare_cow = true;
         } else if (strcmp(argv[i], "-entry") == 0) {
             entry_func = argv[i + 1];
         } else {
@@ -436,12 +544,157 @@ int main(int argc, char *argv[]) {
         opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::fi;
     } else if (type == WITH_INVALIDATE) {
         opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::inv;
+    } else if (type == SPARSE_FLOW_SENSITIVE) {
+        opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::sfs;
     } else {
         opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::fs;
     }
 
     opts.entryFunction = entry_func;
     opts.fieldSensitivity = field_sensitivity;
+    opts.setSolver(solver);
+    opts.setCollapseCycles(collapse_cycles);
+    opts.setSolverThreads(solver_threads);
+    opts.setPointsToSet(points_to_set);
+    // more threads are supported only by the worklist solver
+    if ((solver_threads > 1 && !opts.isWorklistSolver()) || compare_threads)
+        opts.setSolver(PointerAnalysisOptions::Solver::worklist);
+
+    if (compare_threads) {
+        if (!opts.isFI()) {
+            errs() << "More threads are supported only by FI PTA\n";
+            return 1;
+        }
+
+        // run the solver with 1, 2, 4, ... up to -pta-threads threads
+        // and compare the results with the single-threaded run
+        opts.setSolverThreads(1);
+        DGLLVMPointerAnalysis seqPTA(M, opts);
+        tm.start();
+        seqPTA.run();
+        tm.stop();
+        tm.report("INFO: Pointer analysis (1 thread) took");
+        auto seqTime = tm.duration().count();
+
+        unsigned diffs = 0;
+        for (unsigned t = 2; t <= std::max(solver_threads, 2U); t *= 2) {
+            opts.setSolverThreads(t);
+            DGLLVMPointerAnalysis parPTA(M, opts);
+            tm.start();
+            parPTA.run();
+            tm.stop();
+            std::string msg = "INFO: Pointer analysis (" + std::to_string(t) +
+                              " threads) took";
+            tm.report(msg);
+            auto parTime = tm.duration().count();
+            llvm::outs() << "INFO: Speedup with " << t << " threads: "
+                         << (parTime > 0 ? static_cast<double>(seqTime) /
+                                                   parTime
+                                         : 0.0)
+                         << "\n";
+
+            diffs += compareResults(M, &seqPTA, &parPTA);
+        }
+
+        llvm::outs() << "INFO: The results differ for " << diffs
+                     << " values\n";
+        return diffs == 0 ? 0 : 1;
+    }
+
+    if (compare_sets) {
+        // run the analysis with every representation of points-to sets
+        // and compare the results with the selected one
+        DGLLVMPointerAnalysis refPTA(M, opts);
+        tm.start();
+        refPTA.run();
+        tm.stop();
+        std::string msg = std::string("INFO: Pointer analysis (") +
+                          getPointsToSetKindName(points_to_set) + ") took";
+        tm.report(msg);
+
+        unsigned diffs = 0;
+        for (auto kind : allPointsToSetKinds) {
+            if (kind == points_to_set)
+                continue;
+            // the parallel solver needs thread-safe sets
+            if (solver_threads > 1 && !isThreadSafe(kind))
+                continue;
+
+            opts.setPointsToSet(kind);
+            DGLLVMPointerAnalysis PTA(M, opts);
+            tm.start();
+            PTA.run();
+            tm.stop();
+            msg = std::string("INFO: Pointer analysis (") +
+                  getPointsToSetKindName(kind) + ") took";
+            tm.report(msg);
+
+            auto kindDiffs = compareResults(M, &refPTA, &PTA);
+            llvm::outs() << "INFO: The results with "
+                         << getPointsToSetKindName(kind) << " differ for "
+                         << kindDiffs << " values\n";
+            // inexact representations may legally lose precision
+            if (isExactPointsToSet(kind) && isExactPointsToSet(points_to_set))
+                diffs += kindDiffs;
+        }
+
+        return diffs == 0 ? 0 : 1;
+    }
+
+    if (compare_solvers) {
+        if (!opts.isFI()) {
+            errs() << "The worklist solver is available only for FI PTA\n";
+            return 1;
+        }
+
+        opts.setSolver(PointerAnalysisOptions::Solver::iterative);
+        DGLLVMPointerAnalysis iterPTA(M, opts);
+        tm.start();
+        iterPTA.run();
+        tm.stop();
+        tm.report("INFO: Pointer analysis (iterative solver) took");
+
+        opts.setSolver(PointerAnalysisOptions::Solver::worklist);
+        DGLLVMPointerAnalysis wlPTA(M, opts);
+        tm.start();
+        wlPTA.run();
+        tm.stop();
+        tm.report("INFO: Pointer analysis (worklist solver) took");
+        reportSolverStats(&wlPTA);
+
+        auto diffs = compareResults(M, &iterPTA, &wlPTA);
+        llvm::outs() << "INFO: The results differ for " << diffs
+                     << " values\n";
+        return diffs == 0 ? 0 : 1;
+    }
+
+    if (compare_cow) {
+        if (!opts.isFS() && !opts.isFSInv()) {
+            errs() << "Copy-on-write memory is used only by FS and inv PTA\n";
+            return 1;
+        }
+
+        opts.setCopyOnWriteMemory(false);
+        DGLLVMPointerAnalysis copyPTA(M, opts);
+        tm.start();
+        copyPTA.run();
+        tm.stop();
+        tm.report("INFO: Pointer analysis (copying memory) took");
+        reportMemoryStats(&copyPTA);
+
+        opts.setCopyOnWriteMemory(true);
+        DGLLVMPointerAnalysis cowPTA(M, opts);
+        tm.start();
+        cowPTA.run();
+        tm.stop();
+        tm.report("INFO: Pointer analysis (copy-on-write memory) took");
+        reportMemoryStats(&cowPTA);
+
+        auto diffs = compareResults(M, &copyPTA, &cowPTA);
+        llvm::outs() << "INFO: The results differ for " << diffs
+                     << " values\n";
+        return diffs == 0 ? 0 : 1;
+    }
 
     DGLLVMPointerAnalysis PTA(M, opts);
 
@@ -451,6 +704,8 @@ int main(int argc, char *argv[]) {
 
     tm.stop();
     tm.report("INFO: Pointer analysis took");
+    if (opts.isFI() && opts.isWorklistSolver())
+        reportSolverStats(&PTA);
 
     evalPTA(&PTA);
 
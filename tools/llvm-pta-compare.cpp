@@ -71,6 +71,10 @@ llvm::cl::opt<bool> fsinv(
                 "Run flow-sensitive PTA with invalidated memory analysis."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> sfs("sfs",
+                        llvm::cl::desc("Run sparse flow-sensitive PTA."),
+                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
 #if HAVE_SVF
 llvm::cl::opt<bool> svf("svf", llvm::cl::desc("Run SVF PTA (Andersen)."),
                         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
@@ -265,6 +269,12 @@ int main(int argc, char *argv[]) {
                 "DG FSinv",
                 createAnalysis<DGLLVMPointerAnalysis>(M.get(), opts), 0);
     }
+    if (sfs) {
+        opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::sfs;
+        analyses.emplace_back(
+                "DG SFS", createAnalysis<DGLLVMPointerAnalysis>(M.get(), opts),
+                0);
+    }
 #ifdef HAVE_SVF
     if (svf) {
         opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::svf;
@@ -3,6 +3,7 @@
 #endif
 
 #include <cassert>
+#include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
@@ -275,7 +276,7 @@ static void dumpPointer(const Pointer &ptr, bool dot) {
         printf(" + %" PRIu64, *ptr.offset);
 }
 
-static void dumpMemoryObject(MemoryObject *mo, int ind, bool dot) {
+static void dumpMemoryObject(const MemoryObject *mo, int ind, bool dot) {
     bool printed_multi = false;
     for (auto &it : mo->pointsTo) {
         int width = 0;
@@ -618,6 +619,37 @@ static void dumpPointerGraph(DGLLVMPointerAnalysis *pta, PTType type) {
     }
 }
 
+// build the graph and run the analysis without and with the variable
+// substitution and report the sizes of the graphs and the times of solving
+static void dumpSubstitutionStats(const DGLLVMPointerAnalysis *pta) {
+    auto opts = pta->getOptions();
+    const llvm::Module *M = pta->getBuilder()->getModule();
+
+    for (bool substitute : {false, true}) {
+        opts.substituteVariables = substitute;
+        DGLLVMPointerAnalysis PTA(M, opts);
+        PTA.initialize();
+
+        size_t nodes_num = 0;
+        for (const auto &node : PTA.getNodes()) {
+            if (node)
+                ++nodes_num;
+        }
+
+        TimeMeasure tm;
+        tm.start();
+        PTA.getPTA()->run();
+        tm.stop();
+
+        printf("%s variable substitution: %zu nodes, solving took %lld ms\n",
+               substitute ? "With" : "Without", nodes_num,
+               static_cast<long long>(
+                       std::chrono::duration_cast<std::chrono::milliseconds>(
+                               tm.duration())
+                               .count()));
+    }
+}
+
 static void dumpStats(DGLLVMPointerAnalysis *pta) {
     const auto &nodes = pta->getNodes();
     printf("Pointer subgraph size: %zu\n", nodes.size() - 1);
@@ -778,6 +810,64 @@ static void dumpStats(DGLLVMPointerAnalysis *pta) {
     printf("Pointing to stack: %zu\n", pointing_to_stack);
     printf("Pointing to function: %zu\n", pointing_to_function);
     printf("Maximum pt-set size: %zu\n", maximum);
+
+    const auto &opts = pta->getOptions();
+    if (opts.hasBudget())
+        printf("Exceeded the budget: %s\n",
+               pta->exceededBudget() ? "yes" : "no");
+    if (opts.maxObjectOffsets > 0) {
+        const auto &collapsed = pta->getPTA()->getCollapsedObjects();
+        printf("Collapsed objects: %zu\n", collapsed.size());
+        for (PSNode *obj : collapsed) {
+            printf("  ");
+            printName(obj);
+            printf("\n");
+        }
+    }
+    if (opts.isFI() && opts.isWorklistSolver()) {
+        const auto *fi = static_cast<const PointerAnalysisFI *>(pta->getPTA());
+        printf("Worklist solver processed nodes: %zu\n",
+               fi->getNumOfProcessedNodes());
+        printf("Collapsed nodes: %zu (in %zu cycles)\n",
+               fi->getNumOfCollapsedNodes(), fi->getNumOfCollapsedCycles());
+        if (opts.isSeededSolver()) {
+            printf("Seeded functions: %zu (in %zu components, %zu "
+                   "levels)\n",
+                   fi->getNumOfSeededFunctions(),
+                   fi->getNumOfSeedingComponents(),
+                   fi->getNumOfSeedingLevels());
+            printf("Seed pointers: %zu\n", fi->getNumOfSeedPointers());
+        }
+    } else if (opts.isSFS()) {
+        const auto *sfs =
+                static_cast<const PointerAnalysisSFS *>(pta->getPTA());
+        printf("Memory definitions: %zu (%zu merges)\n",
+               sfs->getNumOfMemoryDefs(), sfs->getNumOfMemoryPhis());
+        printf("Def-use edges: %zu\n", sfs->getNumOfDefUseEdges());
+        printf("Sparse solver processed nodes: %zu\n",
+               sfs->getNumOfSparseProcessedNodes());
+    }
+
+    if (opts.isFI() && opts.substituteVariables)
+        dumpSubstitutionStats(pta);
+}
+
+static void dumpProfile(const LLVMPointerAnalysis *pta,
+                        const std::string &file) {
+    if (file.empty())
+        return;
+
+    if (pta->getOptions().isSVF()) {
+        llvm::errs() << "SVF analysis does not support profiling\n";
+        return;
+    }
+
+    std::ofstream out(file);
+    if (!static_cast<const DGLLVMPointerAnalysis *>(pta)->dumpProfile(out) ||
+        !out) {
+        llvm::errs() << "Failed dumping the profile of pointer analysis to "
+                     << file << "\n";
+    }
 }
 
 std::unique_ptr<llvm::Module> parseModule(llvm::LLVMContext &context,
@@ -880,10 +970,12 @@ int main(int argc, char *argv[]) {
             } else {
                 dumpStats(static_cast<DGLLVMPointerAnalysis *>(llvmpta.get()));
             }
+            dumpProfile(llvmpta.get(), options.ptaProfileFile);
             return 0;
         }
 
         if (_quiet) {
+            dumpProfile(llvmpta.get(), options.ptaProfileFile);
             return 0;
         }
 
@@ -938,6 +1030,9 @@ int main(int argc, char *argv[]) {
                 }
             }
         }
+
+        // in the demand-driven mode, the queries are profiled too
+        dumpProfile(llvmpta.get(), options.ptaProfileFile);
         return 0;
     }
 
@@ -983,6 +1078,8 @@ int main(int argc, char *argv[]) {
         dumpStats(&PTA);
     }
 
+    dumpProfile(&PTA, options.ptaProfileFile);
+
     if (_quiet)
         return 0;
 
@@ -1,3 +1,5 @@
+#include <thread>
+
 #include "dg/Offset.h"
 #include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisOptions.h"
 #include "dg/llvm/DataDependence/LLVMDataDependenceAnalysisOptions.h"
@@ -230,7 +232,9 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                     clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fs,
                                "fs", "Flow-sensitive PTA"),
                     clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::inv,
-                               "inv", "PTA with invalidate nodes")
+                               "inv", "PTA with invalidate nodes"),
+                    clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::sfs,
+                               "sfs", "Sparse flow-sensitive PTA")
 #ifdef HAVE_SVF
                             ,
                     clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::svf,
@@ -244,6 +248,142 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
             llvm::cl::init(LLVMPointerAnalysisOptions::AnalysisType::fi),
             llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<dg::PointerAnalysisOptions::Solver> ptaSolver(
+            "pta-solver",
+            llvm::cl::desc("Choose the solver of flow-insensitive PTA:"),
+            llvm::cl::values(
+                    clEnumValN(dg::PointerAnalysisOptions::Solver::iterative,
+                               "iterative",
+                               "Iterate over all nodes (default)"),
+                    clEnumValN(dg::PointerAnalysisOptions::Solver::worklist,
+                               "worklist",
+                               "Worklist with difference propagation"),
+                    clEnumValN(dg::PointerAnalysisOptions::Solver::seeded,
+                               "seeded",
+                               "Worklist preceded by seeding the points-to "
+                               "sets of functions")
+#if LLVM_VERSION_MAJOR < 4
+                            ,
+                    nullptr
+#endif
+                    ),
+            llvm::cl::init(dg::PointerAnalysisOptions::Solver::iterative),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<dg::pta::PointsToSetKind> ptaSet(
+            "pta-set",
+            llvm::cl::desc("Choose the representation of points-to sets:"),
+            llvm::cl::values(
+                    clEnumValN(dg::pta::PointsToSetKind::pointerId,
+                               "pointer-id",
+                               "Bitvector of the IDs of pointers"),
+                    clEnumValN(dg::pta::PointsToSetKind::compressed,
+                               "compressed",
+                               "Compressed bitmap of the IDs of pointers"),
+                    clEnumValN(dg::pta::PointsToSetKind::shared, "shared",
+                               "Hash-consed shared sets"),
+                    clEnumValN(dg::pta::PointsToSetKind::simple, "simple",
+                               "std::set of pointers"),
+                    clEnumValN(dg::pta::PointsToSetKind::offsetsSet,
+                               "offsets-set",
+                               "Bitvector of offsets for every target"),
+                    clEnumValN(dg::pta::PointsToSetKind::separateOffsets,
+                               "separate-offsets",
+                               "Bitvectors of targets and offsets"),
+                    clEnumValN(dg::pta::PointsToSetKind::smallOffsets,
+                               "small-offsets",
+                               "Bitvector of targets with small offsets"),
+                    clEnumValN(dg::pta::PointsToSetKind::alignedSmallOffsets,
+                               "aligned-small-offsets",
+                               "Bitvector of targets with small aligned "
+                               "offsets"),
+                    clEnumValN(dg::pta::PointsToSetKind::alignedPointerId,
+                               "aligned-pointer-id",
+                               "Bitvector of the IDs of pointers with "
+                               "aligned offsets")
+#if LLVM_VERSION_MAJOR < 4
+                            ,
+                    nullptr
+#endif
+                    ),
+            llvm::cl::init(dg::pta::defaultPointsToSetKind),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaCollapseCycles(
+            "pta-collapse-cycles",
+            llvm::cl::desc("Collapse cycles of nodes that only copy pointers\n"
+                           "(used by the worklist solver, default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaThreads(
+            "pta-threads",
+            llvm::cl::desc("The number of threads used by the worklist solver\n"
+                           "of flow-insensitive PTA, implies -pta-solver=worklist"
+                           "\n(0 = the number of cores, default=1).\n"),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaBuildThreads(
+            "pta-build-threads",
+            llvm::cl::desc("The number of threads that build the subgraphs\n"
+                           "of functions of the pointer graph "
+                           "(0 = the number of cores, default=1).\n"),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaDemandDriven(
+            "pta-demand-driven",
+            llvm::cl::desc("Compute the points-to sets of flow-insensitive "
+                           "PTA\nonly for the queried values "
+                           "(default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaSubstituteVariables(
+            "pta-substitute-variables",
+            llvm::cl::desc("Merge the nodes of the pointer graph that have\n"
+                           "the same points-to sets before running "
+                           "flow-insensitive\nPTA (default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> ptaCache(
+            "pta-cache",
+            llvm::cl::desc("Cache the results of PTA in the given directory\n"
+                           "and reuse them when slicing the same module with\n"
+                           "the same PTA options.\n"),
+            llvm::cl::value_desc("dir"), llvm::cl::init(""),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> ptaProfile(
+            "pta-profile",
+            llvm::cl::desc("Profile the fixpoint computation of PTA and dump\n"
+                           "the profile as JSON into the given file.\n"),
+            llvm::cl::value_desc("file"), llvm::cl::init(""),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaTimeLimit(
+            "pta-time-limit",
+            llvm::cl::desc("Stop PTA after the given time and over-approximate"
+                           "\nthe unfinished points-to sets by the unknown "
+                           "pointer\n(0 = no limit, default=0).\n"),
+            llvm::cl::value_desc("ms"), llvm::cl::init(0),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaMemoryLimit(
+            "pta-memory-limit",
+            llvm::cl::desc("Stop PTA when the process uses more memory and\n"
+                           "over-approximate the unfinished points-to sets\n"
+                           "by the unknown pointer (0 = no limit, "
+                           "default=0).\n"),
+            llvm::cl::value_desc("MB"), llvm::cl::init(0),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaMaxObjectOffsets(
+            "pta-max-object-offsets",
+            llvm::cl::desc("Collapse the objects into which PTA finds more\n"
+                           "than N distinct offsets (all pointers to them\n"
+                           "get the unknown offset, 0 = no limit, "
+                           "default=0).\n"),
+            llvm::cl::value_desc("N"), llvm::cl::init(0),
+            llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<LLVMDataDependenceAnalysisOptions::AnalysisType> ddaType(
             "dda", llvm::cl::desc("Choose data dependence analysis to use:"),
             llvm::cl::values(
@@ -260,6 +400,32 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                     LLVMDataDependenceAnalysisOptions::AnalysisType::ssa),
             llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> ddaThreads(
+            "dda-threads",
+            llvm::cl::desc("The number of threads that compute the "
+                           "definitions\nof all uses when they are all "
+                           "requested at once\n(0 = the number of cores, "
+                           "default=1).\n"),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<dg::dda::DefinitionsMapKind> ddaDefinitionsMap(
+            "dda-definitions-map",
+            llvm::cl::desc("Choose how MemorySSA stores the definitions "
+                           "of memory objects:"),
+            llvm::cl::values(
+                    clEnumValN(dg::dda::DefinitionsMapKind::hashed, "hashed",
+                               "Hash table indexed by the objects (default)"),
+                    clEnumValN(dg::dda::DefinitionsMapKind::denseId,
+                               "dense-id",
+                               "Array sorted by the IDs of the objects")
+#if LLVM_VERSION_MAJOR < 4
+                            ,
+                    nullptr
+#endif
+                    ),
+            llvm::cl::init(dg::dda::DefinitionsMapKind::hashed),
+            llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<dg::ControlDependenceAnalysisOptions::CDAlgorithm>
             cdAlgorithm(
                     "cda",
@@ -395,12 +561,34 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
     PTAOptions.entryFunction = entryFunction;
     PTAOptions.fieldSensitivity = dg::Offset(ptaFieldSensitivity);
     PTAOptions.analysisType = ptaType;
+    PTAOptions.setSolver(ptaSolver);
+    PTAOptions.setPointsToSet(ptaSet);
+    PTAOptions.setCollapseCycles(ptaCollapseCycles);
+    PTAOptions.setSolverThreads(ptaThreads > 0
+                                        ? ptaThreads
+                                        : std::thread::hardware_concurrency());
+    PTAOptions.buildThreads = ptaBuildThreads > 0
+                                      ? ptaBuildThreads
+                                      : std::thread::hardware_concurrency();
+    if (PTAOptions.solverThreads > 1 && !PTAOptions.isWorklistSolver())
+        PTAOptions.setSolver(dg::PointerAnalysisOptions::Solver::worklist);
+    PTAOptions.setDemandDriven(ptaDemandDriven);
+    PTAOptions.substituteVariables = ptaSubstituteVariables;
+    PTAOptions.cacheDir = ptaCache;
+    PTAOptions.setProfile(!ptaProfile.empty());
+    PTAOptions.setTimeLimit(ptaTimeLimit);
+    PTAOptions.setMemoryLimit(ptaMemoryLimit);
+    PTAOptions.setMaxObjectOffsets(ptaMaxObjectOffsets);
     PTAOptions.threads = threads;
+    options.ptaProfileFile = ptaProfile;
 
     DDAOptions.threads = threads;
     DDAOptions.entryFunction = entryFunction;
     DDAOptions.undefinedFunsBehavior = undefinedFunsBehavior;
     DDAOptions.analysisType = ddaType;
+    DDAOptions.definitionsThreads =
+            ddaThreads > 0 ? ddaThreads : std::thread::hardware_concurrency();
+    DDAOptions.definitionsMap = ddaDefinitionsMap;
 
     return options;
 }
@@ -139,6 +139,36 @@ static void maybe_print_statistics(llvm::Module *M,
            << bnum << " " << inum << "\n";
 }
 
+static void maybe_dump_pta_profile(::Slicer &slicer,
+                                   const SlicerOptions &options) {
+    if (options.ptaProfileFile.empty())
+        return;
+
+    auto *PTA = slicer.getDG().getPTA();
+    if (PTA->getOptions().isSVF()) {
+        errs() << "[llvm-slicer] SVF does not support profiling\n";
+        return;
+    }
+
+    std::ofstream out(options.ptaProfileFile);
+    if (!static_cast<dg::DGLLVMPointerAnalysis *>(PTA)->dumpProfile(out) ||
+        !out) {
+        errs() << "[llvm-slicer] Failed dumping the profile of PTA to "
+               << options.ptaProfileFile << "\n";
+    }
+}
+
+static void maybe_warn_pta_budget(::Slicer &slicer) {
+    auto *PTA = slicer.getDG().getPTA();
+    if (PTA->getOptions().isSVF())
+        return;
+
+    if (static_cast<dg::DGLLVMPointerAnalysis *>(PTA)->exceededBudget()) {
+        errs() << "[llvm-slicer] PTA exceeded the time or memory limit, "
+                  "its results are over-approximated\n";
+    }
+}
+
 static AnnotationOptsT parseAnnotationOptions(const std::string &annot) {
     if (annot.empty())
         return {};
@@ -294,6 +324,10 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // the dependencies are computed, so PTA is not queried anymore
+    maybe_warn_pta_budget(slicer);
+    maybe_dump_pta_profile(slicer, options);
+
     // print debugging llvm IR if user asked for it
     if (annotator.shouldAnnotate())
         annotator.annotate(&criteria_nodes);